@@ -0,0 +1,132 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "tiledarray.h"
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+// Compression ratio, throughput, and error of the tile codecs on the local
+// tiles of an array, read from a checkpoint written by write_checkpoint()
+// (e.g. the doubles amplitudes of a coupled-cluster calculation), or on
+// MP2-like model amplitudes if no checkpoint is given.
+
+typedef TiledArray::TSpArrayD array_type;
+
+// A tiling of [0, n) with tiles of (at most) the given size
+TiledArray::TiledRange1 make_tiling(const std::size_t n,
+                                    const std::size_t block) {
+  std::vector<std::size_t> boundaries;
+  for (std::size_t i = 0ul; i < n; i += block) boundaries.push_back(i);
+  boundaries.push_back(n);
+  return TiledArray::TiledRange1(boundaries.begin(), boundaries.end());
+}
+
+// t(i,j,a,b) = g(i,j,a,b) / (e_i + e_j - e_a - e_b) with a model integral g
+array_type model_amplitudes(TiledArray::World& world, const std::size_t o,
+                            const std::size_t v, const std::size_t block) {
+  const auto tr_o = make_tiling(o, block);
+  const auto tr_v = make_tiling(v, block);
+  TiledArray::TiledRange trange({tr_o, tr_o, tr_v, tr_v});
+  auto energy = [o](const std::size_t p) {
+    return p < o ? -2.0 + 1.5 * p / o : 0.1 + 4.0 * (p - o) / o;
+  };
+  return TiledArray::make_array<array_type>(
+      world, trange,
+      [&](TiledArray::TensorD& tile, const TiledArray::Range& r) {
+        tile = TiledArray::TensorD(r);
+        const auto& lo = r.lobound();
+        const auto& up = r.upbound();
+        std::size_t n = 0ul;
+        for (auto i = lo[0]; i < up[0]; ++i)
+          for (auto j = lo[1]; j < up[1]; ++j)
+            for (auto a = lo[2]; a < up[2]; ++a)
+              for (auto b = lo[3]; b < up[3]; ++b, ++n) {
+                const double g = std::exp(-0.3 * std::abs(double(a) - b)) *
+                                 std::cos(0.7 * (i + j)) /
+                                 (1.0 + 0.1 * (a + b));
+                tile[n] = g / (energy(i) + energy(j) - energy(o + a) -
+                               energy(o + b));
+              }
+        return tile.norm();
+      });
+}
+
+void report(TiledArray::World& world, const std::string& name,
+            const array_type& array, const TiledArray::TileCodec& codec) {
+  typedef std::chrono::high_resolution_clock clock;
+  double raw = 0.0, encoded = 0.0, encode_time = 0.0, decode_time = 0.0;
+  double max_error = 0.0;
+  for (const auto& tile_f : array) {
+    const TiledArray::TensorD& tile = tile_f.get();
+    const auto t0 = clock::now();
+    const auto buffer = TiledArray::detail::encode_tile(tile, codec);
+    const auto t1 = clock::now();
+    const auto decoded =
+        TiledArray::detail::decode_tile<TiledArray::TensorD>(buffer);
+    const auto t2 = clock::now();
+    raw += tile.size() * sizeof(double);
+    encoded += buffer.size();
+    encode_time += std::chrono::duration<double>(t1 - t0).count();
+    decode_time += std::chrono::duration<double>(t2 - t1).count();
+    for (std::size_t i = 0ul; i < tile.size(); ++i)
+      max_error = std::max(max_error, std::abs(decoded[i] - tile[i]));
+  }
+  world.gop.sum(raw);
+  world.gop.sum(encoded);
+  world.gop.sum(encode_time);
+  world.gop.sum(decode_time);
+  world.gop.max(max_error);
+
+  if (world.rank() == 0)
+    std::cout << "  " << std::setw(18) << std::left << name << std::right
+              << " ratio " << std::setw(7) << std::fixed << std::setprecision(2)
+              << raw / encoded << " encode " << std::setw(8)
+              << std::setprecision(1) << raw / encode_time / 1.0e6
+              << " MB/s decode " << std::setw(8)
+              << raw / decode_time / 1.0e6 << " MB/s max error "
+              << std::scientific << std::setprecision(2) << max_error << "\n";
+}
+
+int main(int argc, char** argv) {
+  TiledArray::World& world = TiledArray::initialize(argc, argv);
+
+  array_type t = (argc > 1)
+                     ? TiledArray::read_checkpoint<array_type>(world, argv[1])
+                     : model_amplitudes(world, 20, 100, 10);
+
+  if (world.rank() == 0)
+    std::cout << (argc > 1 ? argv[1] : "model amplitudes") << ": "
+              << t.trange().tiles_range().volume() << " tiles, "
+              << world.size() << " ranks\n";
+  report(world, "lossless", t, TiledArray::TileCodec::lossless());
+  for (const double tolerance :
+       {double(TiledArray::SparseShape<float>::threshold()), 1e-8, 1e-10}) {
+    std::ostringstream name;
+    name << "bounded " << std::scientific << std::setprecision(0)
+         << tolerance;
+    report(world, name.str(), t, TiledArray::TileCodec::bounded(tolerance));
+  }
+
+  world.gop.fence();
+  TiledArray::finalize();
+
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/pmap/hash_pmap.h"
+#include "TiledArray/pmap/sfc_pmap.h"
+#include "tiledarray.h"
+
+#include <iomanip>
+#include <set>
+
+// Communication partners of each rank for several tile access patterns over
+// a tile index space of the given extents. Since every rank can compute the
+// owner of any tile, rank 0 evaluates the patterns for all ranks.
+
+typedef std::vector<std::size_t> extents_type;
+
+std::size_t tile_ordinal(const extents_type& extents,
+                         const extents_type& index) {
+  std::size_t ord = 0ul;
+  for (std::size_t d = 0ul; d < extents.size(); ++d)
+    ord = ord * extents[d] + index[d];
+  return ord;
+}
+
+extents_type tile_index(const extents_type& extents, std::size_t ord) {
+  extents_type index(extents.size());
+  for (std::size_t d = extents.size(); d > 0ul; --d) {
+    index[d - 1] = ord % extents[d - 1];
+    ord /= extents[d - 1];
+  }
+  return index;
+}
+
+// Print min/avg/max of the number of partners per rank
+void print_stats(const std::string& pattern,
+                 const std::vector<std::set<ProcessID>>& partners) {
+  std::size_t min = partners.front().size(), max = 0ul, sum = 0ul;
+  for (const auto& p : partners) {
+    min = std::min(min, p.size());
+    max = std::max(max, p.size());
+    sum += p.size();
+  }
+  std::cout << "  " << std::setw(12) << std::left << pattern << std::right
+            << " min " << std::setw(5) << min << " avg " << std::setw(8)
+            << std::fixed << std::setprecision(2)
+            << double(sum) / double(partners.size()) << " max " << std::setw(5)
+            << max << "\n";
+}
+
+void report(const std::string& name, const extents_type& extents,
+            const TiledArray::Pmap& pmap) {
+  const std::size_t rank = extents.size();
+  const std::size_t procs = pmap.procs();
+  const std::size_t tiles = pmap.size();
+
+  // Halo/block access: the owners of the face neighbors of the local tiles
+  std::vector<std::set<ProcessID>> neighbor(procs);
+  // Permutation: the owners of the source tiles of the local tiles of the
+  // reversed array, e.g. b("l,k,j,i") = a("i,j,k,l") with the same pmap
+  std::vector<std::set<ProcessID>> permute(procs);
+  extents_type perm_extents(extents.rbegin(), extents.rend());
+  for (std::size_t t = 0ul; t < tiles; ++t) {
+    const ProcessID me = pmap.owner(t);
+    auto index = tile_index(extents, t);
+    for (std::size_t d = 0ul; d < rank; ++d) {
+      for (int delta : {-1, 1}) {
+        if ((delta < 0 && index[d] == 0ul) ||
+            (delta > 0 && index[d] + 1ul == extents[d]))
+          continue;
+        index[d] += delta;
+        const ProcessID p = pmap.owner(tile_ordinal(extents, index));
+        index[d] -= delta;
+        if (p != me) neighbor[me].insert(p);
+      }
+    }
+
+    if (perm_extents == extents) {
+      extents_type perm_index(index.rbegin(), index.rend());
+      const ProcessID p = pmap.owner(tile_ordinal(extents, perm_index));
+      if (p != me) permute[me].insert(p);
+    }
+  }
+
+  // SUMMA panels: view the array as a matrix with the leading half of the
+  // modes as rows; the ranks of a column panel must take part in its
+  // broadcast, so count the owners per panel and report them per rank.
+  const std::size_t row_rank = rank / 2ul;
+  std::size_t rows = 1ul, cols = 1ul;
+  for (std::size_t d = 0ul; d < rank; ++d)
+    (d < row_rank ? rows : cols) *= extents[d];
+  std::vector<std::set<ProcessID>> panel(procs);
+  for (std::size_t c = 0ul; c < cols; ++c) {
+    std::set<ProcessID> owners;
+    for (std::size_t r = 0ul; r < rows; ++r)
+      owners.insert(pmap.owner(r * cols + c));
+    for (const auto p : owners)
+      for (const auto q : owners)
+        if (p != q) panel[p].insert(q);
+  }
+
+  std::cout << name << "\n";
+  print_stats("neighbor", neighbor);
+  if (perm_extents == extents) print_stats("permute", permute);
+  print_stats("summa panel", panel);
+}
+
+int main(int argc, char** argv) {
+  TiledArray::World& world = TiledArray::initialize(argc, argv);
+
+  const std::vector<extents_type> spaces = {
+      {64, 64}, {16, 16, 16}, {8, 8, 8, 8}};
+
+  for (const auto& extents : spaces) {
+    const std::size_t tiles = std::accumulate(
+        extents.begin(), extents.end(), std::size_t(1), std::multiplies<>());
+
+    TiledArray::detail::BlockedPmap blocked_pmap(world, tiles);
+    TiledArray::detail::HashPmap hash_pmap(world, tiles);
+    TiledArray::detail::SfcPmap hilbert_pmap(
+        world, extents, TiledArray::detail::SfcPmap::Curve::Hilbert);
+    TiledArray::detail::SfcPmap morton_pmap(
+        world, extents, TiledArray::detail::SfcPmap::Curve::Morton);
+
+    if (world.rank() == 0) {
+      std::cout << "Tile index space {";
+      for (std::size_t d = 0ul; d < extents.size(); ++d)
+        std::cout << (d ? ", " : "") << extents[d];
+      std::cout << "}, " << world.size()
+                << " ranks: communication partners per rank\n";
+      report("Blocked", extents, blocked_pmap);
+      report("Hash", extents, hash_pmap);
+      report("Hilbert", extents, hilbert_pmap);
+      report("Morton", extents, morton_pmap);
+      std::cout << "\n";
+    }
+
+    world.gop.fence();
+  }
+
+  TiledArray::finalize();
+
+  return 0;
+}
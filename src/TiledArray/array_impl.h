@@ -30,6 +30,7 @@
 #include <TiledArray/tensor_impl.h>
 #include <TiledArray/transform_iterator.h>
 #include <TiledArray/type_traits.h>
+#include <TiledArray/util/memory.h>
 
 namespace TiledArray {
 namespace detail {
@@ -439,6 +440,9 @@ class ArrayImpl : public TensorImpl<Policy> {
 
  private:
   storage_type data_;  ///< Tile container
+  std::shared_ptr<const TensorBytesPeak>
+      expression_peak_;  ///< The memory peak of the expression evaluation
+                         ///< that produced this array, if any
 
  public:
   /// Constructor
@@ -458,6 +462,19 @@ class ArrayImpl : public TensorImpl<Policy> {
   /// Virtual destructor
   virtual ~ArrayImpl() {}
 
+  /// Batched tile accessor
+
+  /// See DistributedStorage::get(const std::vector<size_type>&)
+  /// \param ordinals The tile ordinals
+  /// \return Futures to the tiles, in the order of \c ordinals
+  /// \throw TiledArray::Exception When a tile is zero
+  std::vector<future> get_batch(
+      const std::vector<ordinal_type>& ordinals) const {
+    for ([[maybe_unused]] const auto ord : ordinals)
+      TA_ASSERT(!TensorImpl_::is_zero(ord));
+    return data_.get(ordinals);
+  }
+
   /// Tile future accessor
 
   /// \tparam Index An integral or integral range type
@@ -493,33 +510,7 @@ class ArrayImpl : public TensorImpl<Policy> {
   template <typename Index,
             typename = std::enable_if_t<std::is_integral_v<Index> ||
                                         detail::is_integral_range_v<Index>>>
-  const future& get_local(const Index& i) const {
-    TA_ASSERT(!TensorImpl_::is_zero(i) && TensorImpl_::is_local(i));
-    return data_.get_local(TensorImpl_::trange().tiles_range().ordinal(i));
-  }
-
-  /// Local tile future accessor
-
-  /// \tparam Integer An integral type
-  /// \param i The tile index, as an \c std::initializer_list<Integer>
-  /// \return A \c future to tile \c i
-  /// \throw TiledArray::Exception When tile \c i is zero or not local
-  template <typename Integer,
-            typename = std::enable_if_t<std::is_integral_v<Integer>>>
-  const future& get_local(const std::initializer_list<Integer>& i) const {
-    return get_local<std::initializer_list<Integer>>(i);
-  }
-
-  /// Local tile future accessor
-
-  /// \tparam Index An integral or integral range type
-  /// \param i The tile index or ordinal
-  /// \return A \c future to tile \c i
-  /// \throw TiledArray::Exception When tile \c i is zero or not local
-  template <typename Index,
-            typename = std::enable_if_t<std::is_integral_v<Index> ||
-                                        detail::is_integral_range_v<Index>>>
-  future& get_local(const Index& i) {
+  future get_local(const Index& i) const {
     TA_ASSERT(!TensorImpl_::is_zero(i) && TensorImpl_::is_local(i));
     return data_.get_local(TensorImpl_::trange().tiles_range().ordinal(i));
   }
@@ -532,7 +523,7 @@ class ArrayImpl : public TensorImpl<Policy> {
   /// \throw TiledArray::Exception When tile \c i is zero or not local
   template <typename Integer,
             typename = std::enable_if_t<std::is_integral_v<Integer>>>
-  future& get_local(const std::initializer_list<Integer>& i) {
+  future get_local(const std::initializer_list<Integer>& i) const {
     return get_local<std::initializer_list<Integer>>(i);
   }
 
@@ -577,6 +568,21 @@ class ArrayImpl : public TensorImpl<Policy> {
     }
   }
 
+  /// Set a batch of tiles
+
+  /// See DistributedStorage::set(const std::vector<std::pair<size_type,
+  /// value_type>>&)
+  /// \param tiles The (ordinal, tile) pairs of the tiles to be set
+  void set_batch(
+      const std::vector<std::pair<ordinal_type, value_type>>& tiles) {
+    for ([[maybe_unused]] const auto& tile : tiles)
+      TA_ASSERT(!TensorImpl_::is_zero(tile.first));
+    data_.set(tiles);
+    if (set_notifier_accessor()) {
+      for (const auto& tile : tiles) set_notifier_accessor()(*this, tile.first);
+    }
+  }
+
   /// Array begin iterator
 
   /// \return A const iterator to the first local element of the array.
@@ -621,6 +627,98 @@ class ArrayImpl : public TensorImpl<Policy> {
     return const_iterator(this, TensorImpl_::pmap()->end());
   }
 
+  /// Move the tiles to the owners defined by a new process map
+
+  /// See DistributedStorage::redistribute()
+  /// \param pmap The new tile-process map
+  /// \param max_in_flight The maximum number of tiles in transit from this
+  /// process
+  /// \note This is a collective operation.
+  void redistribute(const std::shared_ptr<pmap_interface>& pmap,
+                    const ordinal_type max_in_flight) {
+    data_.redistribute(pmap, max_in_flight);
+    TensorImpl_::pmap(pmap);
+  }
+
+  /// Size of the local tiles
+
+  /// See DistributedStorage::local_bytes()
+  /// \return The total size of the local tiles, in bytes
+  std::size_t local_bytes() const { return data_.local_bytes(); }
+
+  /// Set the memory peak of the expression evaluation that produced this array
+
+  /// \param peak The memory peak of the evaluation
+  void expression_peak(std::shared_ptr<const TensorBytesPeak> peak) {
+    expression_peak_ = std::move(peak);
+  }
+
+  /// \return The peak increase of the tensor data of this process during the
+  /// expression evaluation that produced this array, in bytes; 0 if this
+  /// array was not produced by an expression
+  std::size_t expression_peak_bytes() const {
+    return expression_peak_ ? expression_peak_->bytes() : 0ul;
+  }
+
+  /// \return The number of local tiles that have been assigned futures that
+  /// are not yet set, see DistributedStorage::pending_sets()
+  ordinal_type pending_tiles() const { return data_.pending_sets(); }
+
+  /// \return The futures of the local tiles that exist and are not yet set,
+  /// see DistributedStorage::pending_local()
+  std::vector<Future<value_type>> pending_local() const {
+    return data_.pending_local();
+  }
+
+  /// \return A future that is set once no local tile set is pending, see
+  /// DistributedStorage::ready()
+  Future<bool> ready() const { return data_.ready(); }
+
+  /// Set the codec of the tiles that are sent to other processes
+
+  /// See DistributedStorage::set_codec()
+  /// \param codec The codec
+  void set_codec(const TileCodec& codec) { data_.set_codec(codec); }
+
+  /// \return The codec of the tiles that are sent to other processes
+  const TileCodec& codec() const { return data_.codec(); }
+
+  /// Enable the per-process cache of remote tiles
+
+  /// See DistributedStorage::enable_remote_cache()
+  /// \param max_bytes The maximum size of the cached tiles, in bytes
+  void enable_remote_cache(const std::size_t max_bytes) {
+    data_.enable_remote_cache(max_bytes);
+  }
+
+  /// Disable the per-process cache of remote tiles
+  void disable_remote_cache() { data_.disable_remote_cache(); }
+
+  /// Drop the tiles in the per-process cache of remote tiles
+  void invalidate_remote_cache() { data_.invalidate_remote_cache(); }
+
+  /// \return The maximum size of the cached remote tiles, in bytes, or 0 if
+  /// the cache is disabled
+  std::size_t remote_cache_max_bytes() const {
+    return data_.remote_cache_max_bytes();
+  }
+
+  /// Enable spilling of the local tiles to a scratch file
+
+  /// See DistributedStorage::enable_out_of_core()
+  /// \param max_bytes The maximum size of the resident local tiles, in bytes
+  /// \param dir The scratch directory
+  void enable_out_of_core(const std::size_t max_bytes,
+                          const std::string& dir = std::string()) {
+    data_.enable_out_of_core(max_bytes, dir);
+  }
+
+  /// Disable spilling of the local tiles, and read the spilled tiles back
+  void disable_out_of_core() { data_.disable_out_of_core(); }
+
+  /// \return The total size of the resident local tiles, in bytes
+  std::size_t resident_bytes() const { return data_.resident_bytes(); }
+
   /// Unique object id accessor
 
   /// \return A const reference to this object unique id
@@ -0,0 +1,287 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  checkpoint.h
+ *
+ */
+
+#ifndef TILEDARRAY_CHECKPOINT_H__INCLUDED
+#define TILEDARRAY_CHECKPOINT_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/tile_codec.h>
+
+#include <madness/world/binary_fstream_archive.h>
+#include <madness/world/vector_archive.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace TiledArray {
+namespace detail {
+
+/// The index of a checkpoint, see write_checkpoint()
+
+/// Maps each tile ordinal to the location of the serialized tile, i.e. the
+/// rank of the file that holds it, its offset in the file, and its size.
+struct CheckpointIndex {
+  static constexpr std::uint64_t magic =
+      0x5441434b50543032ul;                  ///< "TACKPT02"
+  std::size_t typeid_hash = 0ul;             ///< The array type hash
+  std::int64_t nfiles = 0;                   ///< The number of data files
+  std::vector<std::int64_t> files;    ///< The file of each tile; -1 if zero
+  std::vector<std::int64_t> offsets;  ///< The offset of each tile
+  std::vector<std::int64_t> bytes;    ///< The size of each tile
+
+  template <typename Archive>
+  void serialize(Archive& ar) {
+    ar& typeid_hash& nfiles& files& offsets& bytes;
+  }
+};
+
+/// \return The name of the index file of checkpoint \c prefix
+inline std::string checkpoint_index_name(const std::string& prefix) {
+  return prefix + ".index";
+}
+
+/// \return The name of data file \c file of checkpoint \c prefix
+inline std::string checkpoint_file_name(const std::string& prefix,
+                                        const std::int64_t file) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), ".%5.5lld", static_cast<long long>(file));
+  return prefix + buf;
+}
+
+/// Create the index of a checkpoint of an array
+
+/// The tiles are not located yet, i.e. their files are 0 (see
+/// write_checkpoint_index() ).
+/// \tparam Array The array type
+/// \param array The array
+/// \return The index of a checkpoint of \c array
+template <typename Array>
+CheckpointIndex make_checkpoint_index(const Array& array) {
+  CheckpointIndex index;
+  index.typeid_hash = typeid(Array).hash_code();
+  index.nfiles = array.world().size();
+  index.files.assign(array.size(), 0);
+  index.offsets.assign(array.size(), 0);
+  index.bytes.assign(array.size(), 0);
+  return index;
+}
+
+/// Gather the index of a checkpoint and write the index file
+
+/// Every process locates its local tiles in \c index , storing the file of
+/// a tile as <tt>rank + 1</tt> so that the indices of all processes can be
+/// summed; the first process then writes \c magic , the summed index,
+/// \c trange , \c shape and \c extra to the index file.
+/// \tparam Trange The tiled range type
+/// \tparam Shape The shape type
+/// \tparam Extra The types of the additional data of the index file
+/// \param world The world of the checkpoint
+/// \param[in,out] index The index of the local tiles; on output, the index
+/// of all tiles
+/// \param prefix The path prefix of the checkpoint files
+/// \param magic The magic number that identifies the format of the files
+/// \param trange The tiled range of the array
+/// \param shape The shape of the array
+/// \param extra Additional data of the index file
+/// \note This is a collective operation.
+template <typename Trange, typename Shape, typename... Extra>
+void write_checkpoint_index(World& world, CheckpointIndex& index,
+                            const std::string& prefix,
+                            const std::uint64_t magic, const Trange& trange,
+                            const Shape& shape, const Extra&... extra) {
+  const std::size_t ntiles = index.files.size();
+  world.gop.sum(index.files.data(), ntiles);
+  world.gop.sum(index.offsets.data(), ntiles);
+  world.gop.sum(index.bytes.data(), ntiles);
+  for (auto& f : index.files) --f;
+
+  if (world.rank() == 0) {
+    madness::archive::BinaryFstreamOutputArchive ar(
+        checkpoint_index_name(prefix).c_str());
+    ar& magic& index& trange& shape;
+    (ar & ... & extra);
+  }
+  world.gop.fence();
+}
+
+}  // namespace detail
+
+/// Write a checkpoint of an array
+
+/// Every process writes its local tiles to its own data file,
+/// <tt>prefix.NNNNN</tt> where \c NNNNN is its rank, i.e. no tiles are
+/// funnelled through I/O nodes; if the array is replicated, only the first
+/// process writes its tiles. The first process writes a small index file,
+/// <tt>prefix.index</tt> , that holds the tiled range and shape of the array
+/// and maps each tile ordinal to its data file, offset, and size (the norms
+/// of the tiles are part of the shape). Unlike the parallel archives of
+/// DistArray::store(), the checkpoint may be read by read_checkpoint() on any
+/// number of processes and with any process map.
+/// \tparam Tile The tile type
+/// \tparam Policy The policy type
+/// \param array The array to be written
+/// \param prefix The path prefix of the checkpoint files
+/// \param codec The codec of the tiles (see TileCodec ); it is ignored unless
+///        the tiles are tensors of trivially copyable scalars
+/// \throw TiledArray::Exception if a file cannot be written
+/// \note This is a collective operation.
+template <typename Tile, typename Policy>
+void write_checkpoint(const DistArray<Tile, Policy>& array,
+                      const std::string& prefix,
+                      TileCodec codec = TileCodec()) {
+  if constexpr (!detail::is_contiguous_trivially_copyable_tile_v<Tile>)
+    codec = TileCodec();
+  World& world = array.world();
+  world.gop.fence();
+
+  detail::CheckpointIndex index = detail::make_checkpoint_index(array);
+  // Every process holds every tile of a replicated array; only the first
+  // process writes them, so that each tile is in the index once
+  if (!array.pmap()->is_replicated() || world.rank() == 0) {
+    std::ofstream file(detail::checkpoint_file_name(prefix, world.rank()),
+                       std::ios::binary | std::ios::trunc);
+    if (!file)
+      TA_EXCEPTION("write_checkpoint: cannot open checkpoint data file");
+
+    std::int64_t offset = 0;
+    std::vector<unsigned char> buffer;
+    for (const auto i : *array.pmap()) {
+      if (array.is_zero(i)) continue;
+      if constexpr (detail::is_contiguous_trivially_copyable_tile_v<Tile>) {
+        if (codec)
+          buffer = detail::encode_tile(array.find(i).get(), codec);
+      }
+      if (!codec) {
+        buffer.clear();
+        madness::archive::VectorOutputArchive ar(buffer);
+        ar& array.find(i).get();
+      }
+      file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+      index.files[i] = world.rank() + 1;
+      index.offsets[i] = offset;
+      index.bytes[i] = buffer.size();
+      offset += buffer.size();
+    }
+    if (!file)
+      TA_EXCEPTION("write_checkpoint: cannot write checkpoint data file");
+  }
+
+  detail::write_checkpoint_index(world, index, prefix,
+                                 detail::CheckpointIndex::magic,
+                                 array.trange(), array.shape(), codec);
+}
+
+/// Read a checkpoint written by write_checkpoint()
+
+/// Every process reads the index file and exactly the tiles that it owns,
+/// directly from the data files; tiles that were encoded by
+/// write_checkpoint() are decoded as they are read. The number of processes
+/// and the process map may differ from those of the array that was written.
+/// \tparam Array The array type; must be the type of the array that was
+/// written
+/// \param world The world of the result
+/// \param prefix The path prefix of the checkpoint files
+/// \param pmap The process map of the result; the default process map is
+/// used if null
+/// \return The array
+/// \throw TiledArray::Exception if the files cannot be read, or if they do
+/// not hold a checkpoint of an \c Array
+/// \note This is a collective operation.
+template <typename Array>
+Array read_checkpoint(
+    World& world, const std::string& prefix,
+    std::shared_ptr<typename Array::pmap_interface> pmap = {}) {
+  typedef typename Array::ordinal_type ordinal_type;
+  typedef typename Array::value_type value_type;
+
+  detail::CheckpointIndex index;
+  typename Array::trange_type trange;
+  typename Array::shape_type shape;
+  TileCodec codec;
+  {
+    const auto name = detail::checkpoint_index_name(prefix);
+    if (!std::ifstream(name))
+      TA_EXCEPTION("read_checkpoint: cannot open checkpoint index file");
+    madness::archive::BinaryFstreamInputArchive ar(name.c_str());
+    std::uint64_t magic = 0ul;
+    ar& magic;
+    if (magic != detail::CheckpointIndex::magic)
+      TA_EXCEPTION("read_checkpoint: invalid checkpoint index file");
+    ar& index;
+    if (index.typeid_hash != typeid(Array).hash_code())
+      TA_EXCEPTION(
+          "read_checkpoint: source DistArray type != this DistArray type");
+    ar& trange& shape& codec;
+  }
+
+  const ordinal_type ntiles = trange.tiles_range().volume();
+  TA_ASSERT(index.files.size() == ntiles);
+  if (!pmap)
+    pmap = detail::policy_t<Array>::default_pmap(world, ntiles);
+  Array result(world, trange, shape, pmap);
+
+  std::map<std::int64_t, std::ifstream> files;
+  std::vector<unsigned char> buffer;
+  for (const auto i : *pmap) {
+    if (result.is_zero(i)) continue;
+    if (index.files[i] < 0)
+      TA_EXCEPTION("read_checkpoint: tile is missing from checkpoint");
+
+    auto it = files.find(index.files[i]);
+    if (it == files.end())
+      it = files
+               .emplace(index.files[i],
+                        std::ifstream(detail::checkpoint_file_name(
+                                          prefix, index.files[i]),
+                                      std::ios::binary))
+               .first;
+    std::ifstream& file = it->second;
+    buffer.resize(index.bytes[i]);
+    file.seekg(index.offsets[i]);
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    if (!file)
+      TA_EXCEPTION("read_checkpoint: cannot read checkpoint data file");
+
+    if constexpr (detail::is_contiguous_trivially_copyable_tile_v<value_type>) {
+      if (codec) {
+        result.set(i, detail::decode_tile<value_type>(buffer));
+        continue;
+      }
+    }
+    madness::archive::VectorInputArchive ar(buffer);
+    value_type tile;
+    ar& tile;
+    result.set(i, std::move(tile));
+  }
+
+  world.gop.fence();
+  return result;
+}
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_CHECKPOINT_H__INCLUDED
@@ -164,6 +164,25 @@ Future<typename A::value_type> get_sparse_tile(const I& index, A& array) {
 
 }  // namespace
 
+/// Replace an array with its updated copy
+
+/// The tiles of \c array may have been modified in place, so the remote tiles
+/// that this process has cached for \c array are dropped; \c result inherits
+/// the bound of the cache of \c array .
+/// \param[in,out] array The array to be replaced
+/// \param[in] result The updated copy of \c array
+/// \note This is a collective operation, i.e. every process drops its cache.
+template <typename Tile, typename Policy>
+inline void replace_array(DistArray<Tile, Policy>& array,
+                          DistArray<Tile, Policy> result) {
+  if (array.is_initialized()) {
+    const std::size_t cache_bytes = array.remote_cache_max_bytes();
+    array.invalidate_remote_cache();
+    if (cache_bytes) result.enable_remote_cache(cache_bytes);
+  }
+  array = std::move(result);
+}
+
 /// base implementation of dense TiledArray::foreach
 
 /// \note can't autodeduce \c ResultTile from \c void \c Op(ResultTile,ArgTile)
@@ -464,6 +483,10 @@ inline std::enable_if_t<is_dense_v<Policy>, DistArray<Tile, Policy>> foreach (
 /// \warning This function fences by default to avoid data race conditions.
 /// Only disable the fence if you can ensure, the data is not being read by
 /// another thread.
+/// \note The fence is not needed to wait for the initialization of \c arg ,
+/// e.g. by DistArray::init_tiles(), since the tiles are modified once they
+/// are set; use DistArray::ready() on the result to know when the local tiles
+/// have been modified.
 /// \warning If there is a another copy of \c arg that was created via (or
 /// arg was created by) the \c Array copy constructor or copy assignment
 /// operator, this function will modify the data of that array since the data
@@ -479,8 +502,8 @@ inline std::enable_if_t<is_dense_v<Policy>, void> foreach_inplace(
   // fence to ensure no other threads are using the data.
   if (fence) arg.world().gop.fence();
 
-  arg =
-      detail::foreach<true, Op, Tile, Tile, Policy>(std::forward<Op>(op), arg);
+  detail::replace_array(arg, detail::foreach<true, Op, Tile, Tile, Policy>(
+                                 std::forward<Op>(op), arg));
 }
 
 /// Apply a function to each tile of a sparse Array
@@ -572,6 +595,10 @@ inline std::enable_if_t<!is_dense_v<Policy>, DistArray<Tile, Policy>> foreach (
 /// \warning This function fences by default to avoid data race conditions.
 /// Only disable the fence if you can ensure, the data is not being read by
 /// another thread.
+/// \note The fence is not needed to wait for the initialization of \c arg ,
+/// e.g. by DistArray::init_tiles(), since the tiles are modified once they
+/// are set; use DistArray::ready() on the result to know when the local tiles
+/// have been modified.
 /// \warning If there is a another copy of \c arg that was created via (or
 /// arg was created by) the \c Array copy constructor or copy assignment
 /// operator, this function will modify the data of that array since the data
@@ -588,8 +615,9 @@ inline std::enable_if_t<!is_dense_v<Policy>, void> foreach_inplace(
   if (fence) arg.world().gop.fence();
 
   // Set the arg with the new array
-  arg = detail::foreach<true, Op, Tile, Tile, Policy>(
-      std::forward<Op>(op), ShapeReductionMethod::Intersect, arg);
+  detail::replace_array(
+      arg, detail::foreach<true, Op, Tile, Tile, Policy>(
+               std::forward<Op>(op), ShapeReductionMethod::Intersect, arg));
 }
 
 /// Apply a function to each tile of dense Arrays
@@ -626,8 +654,9 @@ inline std::enable_if_t<is_dense_v<Policy>, void> foreach_inplace(
   // fence to ensure no other threads are using the data.
   if (fence) left.world().gop.fence();
 
-  left = detail::foreach<true, Op, LeftTile, LeftTile, Policy, RightTile>(
-      std::forward<Op>(op), left, right);
+  detail::replace_array(
+      left, detail::foreach<true, Op, LeftTile, LeftTile, Policy, RightTile>(
+                std::forward<Op>(op), left, right));
 }
 
 /// Apply a function to each tile of sparse Arrays
@@ -672,8 +701,9 @@ inline std::enable_if_t<!is_dense_v<Policy>, void> foreach_inplace(
   if (fence) left.world().gop.fence();
 
   // Set the arg with the new array
-  left = detail::foreach<true, Op, LeftTile, LeftTile, Policy, RightTile>(
-      std::forward<Op>(op), shape_reduction, left, right);
+  detail::replace_array(
+      left, detail::foreach<true, Op, LeftTile, LeftTile, Policy, RightTile>(
+                std::forward<Op>(op), shape_reduction, left, right));
 }
 
 /// @}
@@ -0,0 +1,521 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  conversions/ingest.h
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_INGEST_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_INGEST_H__INCLUDED
+
+#include "TiledArray/external/madness.h"
+#include "TiledArray/pmap/pmap.h"
+#include "TiledArray/shape.h"
+#include "TiledArray/tensor.h"
+#include "TiledArray/tiled_range.h"
+#include "TiledArray/type_traits.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+namespace detail {
+
+/// \return The number of bytes that a process reads from an input file at a
+/// time, from \c TA_INGEST_CHUNK_BYTES (default 16 MiB)
+inline std::size_t ingest_chunk_bytes() {
+  const char* bytes = getenv("TA_INGEST_CHUNK_BYTES");
+  if (bytes) return std::max<std::size_t>(std::stoul(bytes), 1ul);
+  return 16ul << 20;
+}
+
+/// \return The number of elements that a process aggregates for an owner
+/// before sending them, from \c TA_INGEST_BATCH (default 65536)
+inline std::size_t ingest_batch_size() {
+  const char* size = getenv("TA_INGEST_BATCH");
+  if (size) return std::max<std::size_t>(std::stoul(size), 1ul);
+  return 65536ul;
+}
+
+/// \return The number of element batches that a process keeps in flight,
+/// from \c TA_INGEST_WINDOW (default 16)
+inline std::size_t ingest_window() {
+  const char* window = getenv("TA_INGEST_WINDOW");
+  if (window) return std::max<std::size_t>(std::stoul(window), 1ul);
+  return 16ul;
+}
+
+/// Assembles the local tiles of an array from the elements that are read,
+/// in parallel, by ingest()
+
+/// Every process routes the elements that it reads to the owners of their
+/// tiles in batches of runs, i.e. of elements that are contiguous in a tile;
+/// the owners copy the runs into their tiles, which are zero-initialized
+/// when the first run arrives. Each tile has its own lock, so that batches
+/// that target different tiles are stored concurrently.
+/// \tparam Tile The tile type
+template <typename Tile>
+class Ingestor : public madness::WorldObject<Ingestor<Tile>> {
+ public:
+  typedef Ingestor<Tile> Ingestor_;
+  typedef madness::WorldObject<Ingestor_> WorldObject_;
+  typedef typename Tile::value_type numeric_type;
+  typedef std::uint64_t ordinal_type;
+
+  /// A batch of runs of elements, each given by the ordinal of its tile, the
+  /// row-major ordinal of its first element within the tile, and its size;
+  /// the values of the runs are stored back to back
+  struct Batch {
+    std::vector<ordinal_type> tiles;
+    std::vector<ordinal_type> offsets;
+    std::vector<ordinal_type> sizes;
+    std::vector<numeric_type> values;
+
+    /// \return The number of elements of the batch
+    std::size_t size() const { return values.size(); }
+
+    /// Append a run of elements
+
+    /// The run is merged into the last run if it continues it.
+    /// \param tile The ordinal of the tile of the run
+    /// \param offset The row-major ordinal of the first element of the run
+    /// within the tile
+    /// \param first The values of the run
+    /// \param n The size of the run
+    void push_back(const ordinal_type tile, const ordinal_type offset,
+                   const numeric_type* first, const std::size_t n) {
+      if (!tiles.empty() && tiles.back() == tile &&
+          offsets.back() + sizes.back() == offset) {
+        sizes.back() += n;
+      } else {
+        tiles.push_back(tile);
+        offsets.push_back(offset);
+        sizes.push_back(n);
+      }
+      values.insert(values.end(), first, first + n);
+    }
+
+    template <typename Archive>
+    void serialize(Archive& ar) {
+      ar& tiles& offsets& sizes& values;
+    }
+  };  // struct Batch
+
+ private:
+  /// A local tile and its lock
+  struct Slot {
+    madness::Mutex lock;  ///< Protects tile
+    Tile tile;            ///< The tile; empty until the first run arrives
+  };
+
+  const TiledRange trange_;  ///< The tiled range of the array
+  std::unordered_map<ordinal_type, Slot>
+      slots_;  ///< The local tiles; the map is not modified after
+               ///< construction, hence it is accessed without a lock
+
+ public:
+  /// Constructor
+
+  /// \param world The world of the array
+  /// \param trange The tiled range of the array
+  /// \param pmap The process map of the array
+  /// \note This is a collective operation.
+  Ingestor(World& world, const TiledRange& trange, const Pmap& pmap)
+      : WorldObject_(world), trange_(trange) {
+    if (pmap.known_local_size()) slots_.reserve(pmap.local_size());
+    for (const auto i : pmap) slots_[i];
+    WorldObject_::process_pending();
+  }
+
+  virtual ~Ingestor() {}
+
+  /// Copy a batch of runs of local elements into their tiles
+
+  /// Elements that are given more than once are overwritten.
+  /// \param batch The elements
+  /// \return true
+  bool store(const Batch& batch) {
+    const numeric_type* values = batch.values.data();
+    for (std::size_t k = 0ul; k < batch.tiles.size();) {
+      auto it = slots_.find(batch.tiles[k]);
+      TA_ASSERT(it != slots_.end());
+      Slot& slot = it->second;
+      madness::ScopedMutex<madness::Mutex> locker(&slot.lock);
+      if (slot.tile.empty())
+        slot.tile =
+            Tile(trange_.make_tile_range(batch.tiles[k]), numeric_type(0));
+      // Store the consecutive runs of this tile under a single lock
+      for (; k < batch.tiles.size() && batch.tiles[k] == it->first; ++k) {
+        TA_ASSERT(batch.offsets[k] + batch.sizes[k] <= slot.tile.size());
+        std::copy_n(values, batch.sizes[k],
+                    slot.tile.data() + batch.offsets[k]);
+        values += batch.sizes[k];
+      }
+    }
+    return true;
+  }
+
+  /// Send a batch of elements to the owner of their tiles
+
+  /// \param owner The owner of the tiles of the elements
+  /// \param batch The elements
+  /// \return A future that is set once the owner has stored the elements
+  Future<bool> send(const ProcessID owner, const Batch& batch) {
+    if (owner == WorldObject_::get_world().rank())
+      return Future<bool>(store(batch));
+    return WorldObject_::task(owner, &Ingestor_::store, batch,
+                              madness::TaskAttributes::hipri());
+  }
+
+  /// \param i The ordinal of a local tile
+  /// \return Tile \c i , which is empty if none of its elements was stored
+  Tile& tile(const ordinal_type i) {
+    auto it = slots_.find(i);
+    TA_ASSERT(it != slots_.end());
+    return it->second.tile;
+  }
+
+};  // class Ingestor
+
+/// Map the index of an element to the ordinal of its tile and its row-major
+/// ordinal within the tile
+
+/// \param trange The tiled range
+/// \param index The <tt>trange.rank()</tt> element indices
+/// \return The ordinal of the tile and the ordinal within the tile
+/// \throw TiledArray::Exception if the index is out of range
+inline std::pair<std::uint64_t, std::uint64_t> ingest_locate(
+    const TiledRange& trange, const std::int64_t* index) {
+  std::uint64_t tile = 0ul, offset = 0ul;
+  for (std::size_t d = 0ul; d < trange.rank(); ++d) {
+    const TiledRange1& tr1 = trange.dim(d);
+    if (index[d] < std::int64_t(tr1.elements_range().first) ||
+        index[d] >= std::int64_t(tr1.elements_range().second))
+      TA_EXCEPTION("ingest: element index is out of range");
+    const auto t = tr1.element_to_tile(index[d]);
+    const auto& bounds = tr1.tile(t);
+    tile = tile * tr1.tile_extent() + (t - tr1.tiles_range().first);
+    offset = offset * (bounds.second - bounds.first) +
+             (index[d] - bounds.first);
+  }
+  return {tile, offset};
+}
+
+/// Build an array from the runs of elements that the processes read, in
+/// parallel
+
+/// Every process sends the runs that \c read produces to the owners of their
+/// tiles in batches of up to ingest_batch_size() elements, with at most
+/// ingest_window() batches in flight. The shape of a sparse array is
+/// computed from the norms of the assembled tiles.
+/// \tparam Array The array type
+/// \tparam Read The reader type
+/// \param world The world of the result
+/// \param trange The tiled range of the result
+/// \param pmap The process map of the result
+/// \param read The reader, with signature <tt>void(Route route)</tt>, which
+/// calls <tt>route(tile, offset, values, n)</tt> for every run of \c n
+/// elements, given by the pointer \c values , that this process reads, where
+/// \c tile and \c offset are as returned by ingest_locate()
+/// \return The array
+/// \note This is a collective operation.
+template <typename Array, typename Read>
+Array ingest_runs(World& world, const TiledRange& trange,
+                  std::shared_ptr<typename Array::pmap_interface> pmap,
+                  Read&& read) {
+  typedef typename Array::value_type value_type;
+  typedef typename value_type::value_type numeric_type;
+  typedef Ingestor<value_type> ingestor_type;
+  typedef typename ingestor_type::ordinal_type ordinal_type;
+
+  const std::size_t ntiles = trange.tiles_range().volume();
+  if (!pmap) pmap = policy_t<Array>::default_pmap(world, ntiles);
+  TA_ASSERT(pmap->size() == ntiles);
+
+  // The element-to-tile maps of the dimensions are built once, up front
+  for (std::size_t d = 0ul; d < trange.rank(); ++d)
+    if (trange.dim(d).extent() > 0)
+      trange.dim(d).element_to_tile(trange.dim(d).elements_range().first);
+
+  ingestor_type ingestor(world, trange, *pmap);
+  std::unordered_map<ProcessID, typename ingestor_type::Batch> batches;
+  std::deque<Future<bool>> in_flight;
+  const std::size_t batch_size = ingest_batch_size();
+  const std::size_t window = ingest_window();
+  auto send = [&](const ProcessID owner,
+                  typename ingestor_type::Batch& batch) {
+    if (in_flight.size() >= window) {
+      in_flight.front().get();
+      in_flight.pop_front();
+    }
+    in_flight.push_back(ingestor.send(owner, batch));
+    batch = typename ingestor_type::Batch();
+  };
+
+  read([&](const ordinal_type tile, const ordinal_type offset,
+           const numeric_type* values, const std::size_t n) {
+    const ProcessID owner = pmap->owner(tile);
+    auto& batch = batches[owner];
+    batch.push_back(tile, offset, values, n);
+    if (batch.size() >= batch_size) send(owner, batch);
+  });
+
+  for (auto& batch : batches)
+    if (batch.second.size() > 0ul) send(batch.first, batch.second);
+  for (auto& f : in_flight) f.get();
+
+  // All elements have been stored by their owners after the barrier
+  world.gop.barrier();
+
+  typename Array::shape_type shape;
+  if constexpr (!is_dense<Array>::value) {
+    typedef typename Array::shape_type::value_type norm_type;
+    Tensor<norm_type> tile_norms(trange.tiles_range(), 0);
+    for (const auto i : *pmap) {
+      const auto& tile = ingestor.tile(i);
+      if (!tile.empty()) tile_norms.data()[i] = tile.norm();
+    }
+    shape = typename Array::shape_type(world, tile_norms, trange);
+  }
+
+  Array result(world, trange, shape, pmap);
+  for (const auto i : *pmap) {
+    auto& tile = ingestor.tile(i);
+    if (!result.is_zero(i)) {
+      if (!tile.empty())
+        result.set(i, std::move(tile));
+      else
+        result.set(i, value_type(trange.make_tile_range(i), numeric_type(0)));
+    }
+    tile = value_type();
+  }
+
+  // The ingestor must not be destroyed before all processes are done with it
+  world.gop.fence();
+  return result;
+}
+
+/// Build an array from the fixed-size records of a file, in parallel
+
+/// Every process reads a contiguous range of the records, in chunks of
+/// ingest_chunk_bytes(), decodes the element index and value of each
+/// record, and sends the elements to the owners of their tiles (see
+/// ingest_runs() ); consecutive records of contiguous elements are sent as
+/// a single run.
+/// \tparam Array The array type
+/// \tparam Decode The record decoder type
+/// \param world The world of the result
+/// \param filename The name of the file
+/// \param trange The tiled range of the result
+/// \param pmap The process map of the result
+/// \param record_bytes The size of a record
+/// \param decode The record decoder, with signature
+/// <tt>void(const char* record, std::uint64_t ordinal, std::int64_t* index,
+/// numeric_type& value)</tt>, where \c ordinal is the ordinal of the record
+/// in the file and \c index points to <tt>trange.rank()</tt> element indices
+/// \return The array
+/// \throw TiledArray::Exception if the file cannot be read, if its size is
+/// not a multiple of \c record_bytes , or if an element index is out of range
+/// \note This is a collective operation.
+template <typename Array, typename Decode>
+Array ingest(World& world, const std::string& filename,
+             const TiledRange& trange,
+             std::shared_ptr<typename Array::pmap_interface> pmap,
+             const std::size_t record_bytes, Decode&& decode) {
+  typedef typename Array::value_type::value_type numeric_type;
+  TA_ASSERT(record_bytes > 0ul);
+
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) TA_EXCEPTION("ingest: cannot open file");
+  file.seekg(0, std::ios::end);
+  const std::uint64_t file_bytes = file.tellg();
+  if (file_bytes % record_bytes != 0ul)
+    TA_EXCEPTION("ingest: the file size is not a multiple of the record size");
+
+  // This process reads the records [first, last)
+  const std::uint64_t nrecords = file_bytes / record_bytes;
+  const std::uint64_t first = nrecords * world.rank() / world.size();
+  const std::uint64_t last = nrecords * (world.rank() + 1) / world.size();
+
+  return ingest_runs<Array>(
+      world, trange, std::move(pmap), [&](auto&& route) {
+        const std::uint64_t chunk_records =
+            std::max<std::uint64_t>(ingest_chunk_bytes() / record_bytes, 1ul);
+        std::vector<char> chunk;
+        std::vector<std::int64_t> index(trange.rank());
+        file.seekg(first * record_bytes);
+        for (std::uint64_t r = first; r < last;) {
+          const std::uint64_t n = std::min(chunk_records, last - r);
+          chunk.resize(n * record_bytes);
+          if (!file.read(chunk.data(), chunk.size()))
+            TA_EXCEPTION("ingest: cannot read file");
+
+          for (std::uint64_t k = 0ul; k < n; ++k, ++r) {
+            numeric_type value;
+            decode(chunk.data() + k * record_bytes, r, index.data(), value);
+            const auto [tile, offset] = ingest_locate(trange, index.data());
+            route(tile, offset, &value, 1ul);
+          }
+        }
+      });
+}
+
+}  // namespace detail
+
+/// Read an array from a file of coordinate records, in parallel
+
+/// Each record of the file holds the indices of an element, as
+/// <tt>trange.rank()</tt> packed integers of type \c Index , followed by its
+/// value, as a \c numeric_type of \c Array ; e.g. a file of
+/// <tt>(i,j,k,l,value)</tt> records of two-electron integrals. The records
+/// may be in any order; elements that are not in the file are zero, and
+/// elements that are given more than once take one of their values. The
+/// records are read in parallel by all processes, each reading a contiguous
+/// range of the file, and the elements are sent in batches to the owners of
+/// their tiles; see \c TA_INGEST_CHUNK_BYTES , \c TA_INGEST_BATCH and
+/// \c TA_INGEST_WINDOW . For sparse arrays the shape is computed from the
+/// assembled tiles, i.e. tiles with no (or only small) elements are zero.
+/// \code
+/// auto g = TiledArray::read_coordinate_file<TiledArray::TSpArrayD>(
+///     world, "eri.bin", trange);
+/// \endcode
+/// \tparam Array The array type; its tiles must be tensors of scalars
+/// \tparam Index The type of the element indices in the file
+/// \param world The world of the result
+/// \param filename The name of the file, which must be readable by all
+/// processes
+/// \param trange The tiled range of the result
+/// \param pmap The process map of the result; the default process map is
+/// used if null
+/// \return The array
+/// \throw TiledArray::Exception if the file cannot be read, if it is not a
+/// whole number of records, or if an element index is out of range
+/// \note This is a collective operation.
+template <typename Array, typename Index = std::int64_t>
+Array read_coordinate_file(
+    World& world, const std::string& filename, const TiledRange& trange,
+    std::shared_ptr<typename Array::pmap_interface> pmap = {}) {
+  typedef typename Array::value_type::value_type numeric_type;
+  static_assert(std::is_integral_v<Index>,
+                "read_coordinate_file: Index must be an integral type");
+  const std::size_t rank = trange.rank();
+  const std::size_t value_offset = rank * sizeof(Index);
+  return detail::ingest<Array>(
+      world, filename, trange, std::move(pmap),
+      value_offset + sizeof(numeric_type),
+      [rank, value_offset](const char* record, std::uint64_t,
+                           std::int64_t* index, numeric_type& value) {
+        for (std::size_t d = 0ul; d < rank; ++d) {
+          Index i;
+          std::memcpy(&i, record + d * sizeof(Index), sizeof(Index));
+          index[d] = i;
+        }
+        std::memcpy(&value, record + value_offset, sizeof(numeric_type));
+      });
+}
+
+/// Read an array from a file of elements in row-major order, in parallel
+
+/// The file holds all elements of the array, as packed values of the
+/// \c numeric_type of \c Array , in row-major order of
+/// <tt>trange.elements_range()</tt>. See read_coordinate_file() for how the
+/// file is read; the segments of the rows that lie within a tile are sent to
+/// its owner as a whole.
+/// \tparam Array The array type; its tiles must be tensors of scalars
+/// \param world The world of the result
+/// \param filename The name of the file, which must be readable by all
+/// processes
+/// \param trange The tiled range of the result
+/// \param pmap The process map of the result; the default process map is
+/// used if null
+/// \return The array
+/// \throw TiledArray::Exception if the file cannot be read, or if it does
+/// not hold <tt>trange.elements_range().volume()</tt> elements
+/// \note This is a collective operation.
+template <typename Array>
+Array read_dense_file(
+    World& world, const std::string& filename, const TiledRange& trange,
+    std::shared_ptr<typename Array::pmap_interface> pmap = {}) {
+  typedef typename Array::value_type::value_type numeric_type;
+  {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) TA_EXCEPTION("read_dense_file: cannot open file");
+    if (std::uint64_t(file.tellg()) !=
+        trange.elements_range().volume() * sizeof(numeric_type))
+      TA_EXCEPTION("read_dense_file: the file size does not match trange");
+  }
+
+  // Every process reads a contiguous range of the elements, in chunks, and
+  // routes each segment of a row that lies within a tile as a single run
+  const std::size_t rank = trange.rank();
+  const std::uint64_t volume = trange.elements_range().volume();
+  const std::uint64_t first = volume * world.rank() / world.size();
+  const std::uint64_t last = volume * (world.rank() + 1) / world.size();
+  return detail::ingest_runs<Array>(
+      world, trange, std::move(pmap), [&](auto&& route) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) TA_EXCEPTION("read_dense_file: cannot open file");
+        const std::uint64_t chunk_size = std::max<std::uint64_t>(
+            detail::ingest_chunk_bytes() / sizeof(numeric_type), 1ul);
+        std::vector<numeric_type> chunk;
+        std::vector<std::int64_t> index(rank);
+        file.seekg(first * sizeof(numeric_type));
+        for (std::uint64_t r = first; r < last;) {
+          const std::uint64_t n = std::min(chunk_size, last - r);
+          chunk.resize(n);
+          if (!file.read(reinterpret_cast<char*>(chunk.data()),
+                         n * sizeof(numeric_type)))
+            TA_EXCEPTION("read_dense_file: cannot read file");
+
+          for (std::uint64_t k = 0ul; k < n;) {
+            std::uint64_t ordinal = r + k;
+            for (std::size_t d = rank; d > 0ul; --d) {
+              const TiledRange1& tr1 = trange.dim(d - 1);
+              index[d - 1] =
+                  tr1.elements_range().first + ordinal % tr1.extent();
+              ordinal /= tr1.extent();
+            }
+            // The run ends at the end of the chunk or of the row of the tile
+            std::uint64_t size = n - k;
+            if (rank > 0ul) {
+              const TiledRange1& tr1 = trange.dim(rank - 1);
+              const auto end =
+                  tr1.tile(tr1.element_to_tile(index[rank - 1])).second;
+              size = std::min<std::uint64_t>(size, end - index[rank - 1]);
+            }
+            const auto [tile, offset] =
+                detail::ingest_locate(trange, index.data());
+            route(tile, offset, chunk.data() + k, size);
+            k += size;
+          }
+          r += n;
+        }
+      });
+}
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_CONVERSIONS_INGEST_H__INCLUDED
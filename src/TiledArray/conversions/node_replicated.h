@@ -0,0 +1,241 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  node_replicated.h
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_NODE_REPLICATED_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_NODE_REPLICATED_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/pmap/replicated_pmap.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define TILEDARRAY_HAS_POSIX_SHM 1
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace TiledArray {
+namespace detail {
+
+#ifdef TILEDARRAY_HAS_POSIX_SHM
+
+/// A memory segment shared by the processes of a node
+
+/// The segment is a POSIX shared memory object that is created by the first
+/// process of the node communicator and mapped by all processes of the node.
+/// The name of the object is unlinked as soon as all processes have mapped
+/// it, i.e. the memory is released when the last process unmaps it, even if
+/// a process terminates abnormally. Unmapping is a local operation, so
+/// segments may be destroyed in any order by different processes.
+class NodeSharedSegment {
+ private:
+  void* data_ = nullptr;  ///< The mapped memory
+  std::size_t bytes_ = 0ul;  ///< The size of the segment
+
+ public:
+  NodeSharedSegment() = delete;
+  NodeSharedSegment(const NodeSharedSegment&) = delete;
+  NodeSharedSegment& operator=(const NodeSharedSegment&) = delete;
+
+  /// Create and map a segment
+
+  /// \param node_comm The communicator of the processes of this node
+  /// \param bytes The size of the segment
+  /// \note This is a collective operation over \c node_comm .
+  NodeSharedSegment(const SafeMPI::Intracomm& node_comm,
+                    const std::size_t bytes)
+      : bytes_(bytes) {
+    TA_ASSERT(bytes_ > 0ul);
+    static std::atomic<unsigned long> counter{0ul};
+
+    MPI_Comm comm = node_comm.Get_mpi_comm();
+    int node_rank = 0;
+    MPI_Comm_rank(comm, &node_rank);
+
+    // The first process creates the object and broadcasts its name
+    char name[64] = {};
+    int error = 0;
+    if (node_rank == 0) {
+      std::snprintf(name, sizeof(name), "/tiledarray.%ld.%lu", long(getpid()),
+                    counter++);
+      const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+      if (fd < 0 || ftruncate(fd, bytes_) != 0) error = 1;
+      if (fd >= 0) close(fd);
+    }
+    MPI_Bcast(name, sizeof(name), MPI_CHAR, 0, comm);
+    MPI_Bcast(&error, 1, MPI_INT, 0, comm);
+    if (error) {
+      if (node_rank == 0) shm_unlink(name);
+      TA_EXCEPTION("NodeSharedSegment: failed to create shared memory object");
+    }
+
+    const int fd = shm_open(name, O_RDWR, 0600);
+    if (fd >= 0) {
+      data_ =
+          mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (data_ == MAP_FAILED) data_ = nullptr;
+    }
+
+    // Every process has mapped the object, so its name can be removed
+    MPI_Barrier(comm);
+    if (node_rank == 0) shm_unlink(name);
+    if (!data_)
+      TA_EXCEPTION("NodeSharedSegment: failed to map shared memory object");
+  }
+
+  ~NodeSharedSegment() {
+    if (data_) munmap(data_, bytes_);
+  }
+
+  /// \return A pointer to the segment
+  void* data() const { return data_; }
+
+  /// \return The size of the segment
+  std::size_t size() const { return bytes_; }
+
+};  // class NodeSharedSegment
+
+#endif  // TILEDARRAY_HAS_POSIX_SHM
+
+}  // namespace detail
+
+/// Replicate an array with one copy per node
+
+/// Like DistArray::make_replicated(), this makes every tile of \c array
+/// available on every process, but the tile data is stored once per node in
+/// shared memory, and the tiles of every process are (zero-copy) views of
+/// the node copy. Only the first process of each node fetches the tiles owned
+/// by other nodes; every process copies its own tiles into the node copy.
+/// This reduces the memory footprint of replicated arrays by a factor of the
+/// number of processes per node.
+/// \tparam Tile The tile type
+/// \tparam Policy The policy type
+/// \param array The array to be replicated
+/// \warning The resulting array is read-only: the tile data is shared by all
+/// processes of a node, hence modifying a tile in place modifies it on all
+/// processes of the node.
+/// \note This is a collective operation. Only plain tensors of scalars (e.g.
+/// TiledArray::Tensor<double>) are stored in shared memory; other tile types,
+/// and platforms without POSIX shared memory, fall back to
+/// DistArray::make_replicated().
+template <typename Tile, typename Policy>
+void make_node_replicated(DistArray<Tile, Policy>& array) {
+#ifdef TILEDARRAY_HAS_POSIX_SHM
+  if constexpr (detail::is_ta_tensor_v<Tile> &&
+                !detail::is_tensor_of_tensor_v<Tile>) {
+    typedef DistArray<Tile, Policy> array_type;
+    typedef typename array_type::ordinal_type ordinal_type;
+    typedef typename Tile::value_type value_type;
+
+    World& world = array.world();
+    const ProcessID rank = world.rank();
+    const ProcessID procs = world.size();
+    if (array.pmap()->is_replicated() || procs == 1) return;
+
+    // Make sure the tiles of array have been assigned
+    world.gop.fence();
+
+    // Find the processes of this node, identified by the world rank of their
+    // first process
+    auto node_comm =
+        world.mpi.comm().Split_type(SafeMPI::Intracomm::SHARED_SPLIT_TYPE, 0);
+    int leader = rank;
+    MPI_Bcast(&leader, 1, MPI_INT, 0, node_comm.Get_mpi_comm());
+    std::vector<int> node_of(procs, 0);
+    node_of[rank] = leader;
+    world.gop.sum(node_of.data(), procs);
+
+    // Layout of the node copy; every tile is cache-line aligned
+    constexpr ordinal_type align =
+        std::max<ordinal_type>(64ul / sizeof(value_type), 1ul);
+    const ordinal_type ntiles = array.size();
+    std::vector<ordinal_type> offsets(ntiles, 0ul);
+    ordinal_type volume = 0ul;
+    for (ordinal_type t = 0ul; t < ntiles; ++t) {
+      if (array.is_zero(t)) continue;
+      offsets[t] = volume;
+      volume += (array.trange().make_tile_range(t).volume() + align - 1ul) /
+                align * align;
+    }
+
+    auto pmap = std::make_shared<detail::ReplicatedPmap>(world, ntiles);
+    array_type result(world, array.trange(), array.shape(), pmap);
+
+    if (volume > 0ul) {
+      auto segment = std::make_shared<detail::NodeSharedSegment>(
+          node_comm, volume * sizeof(value_type));
+      value_type* const data = static_cast<value_type*>(segment->data());
+
+      auto store = [&](const ordinal_type t, const Tile& tile) {
+        TA_ASSERT(tile.range().volume() ==
+                  array.trange().make_tile_range(t).volume());
+        std::copy(tile.data(), tile.data() + tile.range().volume(),
+                  data + offsets[t]);
+      };
+
+      // Every process stores its own tiles
+      for (auto it = array.pmap()->begin(); it != array.pmap()->end(); ++it)
+        if (!array.is_zero(*it)) store(*it, array.find_local(*it).get());
+
+      // The first process of the node fetches the tiles of the other nodes
+      if (rank == leader) {
+        std::vector<ordinal_type> remote;
+        for (ordinal_type t = 0ul; t < ntiles; ++t)
+          if (!array.is_zero(t) && node_of[array.owner(t)] != leader)
+            remote.push_back(t);
+        auto tiles = array.find_batch(remote);
+        for (std::size_t j = 0ul; j < remote.size(); ++j)
+          store(remote[j], tiles[j].get());
+      }
+
+      // Wait for the node copy to be complete
+      world.gop.fence();
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      MPI_Barrier(node_comm.Get_mpi_comm());
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      for (ordinal_type t = 0ul; t < ntiles; ++t)
+        if (!array.is_zero(t))
+          result.set(t, Tile(array.trange().make_tile_range(t),
+                             data + offsets[t], segment));
+    }
+
+    world.gop.fence();
+    array = result;
+  } else {
+    array.make_replicated();
+  }
+#else
+  array.make_replicated();
+#endif  // TILEDARRAY_HAS_POSIX_SHM
+}
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_CONVERSIONS_NODE_REPLICATED_H__INCLUDED
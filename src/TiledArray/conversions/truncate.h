@@ -65,16 +65,17 @@ inline std::enable_if_t<!is_dense_v<Policy>, void> truncate(
     array.world().gop.serial_invoke(
         [thresh] { Policy::shape_type::threshold(thresh); });
   typedef typename DistArray<Tile, Policy>::value_type value_type;
-  array = foreach (array,
-                   [](value_type& result_tile, const value_type& arg_tile) ->
-                   typename Policy::shape_type::value_type {
-                     using result_type =
-                         typename Policy::shape_type::value_type;
-                     result_type arg_tile_norm;
-                     norm(arg_tile, arg_tile_norm);
-                     result_tile = arg_tile;  // Assume this is shallow copy
-                     return arg_tile_norm;
-                   });
+  detail::replace_array(
+      array, foreach (array,
+                      [](value_type& result_tile, const value_type& arg_tile) ->
+                      typename Policy::shape_type::value_type {
+                        using result_type =
+                            typename Policy::shape_type::value_type;
+                        result_type arg_tile_norm;
+                        norm(arg_tile, arg_tile_norm);
+                        result_tile = arg_tile;  // Assume this is shallow copy
+                        return arg_tile_norm;
+                      }));
   if (need_to_change_thresh)
     array.world().gop.serial_invoke(
         [previous_thresh] { Policy::shape_type::threshold(previous_thresh); });
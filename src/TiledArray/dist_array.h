@@ -20,7 +20,11 @@
 #ifndef TILEDARRAY_ARRAY_H__INCLUDED
 #define TILEDARRAY_ARRAY_H__INCLUDED
 
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <deque>
+#include <fstream>
 
 #include <madness/world/parallel_archive.h>
 
@@ -45,6 +49,67 @@ template <typename, bool>
 class TsrExpr;
 }  // namespace expressions
 
+namespace detail {
+
+/// \return The number of tiles that an I/O node fetches ahead of the tile
+/// that it writes, from \c TA_IO_WINDOW (default 32)
+inline std::size_t io_window() {
+  const char* window = getenv("TA_IO_WINDOW");
+  if (window) return std::max<std::size_t>(std::stoul(window), 1ul);
+  return 32ul;
+}
+
+/// \return The default number of I/O nodes of a parallel archive, from
+/// \c TA_IO_NODES (default 8), but no more than the number of processes
+inline int default_num_io_nodes(const World& world) {
+  const char* nio = getenv("TA_IO_NODES");
+  const int result = (nio ? std::max(std::stoi(nio), 1) : 8);
+  return std::min(result, world.size());
+}
+
+/// Identifies, and versions, the trailer that DistArray::store() appends to
+/// every file of a parallel archive
+constexpr std::uint64_t archive_trailer_magic = 0x5441415243480001ul;
+
+/// \return The number of files of parallel archive \c name , i.e. the
+/// number of I/O nodes it was written with; 0 if there is no such archive
+/// \note The number is read from the trailer that DistArray::store()
+/// appends to the first file, which holds the number of I/O nodes and
+/// archive_trailer_magic . For archives without a trailer the files
+/// name.00000, name.00001, ... are counted.
+/// \note This is a collective operation.
+inline int num_archive_files(World& world, const std::string& name) {
+  int nio = 0;
+  if (world.rank() == 0) {
+    auto filename = [&name](const int i) {
+      char result[256];
+      std::snprintf(result, sizeof(result), "%s.%5.5d", name.c_str(), i);
+      return std::string(result);
+    };
+    std::ifstream file(filename(0), std::ios::binary | std::ios::ate);
+    if (file) {
+      std::int32_t recorded = 0;
+      std::uint64_t magic = 0ul;
+      if (std::uint64_t(file.tellg()) >= sizeof(recorded) + sizeof(magic)) {
+        file.seekg(-std::streamoff(sizeof(recorded) + sizeof(magic)),
+                   std::ios::end);
+        file.read(reinterpret_cast<char*>(&recorded), sizeof(recorded));
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+      }
+      if (file && magic == archive_trailer_magic) {
+        nio = recorded;
+      } else {
+        for (nio = 1; nio < world.size(); ++nio)
+          if (!std::ifstream(filename(nio), std::ios::binary)) break;
+      }
+    }
+  }
+  world.gop.broadcast(nio, 0);
+  return nio;
+}
+
+}  // namespace detail
+
 /// A (multidimensional) tiled array
 
 /// DistArray is the local representation of a global object. This means that
@@ -526,6 +591,32 @@ class DistArray : public madness::archive::ParallelSerializableObject {
     return pimpl_->get(i);
   }
 
+  /// Find a batch of local or remote tiles
+
+  /// Unlike calling find() for each tile, the requests for remote tiles are
+  /// grouped by owner, and each group is sent, and answered, as a single
+  /// message.
+  /// \tparam Indices A range of ordinal or coordinate indices
+  /// \param[in] indices The indices of the desired tiles
+  /// \return Futures to the tiles, in the order of \c indices
+  /// \throw TiledArray::Exception When a tile is zero
+  /// \throw TiledArray::Exception If PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \throw TiledArray::Exception if an index is out of bounds. Strong throw
+  ///                              guarantee.
+  template <typename Indices,
+            typename = enable_if_is_integral_or_integral_range<
+                std::decay_t<decltype(*std::begin(std::declval<Indices>()))>>>
+  std::vector<Future<value_type>> find_batch(const Indices& indices) const {
+    const auto& impl = impl_ref();
+    std::vector<ordinal_type> ordinals;
+    for (const auto& i : indices) {
+      check_index(i);
+      ordinals.push_back(impl.tiles_range().ordinal(i));
+    }
+    return impl.get_batch(ordinals);
+  }
+
   /// Find local or remote tile
 
   /// \tparam Integer An integer type
@@ -546,6 +637,10 @@ class DistArray : public madness::archive::ParallelSerializableObject {
 
   /// Find local tile
 
+  /// The future is returned by value, since the future stored by this array
+  /// may be replaced concurrently, e.g. when tile \c i is spilled (see
+  /// enable_out_of_core() ); a spilled tile is read back asynchronously into
+  /// the returned future.
   /// \tparam Index An integral or integral range type
   /// \param i The tile index
   /// \return A \c future to tile \c i
@@ -553,7 +648,7 @@ class DistArray : public madness::archive::ParallelSerializableObject {
   template <typename Index,
             typename = std::enable_if_t<std::is_integral_v<Index> ||
                                         detail::is_integral_range_v<Index>>>
-  const Future<value_type>& find_local(const Index& i) const {
+  Future<value_type> find_local(const Index& i) const {
     check_local_index(i);
     return pimpl_->get_local(i);
   }
@@ -566,35 +661,78 @@ class DistArray : public madness::archive::ParallelSerializableObject {
   /// \throw TiledArray::Exception When tile \c i is zero or not local
   template <typename Integer,
             typename = std::enable_if_t<(std::is_integral_v<Integer>)>>
-  const Future<value_type>& find_local(
+  Future<value_type> find_local(
       const std::initializer_list<Integer>& i) const {
     return find_local<std::initializer_list<Integer>>(i);
   }
 
-  /// Find local tile
+  /// Local completion future
 
-  /// \tparam Index An integral or integral range type
-  /// \param i The tile index
-  /// \return A \c future to tile \c i
-  /// \throw TiledArray::Exception When tile \c i is zero or not local
-  template <typename Index,
-            typename = std::enable_if_t<std::is_integral_v<Index> ||
-                                        detail::is_integral_range_v<Index>>>
-  Future<value_type>& find_local(const Index& i) {
-    check_local_index(i);
-    return pimpl_->get_local(i);
+  /// Expression assignment returns as soon as the tasks that compute the
+  /// result tiles have been submitted; this returns a future that is set once
+  /// every local, non-zero tile of this array has been set, e.g.
+  /// \code
+  /// auto c_ready = (C("i,j") = A("i,k") * B("k,j")).local_ready();
+  /// auto e_ready = (E("i,j") = A("i,j") + D("i,j")).local_ready();
+  /// c_ready.get();  // E may still be computed
+  /// \endcode
+  /// Unlike a fence, this does not wait for unrelated work, so independent
+  /// expressions may overlap.
+  /// \return A future that is set to \c true when all local tiles are set
+  /// \note Only the tiles that have been assigned (or are being computed)
+  /// when this function is called are waited on; tiles that have not been
+  /// accessed are not created, and spilled tiles (see enable_out_of_core() )
+  /// are not read back.
+  /// \throw TiledArray::Exception if the PIMPL is not initialized.
+  Future<bool> local_ready() const {
+    std::vector<Future<value_type>> tiles = impl_ref().pending_local();
+    return world().taskq.add(
+        [](const std::vector<Future<value_type>>&) { return true; },
+        std::move(tiles), madness::TaskAttributes::hipri());
   }
 
-  /// Find local tile
+  /// Number of pending local tile sets
 
-  /// \tparam Integer An integral type
-  /// \param i The tile index, as an \c std::initializer_list<Integer>
-  /// \return A \c future to tile \c i
-  /// \throw TiledArray::Exception When tile \c i is zero or not local
-  template <typename Integer,
-            typename = std::enable_if_t<(std::is_integral_v<Integer>)>>
-  Future<value_type>& find_local(const std::initializer_list<Integer>& i) {
-    return find_local<std::initializer_list<Integer>>(i);
+  /// No communication.
+  /// \return The number of local tiles that have been assigned futures, e.g.
+  /// by init_tiles(), fill() or an expression, that are not yet set
+  /// \throw TiledArray::Exception if the PIMPL is not initialized.
+  ordinal_type pending_tiles() const { return impl_ref().pending_tiles(); }
+
+  /// Completion-counted local ready future
+
+  /// Every local tile set with a future that is not yet set, e.g. by
+  /// init_tiles(), fill() or an expression, is counted until its future is
+  /// set; this returns a future that is set once the count drops to zero.
+  /// Unlike local_ready(), it does not visit the local tiles, so it can be
+  /// used to chain stages without fences, e.g.
+  /// \code
+  /// a.fill(1.0);
+  /// auto done = world.taskq.add([&a](bool) { /* use the local tiles of a */
+  ///                                          return true; },
+  ///                             a.ready());
+  /// \endcode
+  /// \return A future that is set to \c true once no local tile set is
+  /// pending
+  /// \note Tiles that are set by other processes are counted only once they
+  /// arrive; tiles that are never set are not waited on (see local_ready()).
+  /// \throw TiledArray::Exception if the PIMPL is not initialized.
+  Future<bool> ready() const { return impl_ref().ready(); }
+
+  /// Wait until all tiles of this array are set
+
+  /// Blocks (while processing tasks) until the local tiles of this array are
+  /// set, see local_ready(), and then synchronizes with the other processes.
+  /// Unlike <tt>world().gop.fence()</tt> , this does not wait for unrelated
+  /// tasks and messages. The tiles in the cache of remote tiles (see
+  /// enable_remote_cache() ) are dropped, since the tiles may have been
+  /// modified in place before this synchronization point.
+  /// \note This is a collective operation.
+  /// \throw TiledArray::Exception if the PIMPL is not initialized.
+  void wait_ready() const {
+    local_ready().get();
+    world().gop.barrier();
+    pimpl_->invalidate_remote_cache();
   }
 
   /// Set a tile and fill it using a sequence
@@ -695,6 +833,29 @@ class DistArray : public madness::archive::ParallelSerializableObject {
     set<std::initializer_list<Integer>>(i, value);
   }
 
+  /// Set a batch of tiles
+
+  /// Unlike calling set() for each tile, the remote tiles are grouped by
+  /// owner, and each group is sent as a single message.
+  /// \tparam Tiles A range of (index, tile) pairs, where the index is an
+  ///               ordinal or coordinate index
+  /// \param[in] tiles The indices and values of the tiles to set
+  /// \throw TiledArray::Exception If PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \throw TiledArray::Exception if an index is out of bounds. Strong throw
+  ///                              guarantee.
+  /// \throw TiledArray::Exception if a tile is already set.
+  template <typename Tiles>
+  void set_batch(const Tiles& tiles) {
+    auto& impl = impl_ref();
+    std::vector<std::pair<ordinal_type, value_type>> batch;
+    for (const auto& [i, tile] : tiles) {
+      check_index(i);
+      batch.emplace_back(impl.tiles_range().ordinal(i), tile);
+    }
+    impl.set_batch(batch);
+  }
+
   /// Set a tile directly using a future to a tile
 
   /// \tparam Index For an ordinal index should be an integral type and for a
@@ -830,6 +991,9 @@ class DistArray : public madness::archive::ParallelSerializableObject {
   ///                              guarantee.
   /// \throw TiledArray::Exception if a tile is already set and skip_set is
   ///                              false. Weak throw guarantee.
+  /// \note The tiles are computed asynchronously; use ready() (or
+  /// pending_tiles() ) to know when the local tiles are set, instead of a
+  /// fence.
   template <typename Op>
   void init_tiles(Op&& op, bool skip_set = false) {
     // lifetime management of op depends on whether it is a lvalue ref (i.e. has
@@ -1172,8 +1336,8 @@ class DistArray : public madness::archive::ParallelSerializableObject {
       auto pmap = std::make_shared<detail::ReplicatedPmap>(world(), size());
       DistArray_ result = DistArray_(world(), trange(), shape(), pmap);
 
-      // Create the replicator object that will do an all-to-all broadcast of
-      // the local tile data.
+      // Create the replicator object that will do a tree broadcast of the
+      // local tile data of every process.
       auto replicator =
           std::make_shared<detail::Replicator<DistArray_>>(*this, result);
 
@@ -1186,6 +1350,210 @@ class DistArray : public madness::archive::ParallelSerializableObject {
     }
   }
 
+  /// Redistribute the tiles of this array
+
+  /// The tiles are moved directly to their new owners, i.e. unlike assigning
+  /// this array to a new array with the desired process map, no second copy
+  /// of the array is allocated. Tiles that remain local are not copied, and
+  /// the number of tiles in transit from each process is bounded by
+  /// \c max_in_flight . All arrays that share the implementation of this
+  /// array (i.e. shallow copies) see the new distribution. Redistributing a
+  /// replicated array drops the copies of the tiles that are not local any
+  /// more, and redistributing to a replicated process map broadcasts each
+  /// tile from its owner to every other process.
+  /// \param pmap The new tile-process map
+  /// \param max_in_flight The maximum number of tiles in transit from each
+  /// process
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \throw TiledArray::Exception if \c pmap is not compatible with this
+  ///                              array. Strong throw guarantee.
+  /// \note This is a collective operation. It waits for the pending tile
+  /// assignments of this array, and all processes are synchronized with a
+  /// fence before it returns.
+  void redistribute(const std::shared_ptr<pmap_interface>& pmap,
+                    const std::size_t max_in_flight = 16ul) {
+    auto& impl = impl_ref();
+    TA_ASSERT(pmap);
+    TA_ASSERT(pmap->size() == impl.size());
+    TA_ASSERT(pmap->rank() ==
+              typename pmap_interface::size_type(world().rank()));
+    TA_ASSERT(pmap->procs() ==
+              typename pmap_interface::size_type(world().size()));
+    if (pmap == impl.pmap()) return;
+
+    // Wait for the local tiles to be assigned
+    world().gop.fence();
+    pimpl_->redistribute(pmap, max_in_flight);
+    // Wait for the incoming tiles
+    world().gop.fence();
+  }
+
+  /// Compress the tiles of this array while they are in transit
+
+  /// Once set, the tiles that this process sends to remote owners with
+  /// set() , and the remote tiles that it requests with find() , are
+  /// encoded with \c codec while in transit, e.g.
+  /// \code
+  /// // lossy, with an error below the zero threshold of the shape
+  /// t2.set_codec(TileCodec::bounded(SparseShape<float>::threshold()));
+  /// \endcode
+  /// This trades compute for bandwidth, and pays off for compressible tiles,
+  /// e.g. tiles with many near-zero elements. Only tensors of trivially
+  /// copyable scalars are encoded. See write_checkpoint() for compressing
+  /// tiles on disk.
+  /// \note Only the transfers of set() , find() , set_batch() and
+  /// find_batch() are encoded. The tiles that expressions broadcast, notably
+  /// the arguments of SUMMA contractions, are sent uncompressed.
+  /// \param codec The codec; a default-constructed TileCodec disables
+  ///        encoding
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \note This is a local operation; it must not be called while tasks
+  /// access this array.
+  void set_codec(const TileCodec& codec) { impl_ref().set_codec(codec); }
+
+  /// \return The codec of the tiles that are sent to other processes
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  const TileCodec& codec() const { return impl_ref().codec(); }
+
+  /// Enable the per-process cache of remote tiles
+
+  /// Once enabled, find() serves repeated requests for the same remote tile
+  /// from a cache on this process, and concurrent requests for a tile that is
+  /// in transit share a single message. This benefits algorithms that fetch
+  /// the same remote tiles many times, e.g. integral-direct Fock builds.
+  /// Setting a remote tile drops it from the cache of this process, and the
+  /// cached tiles are dropped at the end of every fence
+  /// (<tt>world().gop.fence()</tt> ). Cached tiles become stale if their
+  /// owner modifies them in place between fences; the caches are invalidated
+  /// on every process by foreach_inplace() , truncate() , redistribute() and
+  /// wait_ready() , and the cache bound carries over to the array that
+  /// foreach_inplace() and truncate() assign. After other in-place
+  /// modifications (e.g. via a non-const reference) call
+  /// invalidate_remote_cache() on every process.
+  /// \param max_bytes The maximum size of the cached tiles, in bytes; the
+  ///        least recently used tiles are evicted first
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \note This is a local operation.
+  void enable_remote_cache(const std::size_t max_bytes) {
+    impl_ref().enable_remote_cache(max_bytes);
+  }
+
+  /// Disable the per-process cache of remote tiles
+
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \note This is a local operation; it must not be called while tasks
+  /// access this array.
+  void disable_remote_cache() { impl_ref().disable_remote_cache(); }
+
+  /// Drop the tiles in the per-process cache of remote tiles
+
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \note This is a local operation.
+  void invalidate_remote_cache() { impl_ref().invalidate_remote_cache(); }
+
+  /// \return The maximum size of the cached remote tiles, in bytes, or 0 if
+  /// the cache is disabled
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  std::size_t remote_cache_max_bytes() const {
+    return impl_ref().remote_cache_max_bytes();
+  }
+
+  /// Enable spilling of the local tiles to a scratch file
+
+  /// Once enabled, the least recently used local tiles are written to a
+  /// per-process scratch file, and dropped from memory, whenever the local
+  /// tiles exceed \c max_bytes . A spilled tile is read back asynchronously
+  /// when it is next requested by find() or find_local() , so requesting
+  /// tiles ahead of their use overlaps the reads with computation.
+  /// \note A contraction requests the tiles of an array argument one SUMMA
+  /// step at a time, a bounded number of steps (see \c TA_SUMMA_MAX_DEPTH )
+  /// ahead of their use, and starts reading the local tiles of each step
+  /// before the tiles of the previous step are broadcast, so the reads of
+  /// spilled argument tiles overlap with the computation of the previous
+  /// steps.
+  /// Element-wise expressions request all local tiles of their arguments when
+  /// they are evaluated, i.e. the spilled tiles are read back at once.
+  /// \param max_bytes The maximum size of the resident local tiles, in bytes
+  /// \param dir The scratch directory; if empty, \c TA_SCRATCH_DIR , or
+  ///        \c /tmp if it is not set, is used
+  /// \throw TiledArray::Exception if the PIMPL is not initialized, or if the
+  ///                              scratch file cannot be created
+  /// \warning Tiles must not be modified in place while spilling is enabled.
+  /// \note This is a local operation; it must not be called while tasks
+  /// access this array.
+  void enable_out_of_core(const std::size_t max_bytes,
+                          const std::string& dir = std::string()) {
+    impl_ref().enable_out_of_core(max_bytes, dir);
+  }
+
+  /// Disable spilling of the local tiles, and read the spilled tiles back
+
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \note This is a local operation; it must not be called while tasks
+  /// access this array.
+  void disable_out_of_core() { impl_ref().disable_out_of_core(); }
+
+  /// \return The total size of the local tiles that are resident in memory
+  /// while spilling is enabled, in bytes; 0 if spilling is disabled
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  std::size_t resident_bytes() const { return impl_ref().resident_bytes(); }
+
+  /// Size of the local tiles
+
+  /// Counts the data of the local tiles that have been assigned, including
+  /// tiles that share their data with other arrays. No communication.
+  /// \return The total size of the local tiles of this array, in bytes
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \sa tensor_bytes() for the tensor data of this process
+  std::size_t local_bytes() const { return impl_ref().local_bytes(); }
+
+  /// Memory peak of the expression that produced this array
+
+  /// Every expression evaluation measures the tensor data allocated by this
+  /// process from its start until the local tiles of its result have been
+  /// set, including the temporaries of the expression engines and the result
+  /// tiles, e.g.
+  /// \code
+  /// C("i,j") = A("i,k") * B("k,j");
+  /// world.gop.fence();
+  /// const std::size_t peak = C.expression_peak_bytes();
+  /// \endcode
+  /// Since the evaluations are measured separately, concurrent evaluations
+  /// do not reset each other's peak, but each peak includes the allocations
+  /// of the evaluations that overlap it. No communication.
+  /// \return The peak increase of the tensor data of this process during the
+  /// evaluation of the expression that produced this array, in bytes; 0 if
+  /// this array was not produced by an expression
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \sa TensorBytesPeak
+  std::size_t expression_peak_bytes() const {
+    return impl_ref().expression_peak_bytes();
+  }
+
+  /// Size of the tiles
+
+  /// \return The total size of the tiles of this array on all processes, in
+  /// bytes (see local_bytes() )
+  /// \throw TiledArray::Exception if the PIMPL is not initialized. Strong throw
+  ///                              guarantee.
+  /// \note This is a collective operation.
+  std::size_t bytes() const {
+    std::size_t result = local_bytes();
+    world().gop.sum(result);
+    return result;
+  }
+
   /// Update shape data and remove tiles that are below the zero threshold
   /// \param[in] thresh the threshold below which the tiles are considered
   ///        to be zero (only for sparse arrays will such tiles be discarded)
@@ -1290,7 +1658,9 @@ class DistArray : public madness::archive::ParallelSerializableObject {
 
   /// @tparam Archive a parallel MADWorld Archive type
   /// @param world a World object with which this object will be associated
-  /// @param ar an Archive object from which this object's data will be read
+  /// @param ar an Archive object from which this object's data will be read;
+  ///        it must be opened with as many I/O nodes as the archive was
+  ///        written with, see detail::num_archive_files()
   ///
   /// @note The & operator for serializing will only work with parallel
   ///       MADWorld archives.
@@ -1298,6 +1668,40 @@ class DistArray : public madness::archive::ParallelSerializableObject {
   ///       completion, if @c ar.dofence() is true
   template <typename Archive>
   void load(World& world, Archive& ar) {
+    load<DistArray_>(world, ar, [](Tile&& tile) -> Tile&& {
+      return std::move(tile);
+    });
+  }
+
+  /// Replaces this array with one loaded from an Archive object that holds
+  /// an array of a different type, using the default processor map
+
+  /// Each tile is converted as soon as it has been read, before it is
+  /// inserted into this array, i.e. the array of type \p SourceArray is never
+  /// held in memory. This allows e.g. restarting in single precision from
+  /// an archive written in double precision.
+  /// @tparam SourceArray the type of the array held by @c ar ; must have the
+  ///         same policy as this array
+  /// @tparam Archive a parallel MADWorld Archive type
+  /// @tparam Converter a callable that converts a
+  ///         <tt>SourceArray::value_type&&</tt> to a @c Tile or a
+  ///         @c Future<Tile>
+  /// @param world a World object with which this object will be associated
+  /// @param ar an Archive object from which this object's data will be read;
+  ///        it must be opened with as many I/O nodes as the archive was
+  ///        written with, see detail::num_archive_files()
+  /// @param convert the tile converter; the default uses TiledArray::Cast
+  /// @throw TiledArray::Exception if @c ar does not hold a @c SourceArray
+  /// @note This is a collective operation that fences before and after
+  ///       completion, if @c ar.dofence() is true
+  template <typename SourceArray, typename Archive,
+            typename Converter =
+                TiledArray::Cast<Tile, typename SourceArray::value_type>>
+  void load(World& world, Archive& ar, Converter&& convert = Converter{}) {
+    static_assert(
+        std::is_same_v<typename SourceArray::policy_type, policy_type>,
+        "DistArray::load: the source array must have the same policy");
+    typedef typename SourceArray::value_type source_tile_type;
     auto me = world.rank();
     const Tag tag = world.mpi.unique_tag();  // for broadcasting metadata
 
@@ -1308,10 +1712,9 @@ class DistArray : public madness::archive::ParallelSerializableObject {
       auto& localar = ar.local_archive();
 
       // make sure source data matches the expected type
-      // TODO would be nice to be able to convert the data upon reading
       std::size_t typeid_hash = 0l;
       localar& typeid_hash;
-      if (typeid_hash != typeid(*this).hash_code())
+      if (typeid_hash != typeid(SourceArray).hash_code())
         TA_EXCEPTION(
             "DistArray::load: source DistArray type != this DistArray type");
 
@@ -1347,9 +1750,9 @@ class DistArray : public madness::archive::ParallelSerializableObject {
         if (!is_zero(ord)) {
           auto owner_rank = pmap->owner(ord);
           if (ar.io_node(owner_rank) == me) {
-            Tile tile;
+            source_tile_type tile;
             localar& tile;
-            this->set(ord, std::move(tile));
+            this->set(ord, convert(std::move(tile)));
             --count;
           }
         }
@@ -1403,22 +1806,30 @@ class DistArray : public madness::archive::ParallelSerializableObject {
       // assigned to this I/O node in order ...
       // for sanity check dump tile count assigned to this I/O node
       const auto volume = trange().tiles_range().volume();
-      int64_t count = 0;
+      std::vector<ordinal_type> ordinals;
       for (size_t ord = 0; ord != volume; ++ord) {
         if (!is_zero(ord)) {
           const auto owner_rank = pmap()->owner(ord);
-          if (ar.io_node(owner_rank) == me) {
-            ++count;
-          }
+          if (ar.io_node(owner_rank) == me) ordinals.push_back(ord);
         }
       }
+      int64_t count = ordinals.size();
       localar& count;
-      for (size_t ord = 0; ord != volume; ++ord) {
-        if (!is_zero(ord)) {
-          auto owner_rank = pmap()->owner(ord);
-          if (ar.io_node(owner_rank) == me) localar& find(ord).get();
-        }
+      // ... keeping up to io_window() fetches in flight, so that fetching
+      // the remote tiles overlaps with writing
+      const std::size_t window = detail::io_window();
+      std::deque<Future<value_type>> tiles;
+      auto next = ordinals.begin();
+      for (int64_t written = 0; written != count; ++written) {
+        while (next != ordinals.end() && tiles.size() < window)
+          tiles.push_back(find(*next++));
+        localar& tiles.front().get();
+        tiles.pop_front();
       }
+      // ... and finally the trailer, which load() does not read, so that
+      // readers can open the archive with as many I/O nodes as it was
+      // written with (see detail::num_archive_files() )
+      localar& std::int32_t(ar.num_io_nodes()) & detail::archive_trailer_magic;
     }  // am I an I/O node?
     if (ar.dofence()) world().gop.fence();
   }
@@ -1678,16 +2089,39 @@ struct ArchiveStoreImpl<ParallelOutputArchive,
 template <class Tile, class Policy>
 void save(const TiledArray::DistArray<Tile, Policy>& x,
           const std::string name) {
-  archive::ParallelOutputArchive ar2(x.world(), name.c_str(), 1);
+  archive::ParallelOutputArchive ar2(
+      x.world(), name.c_str(),
+      TiledArray::detail::default_num_io_nodes(x.world()));
   ar2& x;
 }
 
 template <class Tile, class Policy>
 void load(TiledArray::DistArray<Tile, Policy>& x, const std::string name) {
-  archive::ParallelInputArchive ar2(x.world(), name.c_str(), 1);
+  // use as many I/O nodes as the archive was written with
+  World& world = x.world();
+  const int nio = TiledArray::detail::num_archive_files(world, name);
+  archive::ParallelInputArchive ar2(world, name.c_str(), std::max(nio, 1));
   ar2& x;
 }
 
+/// Loads an array saved by save() from an array of a different type,
+/// converting each tile as it is read
+
+/// \tparam SourceArray The type of the saved array
+/// \param x The result
+/// \param name The name of the archive
+/// \param convert The tile converter, see DistArray::load()
+template <class SourceArray, class Tile, class Policy,
+          class Converter =
+              TiledArray::Cast<Tile, typename SourceArray::value_type>>
+void load(TiledArray::DistArray<Tile, Policy>& x, const std::string name,
+          Converter&& convert = Converter{}) {
+  World& world = x.world();
+  const int nio = TiledArray::detail::num_archive_files(world, name);
+  archive::ParallelInputArchive ar2(world, name.c_str(), std::max(nio, 1));
+  x.template load<SourceArray>(world, ar2, std::forward<Converter>(convert));
+}
+
 }  // namespace madness
 
 #endif  // TILEDARRAY_ARRAY_H__INCLUDED
@@ -266,6 +266,19 @@ class ArrayEvalImpl
     return eval_tile(tile, consumable_tile);
   }
 
+  /// Prepare a tile that will be requested soon
+
+  /// If tile \c i is a local tile of the array, it is requested from the
+  /// array, which starts reading it back if it has been spilled (see
+  /// DistArray::enable_out_of_core() ). Remote tiles are not requested.
+  /// \param i The index of the tile
+  virtual void prefetch_tile(ordinal_type i) const {
+    auto array_index = DistEvalImpl_::perm_index_to_source(i);
+    if (block_range_.rank()) array_index = block_range_.ordinal(array_index);
+    if (array_.is_local(array_index) && !array_.is_zero(array_index))
+      array_.find_local(array_index);
+  }
+
   /// Discard a tile that is not needed
 
   /// This function handles the cleanup for tiles that are not needed in
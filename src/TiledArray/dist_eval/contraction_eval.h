@@ -567,6 +567,37 @@ class Summa
     get_vector(right_, begin, end, right_stride_local_, row);
   }
 
+  /// Prepare the local non-zero tiles of a row or column of \c arg
+
+  /// \tparam Arg The argument type
+  /// \param arg The owner of the input tiles
+  /// \param index The index of the first tile
+  /// \param end The end of the range of tiles
+  /// \param stride The stride between tile indices
+  template <typename Arg>
+  static void prefetch_vector(const Arg& arg, ordinal_type index,
+                              const ordinal_type end,
+                              const ordinal_type stride) {
+    if (index >= end || !arg.is_local(index)) return;
+    for (; index < end; index += stride)
+      if (!arg.shape().is_zero(index)) arg.prefetch(index);
+  }
+
+  /// Prepare the local tiles of column \c k of \c left_ and row \c k of
+  /// \c right_
+
+  /// Starts reading the local argument tiles of step \c k , e.g. from
+  /// out-of-core storage, before they are collected by get_col() and
+  /// get_row() .
+  /// \param k The step
+  void prefetch(const ordinal_type k) const {
+    prefetch_vector(left_, left_start_local_ + k, left_end_,
+                    left_stride_local_);
+    const ordinal_type begin = k * proc_grid_.cols();
+    prefetch_vector(right_, begin + proc_grid_.rank_col(),
+                    begin + proc_grid_.cols(), right_stride_local_);
+  }
+
   /// Broadcast tiles from \c arg
 
   /// \param[in] start The index of the first tile to be broadcast
@@ -1409,8 +1440,14 @@ class Summa
 
     DenseStepTask(DenseStepTask* const parent, const int ndep)
         : StepTask(parent, ndep), k_(parent->k_ + 1ul) {
-      // Spawn tasks to get k-th row and column tiles
-      if (k_ < owner_->k_) StepTask::spawn_get_row_col_tasks(k_);
+      if (k_ < owner_->k_) {
+        // Start reading the local k-th row and column tiles now, i.e. before
+        // the parent step broadcasts its tiles
+        owner_->prefetch(k_);
+
+        // Spawn tasks to get k-th row and column tiles
+        StepTask::spawn_get_row_col_tasks(k_);
+      }
     }
 
     virtual ~DenseStepTask() {}
@@ -1442,6 +1479,9 @@ class Summa
         // NOTE: The order of task submissions is dependent on the order in
         // which we want the tasks to complete.
 
+        // Start reading the local k-th row and column tiles
+        owner_->prefetch(k);
+
         // Spawn tasks to get k-th row and column tiles
         StepTask::spawn_get_row_col_tasks(k);
 
@@ -145,6 +145,15 @@ class DistEvalImpl : public TensorImpl<Policy>,
   /// \param i The index of the tile
   virtual void discard_tile(ordinal_type i) const = 0;
 
+  /// Prepare a tile that will be requested soon
+
+  /// This function may start reading the data of tile \c i , e.g. from
+  /// out-of-core storage, so that a subsequent call to \c get_tile() does not
+  /// wait for it. It does not evaluate the tile. The default implementation
+  /// does nothing.
+  /// \param i The index of the tile
+  virtual void prefetch_tile(ordinal_type i) const {}
+
   /// Set tensor value
 
   /// This will store \c value at ordinal index \c i . Typically, this
@@ -360,6 +369,11 @@ class DistEval {
   /// \param i The index of the tile
   virtual void discard(ordinal_type i) const { pimpl_->discard_tile(i); }
 
+  /// Prepare a tile that will be requested soon
+
+  /// \param i The index of the tile
+  void prefetch(ordinal_type i) const { pimpl_->prefetch_tile(i); }
+
   /// World object accessor
 
   /// \return A reference to the world object
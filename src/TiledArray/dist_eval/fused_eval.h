@@ -0,0 +1,351 @@
+/*
+ * This file is a part of TiledArray.
+ * Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_FUSED_EVAL_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_FUSED_EVAL_H__INCLUDED
+
+#include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/tile_op/fused.h>
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+namespace detail {
+
+/// Argument of a fused, element-wise distributed evaluator
+
+/// This type-erases the distributed evaluators of the arguments of
+/// FusedEvalImpl, which in general have different tile types, e.g. lazy array
+/// tiles and tiles computed by other expressions.
+/// \tparam Tile The tile type the argument tiles are converted to
+/// \tparam Policy The tensor policy class
+template <typename Tile, typename Policy>
+class FusedEvalArg {
+ public:
+  typedef typename Policy::ordinal_type ordinal_type;  ///< Ordinal type
+  typedef typename Policy::pmap_interface
+      pmap_interface;  ///< Process map interface type
+
+  virtual ~FusedEvalArg() {}
+
+  /// Evaluate the argument, see DistEval::eval()
+  virtual void eval() = 0;
+
+  /// Wait for the local tiles of the argument, see DistEval::wait()
+  virtual void wait() const = 0;
+
+  /// \return The process map of the argument
+  virtual const std::shared_ptr<pmap_interface>& pmap() const = 0;
+
+  /// \param i The tile index
+  /// \return \c true if tile \c i is zero
+  virtual bool is_zero(ordinal_type i) const = 0;
+
+  /// Discard tile \c i , see DistEval::discard()
+  virtual void discard(ordinal_type i) const = 0;
+
+  /// \return The permutation that the fused kernel applies to the tiles of
+  /// the argument as it reads them
+  virtual const Permutation& perm() const = 0;
+
+  /// Request tile \c i for \c task
+
+  /// \c task will not run before tile \c i has been computed
+  /// \param i The tile index
+  /// \param task The task that depends on tile \c i
+  /// \return A function that returns tile \c i , converted to \c Tile but
+  /// not permuted (see perm() ), and a flag that is \c true if the tile may
+  /// be overwritten; must only be called by \c task
+  virtual std::function<std::pair<Tile, bool>()> get(
+      ordinal_type i, madness::TaskInterface* task) const = 0;
+
+};  // class FusedEvalArg
+
+/// Distributed evaluator as an argument of a fused evaluator
+
+/// The tiles of \c Arg may be permuted by the fused kernel, which reads them
+/// through their permuted strides (see Fused ), rather than by \c Arg ,
+/// so that no permuted copy of the tiles is made.
+/// \tparam Tile The tile type the argument tiles are converted to
+/// \tparam Policy The tensor policy class
+/// \tparam Arg The distributed evaluator type
+template <typename Tile, typename Policy, typename Arg>
+class FusedEvalArgImpl : public FusedEvalArg<Tile, Policy> {
+ public:
+  typedef FusedEvalArg<Tile, Policy> FusedEvalArg_;  ///< Base class type
+  typedef typename FusedEvalArg_::ordinal_type ordinal_type;  ///< Ordinal type
+  typedef typename FusedEvalArg_::pmap_interface
+      pmap_interface;  ///< Process map interface type
+  typedef typename Arg::value_type value_type;  ///< Argument tile type
+
+  static_assert(std::is_same_v<value_type, Tile> ||
+                    std::is_same_v<typename eval_trait<value_type>::type, Tile>,
+                "FusedEvalArgImpl: the argument tiles must evaluate to Tile");
+
+ private:
+  Arg arg_;           ///< The distributed evaluator
+  Permutation perm_;  ///< The permutation applied to the tiles of \c arg_
+
+ public:
+  /// \param arg The distributed evaluator
+  /// \param perm The permutation applied to the tiles of \c arg
+  explicit FusedEvalArgImpl(const Arg& arg, const Permutation& perm = {})
+      : arg_(arg), perm_(perm) {}
+
+  virtual ~FusedEvalArgImpl() {}
+
+  virtual void eval() { arg_.eval(); }
+
+  virtual void wait() const { arg_.wait(); }
+
+  virtual const std::shared_ptr<pmap_interface>& pmap() const {
+    return arg_.pmap();
+  }
+
+  virtual bool is_zero(ordinal_type i) const { return arg_.is_zero(i); }
+
+  virtual void discard(ordinal_type i) const { arg_.discard(i); }
+
+  virtual const Permutation& perm() const { return perm_; }
+
+  virtual std::function<std::pair<Tile, bool>()> get(
+      ordinal_type i, madness::TaskInterface* task) const {
+    Future<value_type> tile = arg_.get(i);
+    if (!tile.probe()) {
+      task->inc();
+      tile.register_callback(task);
+    }
+    const bool permuted = bool(perm_);
+    return [tile, permuted]() -> std::pair<Tile, bool> {
+      // Lazy (i.e. array) tiles are consumable only if they are copies of the
+      // array tiles, computed tiles always are; permuted tiles are never
+      // overwritten, since the result is not in their element order
+      bool consumable = !permuted;
+      if constexpr (is_lazy_tile_v<value_type>)
+        consumable = consumable && tile.get().is_consumable();
+      Tile result;
+      if constexpr (std::is_same_v<value_type, Tile>)
+        result = tile.get();
+      else
+        result = static_cast<Tile>(tile.get());
+      return {std::move(result), consumable};
+    };
+  }
+
+};  // class FusedEvalArgImpl
+
+/// Construct a fused evaluator argument
+
+/// \tparam Tile The tile type the argument tiles are converted to
+/// \tparam Policy The tensor policy class
+/// \tparam Arg The distributed evaluator type
+/// \param arg The distributed evaluator
+/// \param perm The permutation applied to the tiles of \c arg
+/// \return A shared pointer to the fused evaluator argument
+template <typename Tile, typename Policy, typename Arg>
+std::shared_ptr<FusedEvalArg<Tile, Policy>> make_fused_eval_arg(
+    const Arg& arg, const Permutation& perm = {}) {
+  return std::make_shared<FusedEvalArgImpl<Tile, Policy, Arg>>(arg, perm);
+}
+
+/// The arguments of a fused evaluator
+template <typename Tile, typename Policy>
+using FusedEvalArgs = std::vector<std::shared_ptr<FusedEvalArg<Tile, Policy>>>;
+
+/// Fused, element-wise distributed evaluator
+
+/// This object evaluates an element-wise expression of any number of
+/// arguments, e.g. <tt>2 * a + b - c * d</tt>, by one task per result tile
+/// that evaluates the whole expression in a single pass over the elements
+/// (see Fused ), rather than by a tree of BinaryEvalImpl and UnaryEvalImpl
+/// objects, each of which creates intermediate tiles.
+/// \tparam Tile The result and argument tile type
+/// \tparam Policy The tensor policy class
+/// \tparam Op The block operation type, see Fused
+template <typename Tile, typename Policy, typename Op>
+class FusedEvalImpl
+    : public DistEvalImpl<Tile, Policy>,
+      public std::enable_shared_from_this<FusedEvalImpl<Tile, Policy, Op>> {
+ public:
+  typedef FusedEvalImpl<Tile, Policy, Op>
+      FusedEvalImpl_;  ///< This object type
+  typedef DistEvalImpl<Tile, Policy> DistEvalImpl_;  ///< The base class type
+  typedef typename DistEvalImpl_::TensorImpl_
+      TensorImpl_;  ///< The base, base class type
+  typedef typename DistEvalImpl_::ordinal_type ordinal_type;  ///< Ordinal type
+  typedef typename DistEvalImpl_::range_type range_type;      ///< Range type
+  typedef typename DistEvalImpl_::shape_type shape_type;      ///< Shape type
+  typedef typename DistEvalImpl_::pmap_interface
+      pmap_interface;  ///< Process map interface type
+  typedef
+      typename DistEvalImpl_::trange_type trange_type;    ///< Tiled range type
+  typedef typename DistEvalImpl_::value_type value_type;  ///< Tile type
+  typedef FusedEvalArgs<Tile, Policy> args_type;  ///< The argument list type
+  typedef Fused<Tile, Op> op_type;  ///< Tile evaluation operator type
+
+  using std::enable_shared_from_this<FusedEvalImpl_>::shared_from_this;
+
+ private:
+  args_type args_;                 ///< The arguments
+  std::vector<Permutation> perms_;  ///< The permutations of the arguments
+  op_type op_;                      ///< The fused tile operation
+
+  /// Task that evaluates one result tile
+  class EvalTileTask : public madness::TaskInterface {
+   private:
+    std::shared_ptr<FusedEvalImpl_> owner_;  ///< The parent evaluator
+    ordinal_type index_;  ///< The result tile index (target index space)
+    std::vector<std::function<std::pair<Tile, bool>()>>
+        args_;  ///< The argument tiles; empty for zero tiles
+
+   public:
+    /// \param owner The parent evaluator
+    /// \param target_index The result tile index
+    /// \param source_index The argument tile index
+    EvalTileTask(const std::shared_ptr<FusedEvalImpl_>& owner,
+                 const ordinal_type target_index,
+                 const ordinal_type source_index)
+        : madness::TaskInterface(madness::TaskAttributes()),
+          owner_(owner),
+          index_(target_index) {
+      args_.reserve(owner_->args_.size());
+      for (const auto& arg : owner_->args_) {
+        if (arg->is_zero(source_index))
+          args_.emplace_back();
+        else
+          args_.emplace_back(arg->get(source_index, this));
+      }
+    }
+
+    virtual ~EvalTileTask() {}
+
+    virtual void run(const madness::TaskThreadEnv&) {
+      std::vector<Tile> tiles(args_.size());
+      std::vector<bool> consumable(args_.size(), false);
+      for (std::size_t a = 0ul; a < args_.size(); ++a) {
+        if (!args_[a]) continue;
+        auto arg = args_[a]();
+        tiles[a] = std::move(arg.first);
+        consumable[a] = arg.second;
+      }
+      args_.clear();
+      owner_->set_tile(index_,
+                       owner_->op_(tiles, consumable, owner_->perms_));
+    }
+
+  };  // class EvalTileTask
+
+ public:
+  /// Construct a fused evaluator
+
+  /// \param args The arguments, in the order expected by \c op
+  /// \param world The world where the tensor lives
+  /// \param trange The tiled range object
+  /// \param shape The tensor shape object
+  /// \param pmap The tile-process map
+  /// \param perm The permutation that is applied to tile indices
+  /// \param op The fused tile operation
+  template <typename Perm, typename = std::enable_if_t<
+                               TiledArray::detail::is_permutation_v<Perm>>>
+  FusedEvalImpl(const args_type& args, World& world, const trange_type& trange,
+                const shape_type& shape,
+                const std::shared_ptr<pmap_interface>& pmap, const Perm& perm,
+                const op_type& op)
+      : DistEvalImpl_(world, trange, shape, pmap, outer(perm)),
+        args_(args),
+        perms_(),
+        op_(op) {
+    TA_ASSERT(!args_.empty());
+    perms_.reserve(args_.size());
+    for (const auto& arg : args_) perms_.push_back(arg->perm());
+  }
+
+  virtual ~FusedEvalImpl() {}
+
+  /// Get tile at index \c i
+
+  /// \param i The index of the tile
+  /// \return A \c Future to the tile at index i
+  /// \throw TiledArray::Exception When tile \c i is owned by a remote node.
+  /// \throw TiledArray::Exception When tile \c i a zero tile.
+  virtual Future<value_type> get_tile(ordinal_type i) const {
+    TA_ASSERT(TensorImpl_::is_local(i));
+    TA_ASSERT(!TensorImpl_::is_zero(i));
+
+    const auto source_index = DistEvalImpl_::perm_index_to_source(i);
+    const ProcessID source = args_.front()->pmap()->owner(source_index);
+
+    const madness::DistributedID key(DistEvalImpl_::id(), i);
+    return TensorImpl_::world().gop.template recv<value_type>(source, key);
+  }
+
+  /// Discard a tile that is not needed
+
+  /// This function handles the cleanup for tiles that are not needed in
+  /// subsequent computation.
+  /// \param i The index of the tile
+  virtual void discard_tile(ordinal_type i) const { get_tile(i); }
+
+ private:
+  /// Evaluate the tiles of this tensor
+
+  /// This function will evaluate the arguments of this distributed evaluator
+  /// and evaluate the tiles for this distributed evaluator. It will block
+  /// until the tasks for the arguments are evaluated (not for the tasks of
+  /// this object).
+  /// \return The number of tiles that will be set by this process
+  virtual int internal_eval() {
+    // Evaluate the arguments
+    for (auto& arg : args_) arg->eval();
+
+    ordinal_type task_count = 0ul;
+
+    std::shared_ptr<FusedEvalImpl_> self = shared_from_this();
+    const auto& pmap = args_.front()->pmap();
+    for (const auto source_index : *pmap) {
+      const auto target_index =
+          DistEvalImpl_::perm_index_to_target(source_index);
+
+      if (!TensorImpl_::is_zero(target_index)) {
+        TensorImpl_::world().taskq.add(
+            new EvalTileTask(self, target_index, source_index));
+        ++task_count;
+      } else {
+        // Cleanup unused tiles
+        for (const auto& arg : args_)
+          if (!arg->is_zero(source_index)) arg->discard(source_index);
+      }
+    }
+
+    // Wait for the arguments to be evaluated, and process tasks while
+    // waiting.
+    for (const auto& arg : args_) arg->wait();
+
+    return task_count;
+  }
+
+};  // class FusedEvalImpl
+
+}  // namespace detail
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_DIST_EVAL_FUSED_EVAL_H__INCLUDED
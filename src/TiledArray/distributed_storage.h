@@ -21,6 +21,27 @@
 #define TILEDARRAY_DISTRIBUTED_STORAGE_H__INCLUDED
 
 #include <TiledArray/pmap/pmap.h>
+#include <TiledArray/tile_codec.h>
+#include <TiledArray/tile_interface/bytes.h>
+
+#include <madness/world/vector_archive.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace TiledArray {
 namespace detail {
@@ -35,6 +56,19 @@ namespace detail {
 /// is first accessed, though you may manually initialize an element with
 /// the \c insert() function. All elements are stored in \c Future ,
 /// which may be set only once.
+/// If the process map knows its local elements in advance (see
+/// Pmap::known_local_size() ), the local elements are stored in a dense
+/// array of local slots, i.e. without hashing; otherwise they are stored in
+/// a concurrent hash map. In both cases the future of an element is created
+/// when the element is first accessed, so that elements that are never
+/// accessed (e.g. zero tiles) cost no allocation.
+/// Remote elements may optionally be cached by each process (see
+/// enable_remote_cache() ), and local elements may optionally be spilled to
+/// a scratch file when they exceed a memory budget (see
+/// enable_out_of_core() ).
+/// Elements are sent to, and requested from, other processes as active
+/// messages; tensors of scalars may be compressed while in transit (see
+/// set_codec() ).
 /// \note This object is derived from \c WorldObject , which means
 /// the order of construction of object must be the same on all nodes. This
 /// can easily be achieved by only constructing world objects in the main
@@ -65,29 +99,727 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
   std::shared_ptr<pmap_interface>
       pmap_;  ///< The process map that defines the element distribution
   mutable container_type data_;     ///< The local data container
-  madness::AtomicInt num_live_ds_;  ///< Number of live DelayedSet objects
+
+  /// A local slot of the dense container
+
+  /// The future of the element is created on the first access of the slot.
+  struct DenseSlot : public madness::Spinlock {
+    future element = future::default_initializer();  ///< The element
+  };
+  mutable std::unique_ptr<DenseSlot[]> dense_data_;  ///< The local data, if
+                                                     ///< \c dense_
+  size_type dense_size_ = 0ul;  ///< The number of local slots
+  std::vector<size_type> dense_index_;  ///< The sorted local elements, i.e.
+                                        ///< the element of each slot; empty
+                                        ///< if the local elements are
+                                        ///< contiguous
+  size_type dense_first_ = 0ul;  ///< The first local element, if the local
+                                 ///< elements are contiguous
+  bool dense_ = false;  ///< \c true if the local data is stored in
+                        ///< \c dense_data_ , otherwise in \c data_
+  mutable madness::AtomicInt
+      num_live_ds_;  ///< Number of live DelayedSet, BatchReply, SpillTrack,
+                     ///< and PendingSet objects
+  mutable madness::AtomicInt
+      num_pending_sets_;  ///< Number of local elements that have been
+                          ///< assigned futures that are not yet set
+  mutable madness::Spinlock ready_lock_;  ///< Protects \c ready_waiters_
+  mutable std::vector<Future<bool>>
+      ready_waiters_;  ///< The futures returned by ready() while elements
+                       ///< were pending
+
+  /// Per-process cache of remote elements
+
+  /// Entries are evicted in least-recently-used order when the total size of
+  /// the cached elements exceeds \c max_bytes . Elements that are in transit
+  /// are cached as well, so that concurrent requests for the same element
+  /// share one message; until they arrive they are accounted for with the
+  /// average size of the elements that have arrived so far. The entries are
+  /// valid until the end of the next fence, see FenceEpoch .
+  struct RemoteCache : private madness::Spinlock {
+    struct Entry {
+      future element;       ///< The cached element
+      std::size_t bytes;    ///< The size of the element (estimated if in
+                            ///< transit)
+      std::uint64_t ticket;  ///< Identifies the request of the element
+      std::list<size_type>::iterator lru;  ///< The position in \c lru
+    };
+
+    std::size_t max_bytes;  ///< The maximum size of the cached elements
+    std::size_t bytes = 0ul;  ///< The size of the cached elements
+    std::uint64_t tickets = 0ul;  ///< The number of requested elements
+    std::size_t arrived_bytes = 0ul;  ///< The total size of the arrived
+                                      ///< elements
+    std::size_t arrived = 0ul;  ///< The number of arrived elements
+    std::uint64_t epoch = 0ul;  ///< The fence epoch of the cached elements
+    std::list<size_type> lru;   ///< Cached elements, most recently used first
+    std::unordered_map<size_type, Entry> entries;  ///< Cached elements
+
+    explicit RemoteCache(const std::size_t max_bytes) : max_bytes(max_bytes) {}
+
+    using madness::Spinlock::lock;
+    using madness::Spinlock::unlock;
+
+    /// \return The estimated size of an element that is in transit
+    std::size_t estimate() const {
+      return (arrived ? arrived_bytes / arrived : 0ul);
+    }
+
+    /// Evict least-recently-used elements until the cache fits its bound
+    void evict() {
+      while (bytes > max_bytes && !lru.empty()) {
+        auto it = entries.find(lru.back());
+        bytes -= it->second.bytes;
+        entries.erase(it);
+        lru.pop_back();
+      }
+    }
+
+    /// Drop element \c i , if it is cached
+    void erase(const size_type i) {
+      auto it = entries.find(i);
+      if (it == entries.end()) return;
+      bytes -= it->second.bytes;
+      lru.erase(it->second.lru);
+      entries.erase(it);
+    }
+
+    /// Drop all elements
+    void clear() {
+      entries.clear();
+      lru.clear();
+      bytes = 0ul;
+    }
+  };
+  std::unique_ptr<RemoteCache> cache_;  ///< The remote element cache, if
+                                        ///< enabled
+
+  /// The number of fences that have ended while the remote cache was in use
+
+  /// When the cache is used, a sentinel is registered for deferred cleanup,
+  /// which MADNESS performs at the end of every fence; its destruction starts
+  /// a new epoch, which drops the cached elements on their next access. The
+  /// epoch is shared with the sentinel, so it may outlive this object.
+  struct FenceEpoch {
+    std::atomic<std::uint64_t> value{0ul};  ///< The current epoch
+    std::atomic<bool> armed{false};  ///< \c true if a sentinel is registered
+  };
+
+  /// Starts a new fence epoch when it is destroyed
+  struct FenceSentinel {
+    std::shared_ptr<FenceEpoch> epoch;  ///< The fence epoch
+
+    explicit FenceSentinel(const std::shared_ptr<FenceEpoch>& epoch)
+        : epoch(epoch) {}
+
+    ~FenceSentinel() {
+      epoch->armed = false;
+      ++epoch->value;
+    }
+  };
+  std::shared_ptr<FenceEpoch> fence_epoch_ =
+      std::make_shared<FenceEpoch>();  ///< The fence epoch of the cache
+
+  /// Make sure that the end of the next fence starts a new fence epoch
+  void arm_fence_epoch() const {
+    if (fence_epoch_->armed.exchange(true)) return;
+    madness::detail::deferred_cleanup(
+        get_world(), std::make_shared<FenceSentinel>(fence_epoch_));
+  }
+
+  /// Drop the cached elements if a fence has ended since they were cached
+
+  /// Must be called with the lock of \c cache_ held.
+  void sync_remote_cache() const {
+    const std::uint64_t epoch = fence_epoch_->value;
+    if (cache_->epoch == epoch) return;
+    cache_->clear();
+    cache_->epoch = epoch;
+  }
+
+  /// Account for a remote element that has arrived in the cache
+
+  /// \param i The element that arrived
+  /// \param ticket The ticket of the request of element \c i
+  /// \param value The value of element \c i
+  void cache_handler(const size_type i, const std::uint64_t ticket,
+                     const value_type& value) const {
+    // The cache may have been disabled while the element was in transit
+    if (!cache_) return;
+    const std::size_t bytes = tile_bytes(value);
+    madness::ScopedMutex<RemoteCache> locker(cache_.get());
+    cache_->arrived_bytes += bytes;
+    ++cache_->arrived;
+    // The element may have been evicted or invalidated, and requested anew,
+    // while it was in transit
+    auto it = cache_->entries.find(i);
+    if (it == cache_->entries.end() || it->second.ticket != ticket) return;
+    cache_->bytes = cache_->bytes - it->second.bytes + bytes;
+    it->second.bytes = bytes;
+    cache_->evict();
+  }
+
+  /// Get a remote element through the cache
+
+  /// \param i The element to get
+  /// \return A future to element \c i
+  future get_cached(const size_type i) const {
+    arm_fence_epoch();
+    future result;
+    std::uint64_t ticket;
+    {
+      madness::ScopedMutex<RemoteCache> locker(cache_.get());
+      sync_remote_cache();
+      auto it = cache_->entries.find(i);
+      if (it != cache_->entries.end()) {
+        // Hit: mark the element as most recently used
+        cache_->lru.splice(cache_->lru.begin(), cache_->lru, it->second.lru);
+        return it->second.element;
+      }
+
+      // Miss: cache the future before the request is sent, so that
+      // concurrent requests share it, and reserve its estimated size
+      ticket = cache_->tickets++;
+      const std::size_t bytes = cache_->estimate();
+      cache_->lru.push_front(i);
+      cache_->entries.emplace(i, typename RemoteCache::Entry{
+                                     result, bytes, ticket,
+                                     cache_->lru.begin()});
+      cache_->bytes += bytes;
+      cache_->evict();
+    }
+
+    // Send a request to the owner of i for the element.
+    WorldObject_::task(owner(i), &DistributedStorage_::get_handler, i,
+                       result.remote_ref(get_world()),
+                       madness::TaskAttributes::hipri());
+    WorldObject_::task(get_world().rank(), &DistributedStorage_::cache_handler,
+                       i, ticket, result);
+    return result;
+  }
+
+  /// Out-of-core state of the local elements
+
+  /// The assigned local elements are tracked in least-recently-used order.
+  /// When their total size exceeds \c max_bytes , the least recently used
+  /// elements are selected for eviction; a separate task writes each of them
+  /// to a scratch file and then replaces its future in the container by a
+  /// pending one, unless the element has been used in the meantime. A
+  /// spilled element is read back asynchronously, into that pending future,
+  /// when it is accessed again. Since elements are assigned only once, an
+  /// element is written to the scratch file at most once.
+  struct Spill : private madness::Mutex {
+    struct Entry {
+      std::size_t bytes = 0ul;  ///< The size of the element, if resident
+      bool tracked = false;     ///< \c true if the element has been assigned
+      bool resident = true;     ///< \c false if the element is spilled
+      bool evicting = false;    ///< \c true if the element is being evicted
+      bool loading = false;     ///< \c true if the element is being read
+      bool in_lru = false;      ///< \c true if the element is in \c lru
+      std::list<size_type>::iterator lru;  ///< The position in \c lru , if
+                                           ///< \c in_lru
+      std::int64_t offset = -1;  ///< The position of the element in the
+                                 ///< scratch file; -1 if not written
+      std::int64_t size = 0;     ///< The size of the element in the scratch
+                                 ///< file
+    };
+
+    std::size_t max_bytes;  ///< The maximum size of the resident elements
+    std::size_t bytes = 0ul;  ///< The size of the resident elements
+    std::list<size_type> lru;  ///< Resident elements that may be evicted,
+                               ///< most recently used first
+    std::unordered_map<size_type, Entry> entries;  ///< Tracked elements
+    std::string dir;    ///< The scratch directory
+    std::string path;   ///< The scratch file
+    madness::Mutex io;  ///< Protects \c file and \c end
+    std::fstream file;  ///< The scratch file stream
+    std::int64_t end = 0;  ///< The size of the scratch file
+
+    Spill(const std::size_t max_bytes, const std::string& dir,
+          const void* owner)
+        : max_bytes(max_bytes), dir(dir) {
+      char name[64];
+      std::snprintf(name, sizeof(name), "/tiledarray.%ld.%p.spill",
+                    long(getpid()), owner);
+      path = dir + name;
+      file.open(path, std::ios::in | std::ios::out | std::ios::trunc |
+                          std::ios::binary);
+      if (!file)
+        TA_EXCEPTION("DistributedStorage: cannot open the scratch file");
+    }
+
+    ~Spill() {
+      file.close();
+      std::remove(path.c_str());
+    }
+
+    using madness::Mutex::lock;
+    using madness::Mutex::unlock;
+
+    /// Make element \c i the most recently used element
+
+    /// \param i A resident element
+    void push(const size_type i) {
+      Entry& entry = entries.at(i);
+      lru.push_front(i);
+      entry.lru = lru.begin();
+      entry.in_lru = true;
+    }
+
+    /// Select elements for eviction
+
+    /// The least recently used elements are selected until the resident
+    /// elements fit the bound; the most recently used element is always kept.
+    /// \return The selected elements
+    std::vector<size_type> select_victims() {
+      std::vector<size_type> victims;
+      while (bytes > max_bytes && lru.size() > 1ul) {
+        const size_type victim = lru.back();
+        lru.pop_back();
+        Entry& entry = entries.at(victim);
+        entry.in_lru = false;
+        entry.evicting = true;
+        bytes -= entry.bytes;
+        victims.push_back(victim);
+      }
+      return victims;
+    }
+
+    /// Keep element \c i resident, i.e. cancel its eviction, if any
+
+    /// \param entry The entry of element \c i
+    /// \param i The element
+    void keep(Entry& entry, const size_type i) {
+      if (!entry.evicting) return;
+      entry.evicting = false;
+      bytes += entry.bytes;
+      push(i);
+    }
+  };
+  std::unique_ptr<Spill> spill_;  ///< The out-of-core state, if enabled
+
+  TileCodec codec_;  ///< The codec of the elements sent to other processes
+
+  /// Get a remote element in encoded form
+
+  /// \param i The element to get
+  /// \return A future to element \c i
+  future get_encoded(const size_type i) const {
+    madness::Future<std::vector<unsigned char>> encoded =
+        WorldObject_::task(owner(i), &DistributedStorage_::encode_handler, i,
+                           codec_, madness::TaskAttributes::hipri());
+    return get_world().taskq.add(&decode_tile<value_type>, encoded,
+                                 madness::TaskAttributes::hipri());
+  }
+
+  madness::Future<std::vector<unsigned char>> encode_handler(
+      const size_type i, const TileCodec& codec) const {
+    return get_world().taskq.add(
+        [codec](const value_type& value) { return encode_tile(value, codec); },
+        find_local(i), madness::TaskAttributes::hipri());
+  }
+
+  void set_encoded_handler(const size_type i,
+                           const std::vector<unsigned char>& encoded) {
+    set_handler(i, decode_tile<value_type>(encoded));
+  }
+
+  /// \param i A local element
+  /// \return The future of element \c i , which is created if element \c i
+  /// has not been accessed yet; it is read under the lock of the element
+  future local_future(const size_type i) const {
+    if (dense_) {
+      DenseSlot& slot = dense_slot(i);
+      madness::ScopedMutex<madness::Spinlock> locker(&slot);
+      if (slot.element.is_default_initialized()) slot.element = future();
+      return slot.element;
+    }
+    const_accessor acc;
+    [[maybe_unused]] const bool inserted = data_.insert(acc, i);
+    return acc->second;
+  }
+
+  /// Replace the future of a local element by a pending future
+
+  /// The future is replaced under the lock of the element, i.e. the
+  /// holders of the old future keep it.
+  /// \param i A local element
+  void drop_local(const size_type i) const {
+    if (dense_) {
+      DenseSlot& slot = dense_slot(i);
+      madness::ScopedMutex<madness::Spinlock> locker(&slot);
+      slot.element = future();
+    } else {
+      accessor acc;
+      [[maybe_unused]] const bool inserted = data_.insert(acc, i);
+      acc->second = future();
+    }
+  }
+
+  /// Get a local element
+
+  /// The element is marked as used; if it is spilled, it is read back
+  /// asynchronously into the returned future.
+  /// \param i A local element
+  /// \return A copy of the future of element \c i
+  future find_local(const size_type i) const {
+    if (!spill_) return local_future(i);
+    bool load = false;
+    future result;
+    {
+      madness::ScopedMutex<Spill> locker(spill_.get());
+      load = spill_touch(i);
+      // the element is not evicted while the lock is held
+      result = local_future(i);
+    }
+    if (load)
+      WorldObject_::task(get_world().rank(), &DistributedStorage_::load_handler,
+                         i, madness::TaskAttributes::hipri());
+    return result;
+  }
+
+  /// Start the eviction of the selected elements
+
+  /// \param victims The elements selected for eviction
+  void spill_evict(const std::vector<size_type>& victims) const {
+    for (const auto victim : victims)
+      WorldObject_::task(get_world().rank(),
+                         &DistributedStorage_::evict_handler, victim);
+  }
+
+  /// Track an assigned local element, and evict elements if needed
+
+  /// Only the bookkeeping is done here; the elements are written to the
+  /// scratch file by separate tasks.
+  /// \param i The element
+  /// \param value The value of element \c i
+  void spill_track(const size_type i, const value_type& value) const {
+    const std::size_t bytes = tile_bytes(value);
+    std::vector<size_type> victims;
+    {
+      madness::ScopedMutex<Spill> locker(spill_.get());
+      auto& entry = spill_->entries[i];
+      if (entry.tracked) return;
+      entry.tracked = true;
+      entry.bytes = bytes;
+      spill_->bytes += bytes;
+      spill_->push(i);
+      victims = spill_->select_victims();
+    }
+    spill_evict(victims);
+  }
+
+  /// Write an element selected for eviction to the scratch file, and drop it
+
+  /// The element is dropped only if it has not been used since it was
+  /// selected.
+  /// \param i The element
+  void evict_handler(const size_type i) const {
+    future f;
+    bool write = false;
+    {
+      madness::ScopedMutex<Spill> locker(spill_.get());
+      auto& entry = spill_->entries.at(i);
+      if (!entry.evicting) return;  // used in the meantime
+      f = local_future(i);
+      // an element that is being read back is set outside of the lock
+      if (!f.probe()) {
+        spill_->keep(entry, i);
+        return;
+      }
+      write = entry.offset < 0;
+    }
+
+    std::int64_t offset = -1, size = 0;
+    if (write) {
+      std::vector<unsigned char> buffer;
+      madness::archive::VectorOutputArchive ar(buffer);
+      ar& f.get();
+      madness::ScopedMutex<madness::Mutex> locker(&spill_->io);
+      spill_->file.seekp(spill_->end);
+      spill_->file.write(reinterpret_cast<const char*>(buffer.data()),
+                         buffer.size());
+      if (!spill_->file)
+        TA_EXCEPTION("DistributedStorage: cannot write the scratch file");
+      offset = spill_->end;
+      size = buffer.size();
+      spill_->end += size;
+    }
+
+    madness::ScopedMutex<Spill> locker(spill_.get());
+    auto& entry = spill_->entries.at(i);
+    if (write) {
+      entry.offset = offset;
+      entry.size = size;
+    }
+    if (!entry.evicting) return;  // used in the meantime
+    entry.evicting = false;
+    entry.resident = false;
+    entry.bytes = 0ul;
+    drop_local(i);
+  }
+
+  /// Read a spilled element from the scratch file
+
+  /// \param offset The position of the element in the scratch file
+  /// \param size The size of the element in the scratch file
+  /// \return The element
+  value_type spill_read(const std::int64_t offset,
+                        const std::int64_t size) const {
+    std::vector<unsigned char> buffer(size);
+    {
+      madness::ScopedMutex<madness::Mutex> locker(&spill_->io);
+      spill_->file.seekg(offset);
+      spill_->file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+      if (!spill_->file)
+        TA_EXCEPTION("DistributedStorage: cannot read the scratch file");
+    }
+    madness::archive::VectorInputArchive ar(buffer);
+    value_type value;
+    ar& value;
+    return value;
+  }
+
+  /// Mark a local element as used
+
+  /// Must be called with the lock of \c spill_ held.
+  /// \param i The element
+  /// \return \c true if the element is spilled and must be read back, i.e.
+  /// the caller must start load_handler()
+  bool spill_touch(const size_type i) const {
+    auto it = spill_->entries.find(i);
+    if (it == spill_->entries.end()) return false;
+    auto& entry = it->second;
+    if (entry.in_lru) {
+      spill_->lru.splice(spill_->lru.begin(), spill_->lru, entry.lru);
+      return false;
+    }
+    spill_->keep(entry, i);
+    if (entry.resident || entry.loading) return false;
+    entry.loading = true;
+    return true;
+  }
+
+  /// Read a spilled element back into its (pending) future
+
+  /// \param i The element
+  void load_handler(const size_type i) const {
+    std::int64_t offset, size;
+    {
+      madness::ScopedMutex<Spill> locker(spill_.get());
+      const auto& entry = spill_->entries.at(i);
+      offset = entry.offset;
+      size = entry.size;
+    }
+    const value_type value = spill_read(offset, size);
+    const std::size_t bytes = tile_bytes(value);
+
+    future f;
+    std::vector<size_type> victims;
+    {
+      madness::ScopedMutex<Spill> locker(spill_.get());
+      auto& entry = spill_->entries.at(i);
+      entry.loading = false;
+      entry.resident = true;
+      entry.bytes = bytes;
+      spill_->bytes += bytes;
+      spill_->push(i);
+      // the future is not set yet, so the element is not evicted before it
+      // is set below
+      f = local_future(i);
+      victims = spill_->select_victims();
+    }
+    f.set(value);
+    spill_evict(victims);
+  }
+
+  /// Tracks a local element once it has been assigned
+  struct SpillTrack : public madness::CallbackInterface {
+   private:
+    DistributedStorage_& ds_;  ///< A reference to the owning object
+    size_type index_;          ///< The index of the element
+    future future_;            ///< The element
+
+   public:
+    SpillTrack(DistributedStorage_& ds, size_type i, const future& f)
+        : ds_(ds), index_(i), future_(f) {
+      ++ds_.num_live_ds_;
+    }
+
+    virtual ~SpillTrack() { --ds_.num_live_ds_; }
+
+    virtual void notify() {
+      if (ds_.spill_) ds_.spill_track(index_, future_.get());
+      delete this;
+    }
+  };  // struct SpillTrack
+  friend struct SpillTrack;
+
+  /// Counts down the pending sets once a local element has been assigned
+  struct PendingSet : public madness::CallbackInterface {
+   private:
+    DistributedStorage_& ds_;  ///< A reference to the owning object
+
+   public:
+    PendingSet(DistributedStorage_& ds) : ds_(ds) {
+      ++ds_.num_live_ds_;
+      ++ds_.num_pending_sets_;
+    }
+
+    virtual ~PendingSet() { --ds_.num_live_ds_; }
+
+    virtual void notify() {
+      if (ds_.num_pending_sets_.dec_and_test()) ds_.notify_ready();
+      delete this;
+    }
+  };  // struct PendingSet
+  friend struct PendingSet;
+
+  /// Set the futures returned by ready() once no sets are pending
+  void notify_ready() const {
+    std::vector<Future<bool>> waiters;
+    {
+      madness::ScopedMutex<madness::Spinlock> locker(&ready_lock_);
+      waiters.swap(ready_waiters_);
+    }
+    for (auto& waiter : waiters) waiter.set(true);
+  }
 
   // not allowed
   DistributedStorage(const DistributedStorage_&);
   DistributedStorage_& operator=(const DistributedStorage_&);
 
+  /// Initialize the local data container for the current process map
+
+  /// If the process map knows its local elements, the dense container is
+  /// used. Its size is proportional to the number of local elements: the
+  /// slot of a local element is found by offset if the local elements are
+  /// contiguous (e.g. for BlockedPmap), otherwise by binary search in the
+  /// sorted list of local elements.
+  void init_local_data() {
+    dense_data_.reset();
+    dense_size_ = 0ul;
+    dense_index_.clear();
+    dense_first_ = 0ul;
+    dense_ = pmap_->known_local_size();
+    if (!dense_) return;
+
+    std::vector<size_type> local(pmap_->begin(), pmap_->end());
+    if (local.empty()) return;
+    std::sort(local.begin(), local.end());
+    dense_size_ = local.size();
+    dense_data_.reset(new DenseSlot[dense_size_]);
+    if (local.back() - local.front() + 1ul == local.size())
+      dense_first_ = local.front();
+    else
+      dense_index_ = std::move(local);
+  }
+
+  /// \param i A local element
+  /// \return The slot of element \c i in \c dense_data_
+  DenseSlot& dense_slot(const size_type i) const {
+    TA_ASSERT(dense_);
+    if (dense_index_.empty()) {
+      TA_ASSERT(i >= dense_first_ && i - dense_first_ < dense_size_);
+      return dense_data_[i - dense_first_];
+    }
+    const auto it =
+        std::lower_bound(dense_index_.begin(), dense_index_.end(), i);
+    TA_ASSERT(it != dense_index_.end() && *it == i);
+    return dense_data_[it - dense_index_.begin()];
+  }
+
+  /// \param i A local element
+  /// \return The future of element \c i , or a default-initialized future if
+  /// element \c i has not been accessed yet
+  future dense_find(const size_type i) const {
+    DenseSlot& slot = dense_slot(i);
+    madness::ScopedMutex<madness::Spinlock> locker(&slot);
+    return slot.element;
+  }
+
   void set_handler(const size_type i, const value_type& value) {
-    future& f = get_local(i);
+    future f = local_future(i);
 
     // Check that the future has not been set already.
     TA_ASSERT(!f.probe() && "Tile has already been assigned.");
 
     f.set(value);
+    if (spill_) spill_track(i, value);
   }
 
   void get_handler(const size_type i,
                    const typename future::remote_refT& ref) const {
-    const future& f = get_local(i);
+    const future f = find_local(i);
     future remote_f(ref);
     remote_f.set(f);
   }
 
+  void get_batch_handler(
+      const ProcessID requester, const std::vector<size_type>& indices,
+      const std::vector<typename future::remote_refT>& refs,
+      const TileCodec& codec) const {
+    TA_ASSERT(indices.size() == refs.size());
+    std::vector<future> elements;
+    elements.reserve(indices.size());
+    for (const auto i : indices) elements.push_back(find_local(i));
+    new BatchReply(*this, requester, std::move(elements), refs, codec);
+  }
+
+  void get_batch_reply_handler(
+      const std::vector<typename future::remote_refT>& refs,
+      const std::vector<value_type>& values) const {
+    TA_ASSERT(refs.size() == values.size());
+    for (std::size_t j = 0ul; j < refs.size(); ++j) {
+      future f(refs[j]);
+      f.set(values[j]);
+    }
+  }
+
+  void get_encoded_batch_reply_handler(
+      const std::vector<typename future::remote_refT>& refs,
+      const std::vector<std::vector<unsigned char>>& encoded) const {
+    TA_ASSERT(refs.size() == encoded.size());
+    for (std::size_t j = 0ul; j < refs.size(); ++j) {
+      future f(refs[j]);
+      f.set(decode_tile<value_type>(encoded[j]));
+    }
+  }
+
+  void set_batch_handler(const std::vector<size_type>& indices,
+                         const std::vector<value_type>& values) {
+    TA_ASSERT(indices.size() == values.size());
+    for (std::size_t j = 0ul; j < indices.size(); ++j)
+      set_handler(indices[j], values[j]);
+  }
+
+  void set_encoded_batch_handler(
+      const std::vector<size_type>& indices,
+      const std::vector<std::vector<unsigned char>>& encoded) {
+    TA_ASSERT(indices.size() == encoded.size());
+    for (std::size_t j = 0ul; j < indices.size(); ++j)
+      set_handler(indices[j], decode_tile<value_type>(encoded[j]));
+  }
+
+  bool move_handler(const size_type i, const value_type& value) {
+    set_handler(i, value);
+    return true;
+  }
+
   void set_remote(const size_type i, const value_type& value) {
+    // A cached copy of the element would be stale
+    if (cache_) {
+      madness::ScopedMutex<RemoteCache> locker(cache_.get());
+      cache_->erase(i);
+    }
+    if constexpr (is_contiguous_trivially_copyable_tile_v<value_type>) {
+      if (codec_ && !value.empty()) {
+        WorldObject_::task(owner(i), &DistributedStorage_::set_encoded_handler,
+                           i, encode_tile(value, codec_),
+                           madness::TaskAttributes::hipri());
+        return;
+      }
+    }
     WorldObject_::task(owner(i), &DistributedStorage_::set_handler, i, value,
                        madness::TaskAttributes::hipri());
   }
@@ -113,6 +845,66 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
   };  // struct DelayedSet
   friend struct DelayedSet;
 
+  /// Replies to a batched get request once all elements are available
+
+  /// The elements are sent back to the requester in a single message; they
+  /// are encoded with the codec of the requester, if it has one.
+  struct BatchReply : public madness::CallbackInterface {
+   private:
+    const DistributedStorage_& ds_;  ///< A reference to the owning object
+    ProcessID requester_;            ///< The process that requested the batch
+    std::vector<future> elements_;   ///< The requested elements
+    std::vector<typename future::remote_refT>
+        refs_;                  ///< The futures of the requester
+    TileCodec codec_;           ///< The codec of the requester
+    madness::AtomicInt count_;  ///< The number of pending notifications
+
+   public:
+    BatchReply(const DistributedStorage_& ds, const ProcessID requester,
+               std::vector<future>&& elements,
+               const std::vector<typename future::remote_refT>& refs,
+               const TileCodec& codec)
+        : ds_(ds),
+          requester_(requester),
+          elements_(std::move(elements)),
+          refs_(refs),
+          codec_(codec) {
+      ++ds_.num_live_ds_;
+      count_ = static_cast<int>(elements_.size()) + 1;
+      for (auto& f : elements_) f.register_callback(this);
+      notify();
+    }
+
+    virtual ~BatchReply() { --ds_.num_live_ds_; }
+
+    virtual void notify() {
+      if (count_.dec_and_test()) {
+        if constexpr (is_contiguous_trivially_copyable_tile_v<value_type>) {
+          if (codec_) {
+            std::vector<std::vector<unsigned char>> encoded;
+            encoded.reserve(elements_.size());
+            for (const auto& f : elements_)
+              encoded.push_back(encode_tile(f.get(), codec_));
+            ds_.WorldObject_::task(
+                requester_,
+                &DistributedStorage_::get_encoded_batch_reply_handler, refs_,
+                encoded, madness::TaskAttributes::hipri());
+            delete this;
+            return;
+          }
+        }
+        std::vector<value_type> values;
+        values.reserve(elements_.size());
+        for (const auto& f : elements_) values.push_back(f.get());
+        ds_.WorldObject_::task(requester_,
+                               &DistributedStorage_::get_batch_reply_handler,
+                               refs_, values, madness::TaskAttributes::hipri());
+        delete this;
+      }
+    }
+  };  // struct BatchReply
+  friend struct BatchReply;
+
  public:
   /// Makes an initialized, empty container with default data distribution (no
   /// communication)
@@ -135,7 +927,9 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
     TA_ASSERT(pmap_->size() == max_size);
     TA_ASSERT(pmap_->rank() == pmap_interface::size_type(world.rank()));
     TA_ASSERT(pmap_->procs() == pmap_interface::size_type(world.size()));
+    init_local_data();
     num_live_ds_ = 0;
+    num_pending_sets_ = 0;
     WorldObject_::process_pending();
   }
 
@@ -181,9 +975,99 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
   /// Number of local elements
 
   /// No communication.
-  /// \return The number of local elements stored by the container.
+  /// \return The number of local elements stored by the container, i.e.
+  /// the local elements that have been accessed or assigned
   /// \throw nothing
-  size_type size() const { return data_.size(); }
+  size_type size() const {
+    if (dense_) {
+      size_type result = 0ul;
+      for (size_type slot = 0ul; slot < dense_size_; ++slot) {
+        madness::ScopedMutex<madness::Spinlock> locker(&dense_data_[slot]);
+        if (!dense_data_[slot].element.is_default_initialized()) ++result;
+      }
+      return result;
+    }
+    return data_.size();
+  }
+
+  /// Size of the local elements
+
+  /// No communication.
+  /// \return The total size of the local elements that have been assigned
+  /// and are resident in memory, in bytes (see tile_bytes() ); elements that
+  /// share data with other objects are counted in full
+  std::size_t local_bytes() const {
+    std::size_t result = 0ul;
+    for (const auto i : *pmap_) {
+      if (dense_) {
+        const future f = dense_find(i);
+        if (!f.is_default_initialized() && f.probe())
+          result += tile_bytes(f.get());
+      } else {
+        const_accessor acc;
+        if (data_.find(acc, i) && acc->second.probe())
+          result += tile_bytes(acc->second.get());
+      }
+    }
+    return result;
+  }
+
+  /// Number of pending local sets
+
+  /// No communication.
+  /// \return The number of local elements that have been assigned futures,
+  /// e.g. by DistArray::init_tiles() or by an expression, that are not yet
+  /// set
+  size_type pending_sets() const { return num_pending_sets_; }
+
+  /// Futures of the pending local elements
+
+  /// No communication. Elements are neither created nor read back from the
+  /// scratch file (see enable_out_of_core() ).
+  /// \return The futures of the local elements that exist, i.e. that have
+  /// been assigned or accessed, and are not yet set; spilled elements have
+  /// been set, hence they are not included
+  std::vector<future> pending_local() const {
+    std::vector<future> result;
+    auto collect = [this, &result]() {
+      for (const auto i : *pmap_) {
+        if (spill_) {
+          const auto it = spill_->entries.find(i);
+          if (it != spill_->entries.end() && !it->second.resident) continue;
+        }
+        future f = future::default_initializer();
+        if (dense_) {
+          f = dense_find(i);
+        } else {
+          const_accessor acc;
+          if (data_.find(acc, i)) f = acc->second;
+        }
+        if (!f.is_default_initialized() && !f.probe())
+          result.push_back(std::move(f));
+      }
+    };
+    if (spill_) {
+      madness::ScopedMutex<Spill> locker(spill_.get());
+      collect();
+    } else {
+      collect();
+    }
+    return result;
+  }
+
+  /// Local completion future
+
+  /// No communication. Elements that are assigned by other processes are
+  /// counted only once they arrive, i.e. use a barrier to know that they
+  /// have been sent.
+  /// \return A future that is set to \c true once no local element has been
+  /// assigned a future that is not yet set, see pending_sets()
+  Future<bool> ready() const {
+    madness::ScopedMutex<madness::Spinlock> locker(&ready_lock_);
+    if (num_pending_sets_ == 0) return Future<bool>(true);
+    ready_waiters_.emplace_back();
+    return ready_waiters_.back();
+  }
 
   /// Max size accessor
 
@@ -202,8 +1086,14 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
   future get(size_type i) const {
     TA_ASSERT(i < max_size_);
     if (is_local(i)) {
-      return get_local(i);
+      return find_local(i);
+    } else if (cache_) {
+      return get_cached(i);
     } else {
+      if constexpr (is_contiguous_trivially_copyable_tile_v<value_type>) {
+        if (codec_) return get_encoded(i);
+      }
+
       // Send a request to the owner of i for the element.
       future result;
       WorldObject_::task(owner(i), &DistributedStorage_::get_handler, i,
@@ -214,34 +1104,55 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
     }
   }
 
-  /// Get local element
+  /// Get a batch of local or remote elements
 
-  /// \param i The element to get
-  /// \return A const reference to element \p i
-  /// \throw TiledArray::Exception If \p i is greater than or equal to
-  /// max_size() or \p i is not local.
-  const future& get_local(const size_type i) const {
-    TA_ASSERT(pmap_->is_local(i));
+  /// The requests for remote elements are grouped by owner, and each group
+  /// is sent, and answered, as a single message.
+  /// \param indices The elements to get
+  /// \return Futures to the elements, in the order of \c indices
+  /// \throw TiledArray::Exception If an index is greater than or equal to
+  /// \c max_size() .
+  std::vector<future> get(const std::vector<size_type>& indices) const {
+    std::vector<future> result(indices.size());
+    std::map<ProcessID,
+             std::pair<std::vector<size_type>,
+                       std::vector<typename future::remote_refT>>>
+        requests;
+    for (std::size_t j = 0ul; j < indices.size(); ++j) {
+      const size_type i = indices[j];
+      TA_ASSERT(i < max_size_);
+      if (is_local(i)) {
+        result[j] = find_local(i);
+      } else {
+        auto& request = requests[owner(i)];
+        request.first.push_back(i);
+        request.second.push_back(result[j].remote_ref(get_world()));
+      }
+    }
 
-    // Return the local element.
-    const_accessor acc;
-    [[maybe_unused]] const bool inserted = data_.insert(acc, i);
-    return acc->second;
+    const ProcessID me = get_world().rank();
+    for (const auto& [dest, request] : requests)
+      WorldObject_::task(dest, &DistributedStorage_::get_batch_handler, me,
+                         request.first, request.second, codec_,
+                         madness::TaskAttributes::hipri());
+
+    return result;
   }
 
   /// Get local element
 
+  /// The future is returned by value: the future stored in the container may
+  /// be replaced concurrently, e.g. when element \p i is spilled (see
+  /// enable_out_of_core() ), while the returned copy keeps the element. If
+  /// element \p i is spilled, it is read back asynchronously into the
+  /// returned future.
   /// \param i The element to get
-  /// \return A reference to element \p i
+  /// \return A future to element \p i
   /// \throw TiledArray::Exception If \p i is greater than or equal to
   /// max_size() or \p i is not local.
-  future& get_local(const size_type i) {
+  future get_local(const size_type i) const {
     TA_ASSERT(pmap_->is_local(i));
-
-    // Return the local element.
-    accessor acc;
-    [[maybe_unused]] const bool inserted = data_.insert(acc, i);
-    return acc->second;
+    return find_local(i);
   }
 
   /// Set element \c i with \c value
@@ -259,6 +1170,49 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
       set_remote(i, value);
   }
 
+  /// Set a batch of elements
+
+  /// The remote elements are grouped by owner, and each group is sent as a
+  /// single message.
+  /// \param elements The (index, value) pairs of the elements to be set
+  /// \throw TiledArray::Exception If an index is greater than or equal to
+  /// \c max_size() .
+  /// \throw madness::MadnessException If an element has already been set.
+  void set(const std::vector<std::pair<size_type, value_type>>& elements) {
+    std::map<ProcessID,
+             std::pair<std::vector<size_type>, std::vector<value_type>>>
+        batches;
+    for (const auto& [i, value] : elements) {
+      TA_ASSERT(i < max_size_);
+      if (is_local(i)) {
+        set_handler(i, value);
+      } else {
+        auto& batch = batches[owner(i)];
+        batch.first.push_back(i);
+        batch.second.push_back(value);
+      }
+    }
+
+    for (const auto& [dest, batch] : batches) {
+      if constexpr (is_contiguous_trivially_copyable_tile_v<value_type>) {
+        if (codec_) {
+          std::vector<std::vector<unsigned char>> encoded;
+          encoded.reserve(batch.second.size());
+          for (const auto& value : batch.second)
+            encoded.push_back(encode_tile(value, codec_));
+          WorldObject_::task(dest,
+                             &DistributedStorage_::set_encoded_batch_handler,
+                             batch.first, encoded,
+                             madness::TaskAttributes::hipri());
+          continue;
+        }
+      }
+      WorldObject_::task(dest, &DistributedStorage_::set_batch_handler,
+                         batch.first, batch.second,
+                         madness::TaskAttributes::hipri());
+    }
+  }
+
   /// Set element \c i with a \c Future \c f
 
   /// The owner of \c i may be local or remote. If \c i is remote, a task
@@ -272,16 +1226,35 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
   void set(size_type i, const future& f) {
     TA_ASSERT(i < max_size_);
     if (is_local(i)) {
-      const_accessor acc;
-      if (!data_.insert(acc, typename container_type::datumT(i, f))) {
-        // The element was already in the container, so set it with f.
-        future existing_f = acc->second;
-        acc.release();
-
-        // Check that the future has not been set already.
+      if (dense_) {
+        future existing_f = local_future(i);
         TA_ASSERT(!existing_f.probe() && "Tile has already been assigned.");
-        // Set the future
         existing_f.set(f);
+      } else {
+        const_accessor acc;
+        if (data_.insert(acc, typename container_type::datumT(i, f))) {
+          // The element lock is not held while the element is tracked below
+          acc.release();
+        } else {
+          // The element was already in the container, so set it with f.
+          future existing_f = acc->second;
+          acc.release();
+
+          // Check that the future has not been set already.
+          TA_ASSERT(!existing_f.probe() && "Tile has already been assigned.");
+          // Set the future
+          existing_f.set(f);
+        }
+      }
+
+      if (!f.probe())
+        const_cast<future&>(f).register_callback(new PendingSet(*this));
+      if (spill_) {
+        if (f.probe())
+          spill_track(i, f.get());
+        else
+          const_cast<future&>(f).register_callback(
+              new SpillTrack(*this, i, f));
       }
     } else {
       if (f.probe()) {
@@ -293,6 +1266,271 @@ class DistributedStorage : public madness::WorldObject<DistributedStorage<T> > {
     }
   }
 
+  /// Set the codec of the elements that are sent to other processes
+
+  /// Once set, the elements that this process sends to remote owners with
+  /// set() , and the remote elements that it requests with get() , are
+  /// encoded with \c codec (see TileCodec ) while in transit; this includes
+  /// the batched forms of set() and get() . Only elements that satisfy
+  /// is_contiguous_trivially_copyable_tile are encoded, and requests served
+  /// by the remote cache are not sent at all.
+  /// \note Only the transfers of this container are encoded. Tiles that are
+  /// sent by other means, notably the broadcasts of the SUMMA contraction
+  /// algorithm, which use the MADNESS group broadcast, are not encoded.
+  /// \param codec The codec; TileCodec::Kind::none disables encoding
+  /// \note This is a local operation, i.e. the codec may be set on some
+  /// processes only. Must not be called while other threads access this
+  /// container, e.g. call it after a fence.
+  void set_codec(const TileCodec& codec) { codec_ = codec; }
+
+  /// \return The codec of the elements that are sent to other processes
+  const TileCodec& codec() const { return codec_; }
+
+  /// Enable the cache of remote elements
+
+  /// Once enabled, get() serves repeated requests for the same remote
+  /// element from a per-process cache, and concurrent requests for an element
+  /// that is in transit share a single message. Assigning a remote element
+  /// drops it from the local cache. The cached elements are valid until the
+  /// end of the next fence (<tt>world.gop.fence()</tt> ), i.e. they are
+  /// dropped once a fence has ended. Cached elements become stale if their
+  /// owner modifies them in place between fences; in that case, call
+  /// invalidate_remote_cache() on every process that may have cached them.
+  /// DistArray does so at the collective operations that modify tiles in
+  /// place (e.g. foreach_inplace and truncate) and in wait_ready().
+  /// \param max_bytes The maximum size of the cached elements, in bytes
+  /// \note This is a local operation, i.e. the cache may be enabled on some
+  /// processes only.
+  void enable_remote_cache(const std::size_t max_bytes) {
+    if (cache_) {
+      madness::ScopedMutex<RemoteCache> locker(cache_.get());
+      cache_->max_bytes = max_bytes;
+      cache_->evict();
+    } else {
+      cache_ = std::make_unique<RemoteCache>(max_bytes);
+    }
+  }
+
+  /// Disable the cache of remote elements, and drop the cached elements
+
+  /// \note Must not be called while other threads access this container,
+  /// e.g. call it after a fence.
+  void disable_remote_cache() { cache_.reset(); }
+
+  /// Drop the cached remote elements
+
+  /// Elements that are in transit are not cached when they arrive.
+  void invalidate_remote_cache() {
+    if (cache_) {
+      madness::ScopedMutex<RemoteCache> locker(cache_.get());
+      cache_->clear();
+    }
+  }
+
+  /// \return The maximum size of the cached remote elements, in bytes, or
+  /// 0 if the cache is disabled
+  std::size_t remote_cache_max_bytes() const {
+    if (!cache_) return 0ul;
+    madness::ScopedMutex<RemoteCache> locker(cache_.get());
+    return cache_->max_bytes;
+  }
+
+  /// \return The total size of the cached remote elements, in bytes
+  std::size_t remote_cache_bytes() const {
+    if (!cache_) return 0ul;
+    madness::ScopedMutex<RemoteCache> locker(cache_.get());
+    sync_remote_cache();
+    return cache_->bytes;
+  }
+
+  /// Enable spilling of the local elements to a scratch file
+
+  /// Once enabled, the assigned local elements are tracked in
+  /// least-recently-used order, and when their total size exceeds
+  /// \c max_bytes the least recently used elements are written to a scratch
+  /// file, by separate tasks, and dropped from memory. A spilled element is
+  /// read back asynchronously by get() , i.e. the returned future is
+  /// assigned once the element has been read; requesting elements ahead of
+  /// their use therefore overlaps the reads with computation. The futures
+  /// of spilled elements that are held elsewhere are not affected, i.e. they
+  /// keep their elements in memory until they are released. Each element is
+  /// written at most once, since elements can be assigned only once.
+  /// \param max_bytes The maximum size of the resident local elements, in
+  /// bytes; the most recently used element is always resident
+  /// \param dir The scratch directory; if empty, the directory given by the
+  /// \c TA_SCRATCH_DIR environment variable, or \c /tmp , is used
+  /// \throw TiledArray::Exception if the scratch file cannot be created
+  /// \warning Elements must not be modified in place while spilling is
+  /// enabled, since the modifications of spilled elements are lost.
+  /// \note This is a local operation. Must not be called while other threads
+  /// access this container, e.g. call it after a fence.
+  void enable_out_of_core(const std::size_t max_bytes,
+                          std::string dir = std::string()) {
+    if (spill_) {
+      std::vector<size_type> victims;
+      {
+        madness::ScopedMutex<Spill> locker(spill_.get());
+        spill_->max_bytes = max_bytes;
+        victims = spill_->select_victims();
+      }
+      spill_evict(victims);
+    } else {
+      if (dir.empty()) {
+        const char* scratch_dir = std::getenv("TA_SCRATCH_DIR");
+        dir = scratch_dir ? scratch_dir : "/tmp";
+      }
+      spill_ = std::make_unique<Spill>(max_bytes, dir, this);
+    }
+
+    // Track the local elements that have been assigned, which spills the
+    // elements that exceed the budget
+    for (const auto i : *pmap_) {
+      {
+        madness::ScopedMutex<Spill> locker(spill_.get());
+        const auto it = spill_->entries.find(i);
+        if (it != spill_->entries.end() && it->second.tracked) continue;
+      }
+      if (dense_) {
+        const future f = dense_find(i);
+        if (!f.is_default_initialized() && f.probe()) spill_track(i, f.get());
+      } else {
+        const_accessor acc;
+        if (!data_.find(acc, i) || !acc->second.probe()) continue;
+        const future f = acc->second;
+        acc.release();
+        spill_track(i, f.get());
+      }
+    }
+  }
+
+  /// Disable spilling, read the spilled local elements back, and remove the
+  /// scratch file
+
+  /// \note Must not be called while other threads access this container,
+  /// e.g. call it after a fence.
+  void disable_out_of_core() {
+    if (!spill_) return;
+    for (const auto& [i, entry] : spill_->entries) {
+      if (entry.resident) continue;
+      future f = local_future(i);
+      if (!f.probe()) f.set(spill_read(entry.offset, entry.size));
+    }
+    spill_.reset();
+  }
+
+  /// \return The total size of the resident local elements tracked since
+  /// spilling was enabled, in bytes; 0 if spilling is disabled
+  std::size_t resident_bytes() const {
+    if (!spill_) return 0ul;
+    madness::ScopedMutex<Spill> locker(spill_.get());
+    return spill_->bytes;
+  }
+
+  /// Move the elements to the owners defined by a new process map
+
+  /// Elements that remain local are kept as they are, i.e. they are not
+  /// copied. The other local elements are sent to their new owners and
+  /// removed from this container, with at most \c max_in_flight elements
+  /// sent but not yet stored by the receiver at any time, which bounds the
+  /// memory used by the send buffers. Local elements that have not been
+  /// assigned are dropped. If the old process map is replicated, every
+  /// process already holds every element, i.e. the elements that are not
+  /// local any more are dropped and none is sent. If the new process map is
+  /// replicated, each element is sent to every other process.
+  /// \param pmap The new process map
+  /// \param max_in_flight The maximum number of elements in transit from
+  /// this process
+  /// \note This is a collective operation. The elements must not be accessed
+  /// by any process until all processes have returned from this function and
+  /// have been synchronized with a fence.
+  void redistribute(const std::shared_ptr<pmap_interface>& pmap,
+                    const size_type max_in_flight) {
+    TA_ASSERT(pmap);
+    TA_ASSERT(pmap->size() == max_size_);
+    TA_ASSERT(pmap->rank() == pmap_->rank());
+    TA_ASSERT(pmap->procs() == pmap_->procs());
+    TA_ASSERT(max_in_flight > 0ul);
+
+    // Spilled elements are read back before they are moved; spilling is
+    // enabled again once all elements have arrived
+    std::size_t spill_max_bytes = 0ul;
+    std::string spill_dir;
+    if (spill_) {
+      spill_max_bytes = spill_->max_bytes;
+      spill_dir = spill_->dir;
+      disable_out_of_core();
+    }
+
+    // Collect the assigned local elements and reset the local container
+    std::vector<std::pair<size_type, future>> elements;
+    for (const auto i : *pmap_) {
+      if (dense_) {
+        const future f = dense_find(i);
+        if (!f.is_default_initialized() && f.probe())
+          elements.emplace_back(i, f);
+      } else {
+        accessor acc;
+        if (!data_.find(acc, i)) continue;  // e.g. a zero tile
+        if (acc->second.probe()) elements.emplace_back(i, acc->second);
+        data_.erase(acc);
+      }
+    }
+    const bool was_replicated = pmap_->is_replicated();
+    pmap_ = pmap;
+    init_local_data();
+    invalidate_remote_cache();
+
+    // Keep the elements that remain local
+    auto moved = std::partition(
+        elements.begin(), elements.end(),
+        [this](const auto& element) { return is_local(element.first); });
+    for (auto it = elements.begin(); it != moved; ++it) {
+      if (dense_)
+        dense_slot(it->first).element = it->second;
+      else
+        data_.insert(typename container_type::datumT(it->first, it->second));
+    }
+
+    // The new owners of the other elements already hold a copy of them
+    if (was_replicated) elements.erase(moved, elements.end());
+
+    // The receivers must have reset their local containers before elements
+    // are sent to them
+    get_world().gop.barrier();
+
+    std::deque<Future<bool>> in_flight;
+    auto send = [&](const ProcessID dest, const size_type i,
+                    const future& f) {
+      if (in_flight.size() >= max_in_flight) {
+        in_flight.front().get();
+        in_flight.pop_front();
+      }
+      in_flight.push_back(
+          WorldObject_::task(dest, &DistributedStorage_::move_handler, i, f,
+                             madness::TaskAttributes::hipri()));
+    };
+
+    if (pmap_->is_replicated() && !was_replicated) {
+      // Every process receives a copy of each element from its old owner
+      const ProcessID me = get_world().rank();
+      const ProcessID nproc = get_world().size();
+      for (auto it = elements.begin(); it != moved; ++it)
+        for (ProcessID p = 1; p < nproc; ++p)
+          send((me + p) % nproc, it->first, it->second);
+    } else {
+      for (auto it = moved; it != elements.end(); ++it) {
+        send(owner(it->first), it->first, it->second);
+        it->second = future();  // release the element
+      }
+    }
+
+    for (auto& f : in_flight) f.get();
+
+    // All elements have been stored by their receivers after the barrier
+    get_world().gop.barrier();
+    if (!spill_dir.empty()) enable_out_of_core(spill_max_bytes, spill_dir);
+  }
+
 };  // class DistributedStorage
 
 }  // namespace detail
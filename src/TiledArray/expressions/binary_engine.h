@@ -28,6 +28,7 @@
 
 #include <TiledArray/dist_eval/binary_eval.h>
 #include <TiledArray/expressions/expr_engine.h>
+#include <TiledArray/expressions/fused_engine.h>
 #include <TiledArray/expressions/permopt.h>
 
 namespace TiledArray {
@@ -73,6 +74,14 @@ class BinaryEngine : public ExprEngine<Derived> {
   static constexpr bool consumable = EngineTrait<Derived>::consumable;
   static constexpr unsigned int leaves = EngineTrait<Derived>::leaves;
 
+  /// \c true if this expression may be evaluated by a fused kernel, see
+  /// is_fusable_engine
+  static constexpr bool fused_eval_supported =
+      is_fused_eval_tile_v<value_type> &&
+      std::is_same_v<typename EngineTrait<Derived>::eval_type, value_type> &&
+      std::is_same_v<typename EngineTrait<left_type>::eval_type, value_type> &&
+      std::is_same_v<typename EngineTrait<right_type>::eval_type, value_type>;
+
  protected:
   // Import base class variables to this scope
   using ExprEngine_::indices_;
@@ -278,10 +287,63 @@ class BinaryEngine : public ExprEngine<Derived> {
     return perm * left_.trange();
   }
 
+  /// Element-wise expression query
+
+  /// Derived classes that are not element-wise for all arguments (i.e.
+  /// contractions) must override this function.
+  /// \return \c true if element \c i of the result depends only on elements
+  /// \c i of the arguments
+  bool is_elementwise() const { return true; }
+
+  /// Fusion query
+
+  /// \return \c true if this expression can be inlined into the fused kernel
+  /// of its parent expression
+  bool fusable() const { return !perm_ && this->derived().is_elementwise(); }
+
+  /// Construct the block operation of the fused kernel of this expression
+
+  /// The arguments of the fused kernel are appended to \c args in the order
+  /// expected by the returned block operation.
+  /// \param args The arguments of the fused kernel
+  /// \return The block operation of this expression
+  auto make_fused_op(
+      TiledArray::detail::FusedEvalArgs<value_type, policy>& args) const {
+    const std::size_t first = args.size();
+    auto left = make_fused_node<value_type, policy>(left_, args);
+    const std::size_t left_arity = args.size() - first;
+    auto right = make_fused_node<value_type, policy>(right_, args);
+    auto op = this->derived().make_fused_element_op();
+    return TiledArray::detail::FusedBinaryOp<decltype(left), decltype(right),
+                                             decltype(op)>(left, right,
+                                                           left_arity, op);
+  }
+
+  /// Fused evaluation query
+
+  /// A fused kernel is only used if it saves at least one intermediate
+  /// tile, i.e. if this element-wise expression inlines at least one of its
+  /// arguments.
+  /// \return \c true if this expression is evaluated by a fused kernel
+  bool is_fused_eval() const {
+    if constexpr (fused_eval_supported)
+      return this->derived().is_elementwise() &&
+             (is_fused(left_) || is_fused(right_));
+    else
+      return false;
+  }
+
   /// Construct the distributed evaluator for this expression
 
+  /// Element-wise subexpressions that can be inlined are evaluated by a
+  /// single fused kernel, instead of by a distributed evaluator per
+  /// expression.
   /// \return The distributed evaluator that will evaluate this expression
   dist_eval_type make_dist_eval() const {
+    if constexpr (fused_eval_supported) {
+      if (is_fused_eval()) return make_fused_dist_eval();
+    }
+
     typedef TiledArray::detail::BinaryEvalImpl<
         typename left_type::dist_eval_type, typename right_type::dist_eval_type,
         op_type, policy>
@@ -299,6 +361,25 @@ class BinaryEngine : public ExprEngine<Derived> {
     return dist_eval_type(pimpl);
   }
 
+  /// Construct the fused distributed evaluator for this expression
+
+  /// \return The distributed evaluator that will evaluate this expression
+  dist_eval_type make_fused_dist_eval() const {
+    TiledArray::detail::FusedEvalArgs<value_type, policy> args;
+    auto op = make_fused_op(args);
+    typedef TiledArray::detail::FusedEvalImpl<value_type, policy, decltype(op)>
+        impl_type;
+
+    // Construct the distributed evaluator type
+    const Permutation tile_perm =
+        (perm_ && permute_tiles_) ? outer(perm_) : Permutation();
+    std::shared_ptr<impl_type> pimpl = std::make_shared<impl_type>(
+        args, *world_, trange_, shape_, pmap_, perm_,
+        typename impl_type::op_type(op, tile_perm));
+
+    return dist_eval_type(pimpl);
+  }
+
   /// Expression print
 
   /// \param os The output stream
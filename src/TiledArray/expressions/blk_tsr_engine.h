@@ -267,14 +267,22 @@ class BlkTsrEngineBase : public LeafEngine<Derived> {
 
   /// Construct the distributed evaluator for array
   dist_eval_type make_dist_eval() const {
+    return make_dist_eval(ExprEngine_::make_op());
+  }
+
+  /// Construct the distributed evaluator for array
+
+  /// \param op The tile operation
+  /// \return The distributed evaluator that applies \c op to the tiles
+  dist_eval_type make_dist_eval(const op_type& op) const {
     // Define the distributed evaluator implementation type
     typedef TiledArray::detail::ArrayEvalImpl<array_type, op_type, policy>
         impl_type;
 
     /// Create the pimpl for the distributed evaluator
-    std::shared_ptr<impl_type> pimpl = std::make_shared<impl_type>(
-        array_, *world_, trange_, shape_, pmap_, perm_, ExprEngine_::make_op(),
-        lower_bound_, upper_bound_);
+    std::shared_ptr<impl_type> pimpl =
+        std::make_shared<impl_type>(array_, *world_, trange_, shape_, pmap_,
+                                    perm_, op, lower_bound_, upper_bound_);
 
     return dist_eval_type(pimpl);
   }
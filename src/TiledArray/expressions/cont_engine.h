@@ -28,8 +28,10 @@
 
 #include <TiledArray/dist_eval/contraction_eval.h>
 #include <TiledArray/expressions/binary_engine.h>
+#include <TiledArray/expressions/leaf_engine.h>
 #include <TiledArray/expressions/permopt.h>
 #include <TiledArray/proc_grid.h>
+#include <TiledArray/tensor/complex.h>
 #include <TiledArray/tensor/utility.h>
 #include <TiledArray/tile_op/contract_reduce.h>
 #include <TiledArray/tile_op/mult.h>
@@ -43,6 +45,21 @@ class MultExpr;
 template <typename, typename, typename>
 class ScalMultExpr;
 
+/// Detect leaf engines that only conjugate the array tiles (i.e. the engines of
+/// \c conj(a("i,j")) ) and can defer the conjugation to their consumer
+template <typename Engine, typename = void>
+struct is_conj_leaf_engine : public std::false_type {};
+
+template <typename Engine>
+struct is_conj_leaf_engine<
+    Engine, std::void_t<decltype(std::declval<Engine&>().defer_scaling())>>
+    : public std::bool_constant<
+          Engine::fused_eval_supported &&
+          std::is_same_v<typename Engine::scalar_type,
+                         TiledArray::detail::ComplexConjugate<void>> &&
+          TiledArray::detail::is_complex_v<TiledArray::detail::numeric_t<
+              typename EngineTrait<Engine>::eval_type>>> {};
+
 /// Multiplication expression engine
 
 /// \tparam Derived The derived engine type
@@ -116,6 +133,9 @@ class ContEngine : public BinaryEngine<Derived> {
                                   const tile_element_type&)>
       inner_tile_return_op_;  ///< Same as inner_tile_nonreturn_op_ but returns
                               ///< the result
+  std::optional<std::pair<math::GemmHelper, scalar_type>>
+      inner_tile_gemm_;  ///< If inner_tile_nonreturn_op_ is a contraction, its
+                         ///< GEMM metadata and scaling factor
   TiledArray::detail::ProcGrid
       proc_grid_;    ///< Process grid for the contraction
   size_type K_ = 1;  ///< Inner dimension size
@@ -154,6 +174,12 @@ class ContEngine : public BinaryEngine<Derived> {
   }
 
  public:
+  /// Element-wise expression query
+
+  /// \return \c true if this is a Hadamard product
+  bool is_elementwise() const {
+    return product_type() == TensorProduct::Hadamard;
+  }
   /// Constructor
 
   /// \tparam L The left-hand argument expression type
@@ -250,14 +276,18 @@ class ContEngine : public BinaryEngine<Derived> {
     // Initialize the tile operation in this function because it is used to
     // evaluate the tiled range and shape.
 
-    const math::blas::Op left_op =
+    math::blas::Op left_op =
         (left_outer_permtype_ == PermutationType::matrix_transpose
              ? math::blas::Transpose
              : math::blas::NoTranspose);
-    const math::blas::Op right_op =
+    math::blas::Op right_op =
         (right_outer_permtype_ == PermutationType::matrix_transpose
              ? math::blas::Transpose
              : math::blas::NoTranspose);
+    if constexpr (!TiledArray::detail::is_tensor_of_tensor_v<value_type>) {
+      left_op = fold_conjugation(left_, left_op);
+      right_op = fold_conjugation(right_, right_op);
+    }
 
     if (outer(target_indices) != outer(indices_)) {
       // Initialize permuted structure
@@ -266,12 +296,15 @@ class ContEngine : public BinaryEngine<Derived> {
         op_ = op_type(left_op, right_op, factor_, outer_size(indices_),
                       outer_size(left_indices_), outer_size(right_indices_),
                       (permute_tiles_ ? perm_ : BipartitePermutation{}));
+        init_argument_perms();
       } else {
         // factor_ is absorbed into inner_tile_nonreturn_op_
         op_ = op_type(left_op, right_op, scalar_type(1), outer_size(indices_),
                       outer_size(left_indices_), outer_size(right_indices_),
                       (permute_tiles_ ? perm_ : BipartitePermutation{}),
                       this->inner_tile_nonreturn_op_);
+        if (inner_tile_gemm_)
+          op_.set_inner_gemm(inner_tile_gemm_->first, inner_tile_gemm_->second);
       }
       trange_ = ContEngine_::make_trange(outer(perm_));
       shape_ = ContEngine_::make_shape(outer(perm_));
@@ -280,11 +313,14 @@ class ContEngine : public BinaryEngine<Derived> {
       if constexpr (!TiledArray::detail::is_tensor_of_tensor_v<value_type>) {
         op_ = op_type(left_op, right_op, factor_, outer_size(indices_),
                       outer_size(left_indices_), outer_size(right_indices_));
+        init_argument_perms();
       } else {
         // factor_ is absorbed into inner_tile_nonreturn_op_
         op_ = op_type(left_op, right_op, scalar_type(1), outer_size(indices_),
                       outer_size(left_indices_), outer_size(right_indices_),
                       BipartitePermutation{}, this->inner_tile_nonreturn_op_);
+        if (inner_tile_gemm_)
+          op_.set_inner_gemm(inner_tile_gemm_->first, inner_tile_gemm_->second);
       }
       trange_ = ContEngine_::make_trange();
       shape_ = ContEngine_::make_shape();
@@ -295,6 +331,85 @@ class ContEngine : public BinaryEngine<Derived> {
     }
   }
 
+  /// Fold the complex conjugation of a leaf argument into GEMM
+
+  /// A conjugated array argument (i.e. \c conj(a("i,j")) ) that GEMM reads
+  /// transposed anyway is passed to GEMM as is, with \c ConjTranspose instead
+  /// of \c Transpose , rather than being conjugated tile by tile in a
+  /// separate pass.
+  /// \param arg The argument engine
+  /// \param op The GEMM operation of \p arg
+  /// \return The GEMM operation that must be applied to the tiles of \p arg
+  template <typename Arg>
+  static math::blas::Op fold_conjugation(Arg& arg, const math::blas::Op op) {
+    if constexpr (is_conj_leaf_engine<Arg>::value) {
+      if (op == math::blas::Transpose) {
+        arg.defer_scaling();
+        return math::blas::ConjTranspose;
+      }
+    }
+    return op;
+  }
+
+  /// Defer the general permutations of leaf arguments to the tile operation
+
+  /// Arguments that are related to GEMM layout by a general permutation (i.e.
+  /// not a matrix transpose, which GEMM absorbs) are permuted tile by tile
+  /// before the contraction. For small tiles the permutations cost more than
+  /// the contraction itself; if this is the case for the average tile, the
+  /// leaf arguments are told not to permute their tiles and \c op_ contracts
+  /// the tiles as they are (see ContractReduceBase::set_argument_perms() ).
+  /// \note this must be called after the children and \c op_ have been
+  /// initialized
+  void init_argument_perms() {
+    using left_tile_type = typename EngineTrait<left_type>::eval_type;
+    using right_tile_type = typename EngineTrait<right_type>::eval_type;
+    if constexpr (TiledArray::detail::is_ta_tensor_v<value_type> &&
+                  TiledArray::detail::is_ta_tensor_v<left_tile_type> &&
+                  TiledArray::detail::is_ta_tensor_v<right_tile_type> &&
+                  TiledArray::detail::is_numeric_v<scalar_type> &&
+                  !TiledArray::detail::is_tensor_of_tensor_v<value_type>) {
+      // only leaves can be told to not permute their tiles after their
+      // structure has been initialized
+      const bool defer_left =
+          std::is_base_of_v<LeafEngine<left_type>, left_type> &&
+          left_outer_permtype_ == PermutationType::general &&
+          bool(outer(left_.perm()));
+      const bool defer_right =
+          std::is_base_of_v<LeafEngine<right_type>, right_type> &&
+          right_outer_permtype_ == PermutationType::general &&
+          bool(outer(right_.perm()));
+      if (!defer_left && !defer_right) return;
+
+      // Estimate the GEMM sizes of the average tile
+      const auto& gemm_helper = op_.gemm_helper();
+      auto average_extent = [](const trange_type& trange, unsigned int d) {
+        return std::max<std::size_t>(
+            trange.elements_range().extent(d) / trange.tiles_range().extent(d),
+            1ul);
+      };
+      std::size_t m = 1ul, n = 1ul, k = 1ul;
+      for (auto d = gemm_helper.left_outer_begin();
+           d != gemm_helper.left_outer_end(); ++d)
+        m *= average_extent(left_.trange(), d);
+      for (auto d = gemm_helper.left_inner_begin();
+           d != gemm_helper.left_inner_end(); ++d)
+        k *= average_extent(left_.trange(), d);
+      for (auto d = gemm_helper.right_outer_begin();
+           d != gemm_helper.right_outer_end(); ++d)
+        n *= average_extent(right_.trange(), d);
+      const std::size_t permuted_volume =
+          (defer_left ? m * k : 0ul) + (defer_right ? k * n : 0ul);
+      if (!op_type::prefer_direct_contraction(m, n, k, permuted_volume))
+        return;
+
+      if (defer_left) left_.permute_tiles(false);
+      if (defer_right) right_.permute_tiles(false);
+      op_.set_argument_perms(defer_left ? outer(left_.perm()) : Permutation{},
+                             defer_right ? outer(right_.perm()) : Permutation{});
+    }
+  }
+
   /// Initialize result tensor distribution
 
   /// This function will initialize the world and process map for the result
@@ -458,6 +573,7 @@ class ContEngine : public BinaryEngine<Derived> {
   void init_inner_tile_op(const IndexList& inner_target_indices) {
     if constexpr (TiledArray::detail::is_tensor_of_tensor_v<value_type>) {
       using inner_tile_type = typename value_type::value_type;
+      this->inner_tile_gemm_.reset();
       const auto inner_prod = this->inner_product_type();
       TA_ASSERT(inner_prod == TensorProduct::Contraction ||
                 inner_prod == TensorProduct::Hadamard);
@@ -489,6 +605,11 @@ class ContEngine : public BinaryEngine<Derived> {
                                              const inner_tile_type& right) {
           contrreduce_op(result, left, right);
         };
+        // the inner contractions of an outer GEMM can be batched if they
+        // are plain GEMMs, i.e. if no inner permutation is needed
+        if (inner_target_indices == inner(this->indices_))
+          this->inner_tile_gemm_.emplace(contrreduce_op.gemm_helper(),
+                                         this->factor_);
       } else if (inner_prod == TensorProduct::Hadamard) {
         // inner tile op depends on the outer op ... e.g. if outer op
         // is contract then inner must implement (ternary) multiply-add;
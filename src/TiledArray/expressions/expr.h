@@ -37,12 +37,14 @@
 #include "TiledArray/config.h"
 #include "TiledArray/tile.h"
 #include "TiledArray/tile_interface/trace.h"
+#include "TiledArray/util/memory.h"
 #include "expr_engine.h"
 #ifdef TILEDARRAY_HAS_CUDA
 #include <TiledArray/cuda/cuda_task_fn.h>
 #include <TiledArray/external/cuda.h>
 #endif
 
+#include <TiledArray/tensor/complex.h>
 #include <TiledArray/tensor/type_traits.h>
 
 namespace TiledArray {
@@ -57,6 +59,20 @@ template <typename, bool>
 class BlkTsrExpr;
 template <typename>
 struct is_aliased;
+template <typename, typename>
+class ScalTsrExpr;
+
+/// Detect conjugated-tensor expressions, i.e. \c conj(a("i,j"))
+
+/// Reductions of these expressions reduce the tiles of the array directly,
+/// with the conjugation folded into the reduction kernel.
+template <typename E>
+struct is_conj_tsr_expr : public std::false_type {};
+
+template <typename Array>
+struct is_conj_tsr_expr<
+    ScalTsrExpr<Array, TiledArray::detail::ComplexConjugate<void>>>
+    : public std::true_type {};
 
 template <typename Engine>
 struct EngineParamOverride {
@@ -352,6 +368,25 @@ class Expr {
   }
 #endif
 
+  /// Attach the memory peak of an evaluation to its result
+
+  /// The measurement is stopped once the local tiles of \c result have been
+  /// set.
+  /// \tparam A The array type
+  /// \param result The result array of the evaluation
+  /// \param peak The memory peak of the evaluation
+  template <typename A>
+  static void stop_peak(A& result,
+                        const std::shared_ptr<TensorBytesPeak>& peak) {
+    result.pimpl()->expression_peak(peak);
+    result.world().taskq.add(
+        [peak](bool) {
+          peak->stop();
+          return true;
+        },
+        result.local_ready(), madness::TaskAttributes::hipri());
+  }
+
  public:
   // Compiler generated functions
   Expr() = default;
@@ -381,6 +416,8 @@ class Expr {
   void eval_to(TsrExpr<A, Alias>& tsr) const {
     static_assert(!is_lazy_tile<typename A::value_type>::value,
                   "Assignment to an array of lazy tiles is not supported.");
+    // Measure the memory peak of this evaluation
+    auto peak = std::make_shared<TensorBytesPeak>();
 
     // Get the target world
     // 1. result's world is assigned, use it
@@ -424,6 +461,7 @@ class Expr {
 
     // Wait for child expressions of dist_eval
     dist_eval.wait();
+    stop_peak(result, peak);
     // Swap the new array with the result array object.
     result.swap(tsr.array());
   }
@@ -446,6 +484,8 @@ class Expr {
     typedef TiledArray::detail::UnaryWrapper<shift_op_type> op_type;
     static_assert(!is_lazy_tile<typename A::value_type>::value,
                   "Assignment to an array of lazy tiles is not supported.");
+    // Measure the memory peak of this evaluation
+    auto peak = std::make_shared<TensorBytesPeak>();
 
 #ifndef NDEBUG
     // Check that the array has been initialized.
@@ -522,6 +562,7 @@ class Expr {
 
     // Wait for child expressions of dist_eval
     dist_eval.wait();
+    stop_peak(result, peak);
     // Swap the new array with the result array object.
     result.swap(tsr.array());
   }
@@ -733,8 +774,13 @@ class Expr {
   Future<typename TiledArray::SquaredNormReduction<
       typename EngineTrait<engine_type>::eval_type>::result_type>
   squared_norm(World& world) const {
-    typedef typename EngineTrait<engine_type>::eval_type value_type;
-    return reduce(TiledArray::SquaredNormReduction<value_type>(), world);
+    if constexpr (is_conj_tsr_expr<Derived>::value) {
+      // ||conj(a)|| = ||a||
+      return conj(derived()).squared_norm(world);
+    } else {
+      typedef typename EngineTrait<engine_type>::eval_type value_type;
+      return reduce(TiledArray::SquaredNormReduction<value_type>(), world);
+    }
   }
 
   Future<typename TiledArray::SquaredNormReduction<
@@ -844,9 +890,15 @@ class Expr {
     typedef typename EngineTrait<engine_type>::eval_type left_value_type;
     typedef typename EngineTrait<typename D::engine_type>::eval_type
         right_value_type;
-    return reduce(right_expr,
-                  TiledArray::DotReduction<left_value_type, right_value_type>(),
-                  world);
+    if constexpr (is_conj_tsr_expr<Derived>::value) {
+      // conj(a) . b is the inner product of a and b, which conjugates the
+      // elements of a in the reduction kernel
+      return conj(derived()).inner_product(right_expr, world);
+    } else {
+      return reduce(
+          right_expr,
+          TiledArray::DotReduction<left_value_type, right_value_type>(), world);
+    }
   }
 
   template <typename D>
@@ -865,10 +917,15 @@ class Expr {
     typedef typename EngineTrait<engine_type>::eval_type left_value_type;
     typedef typename EngineTrait<typename D::engine_type>::eval_type
         right_value_type;
-    return reduce(
-        right_expr,
-        TiledArray::InnerProductReduction<left_value_type, right_value_type>(),
-        world);
+    if constexpr (is_conj_tsr_expr<Derived>::value) {
+      // <conj(a), b> = a . b
+      return conj(derived()).dot(right_expr, world);
+    } else {
+      return reduce(right_expr,
+                    TiledArray::InnerProductReduction<left_value_type,
+                                                      right_value_type>(),
+                    world);
+    }
   }
 
   template <typename D>
@@ -0,0 +1,179 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  fused_engine.h
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_FUSED_ENGINE_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_FUSED_ENGINE_H__INCLUDED
+
+#include <TiledArray/dist_eval/fused_eval.h>
+#include <TiledArray/tensor/type_traits.h>
+
+#include <optional>
+#include <type_traits>
+
+namespace TiledArray {
+namespace expressions {
+
+// Forward declarations
+template <typename>
+struct EngineTrait;
+
+/// Fusion of element-wise expressions
+
+/// Element-wise engines (i.e. AddEngine, SubtEngine, ScalEngine, the Hadamard
+/// MultEngine, etc.) may be evaluated by a single FusedEvalImpl per maximal
+/// element-wise subtree, instead of by one distributed evaluator per node.
+/// An engine supports fusion if it provides
+/// - <tt>static constexpr bool fused_eval_supported</tt>, which is \c true if
+///   the tiles of the engine and its arguments are plain tensors of the same
+///   type;
+/// - <tt>bool fusable() const</tt>, which is \c true if the engine can be
+///   inlined into the fused kernel of its parent (e.g. it does not permute its
+///   result and, for MultEngine, it is a Hadamard product);
+/// - <tt>make_fused_op(args)</tt>, which appends the distributed evaluators of
+///   the arguments of the fused kernel of its subtree to \c args , and returns
+///   the block operation of its subtree (see TiledArray::detail::Fused ).
+/// Fusion is disabled by setting \c TA_FUSED_EVAL to 0.
+template <typename Engine, typename = void>
+struct is_fusable_engine : public std::false_type {};
+
+template <typename Engine>
+struct is_fusable_engine<
+    Engine, std::void_t<decltype(std::declval<const Engine&>().fusable())>>
+    : public std::bool_constant<Engine::fused_eval_supported> {};
+
+template <typename Engine>
+constexpr bool is_fusable_engine_v = is_fusable_engine<Engine>::value;
+
+/// Detects engines that can append themselves to the arguments of a fused
+/// kernel with <tt>make_fused_arg(args)</tt> , e.g. leaves that leave the
+/// permutation of their tiles to the fused kernel
+template <typename Engine, typename Args, typename = void>
+struct has_fused_arg : public std::false_type {};
+
+template <typename Engine, typename Args>
+struct has_fused_arg<Engine, Args,
+                     std::void_t<decltype(std::declval<const Engine&>()
+                                              .make_fused_arg(
+                                                  std::declval<Args&>()))>>
+    : public std::true_type {};
+
+/// \c true if tiles of type \c Tile can be evaluated by a fused kernel
+template <typename Tile>
+constexpr bool is_fused_eval_tile_v =
+    TiledArray::detail::is_ta_tensor_v<Tile> &&
+    !TiledArray::detail::is_tensor_of_tensor_v<Tile>;
+
+/// A node of the block operation of a fused kernel
+
+/// If the node is not inlined, the subtree is an argument of the fused kernel,
+/// i.e. its block is the block of the first argument of the node. Whether the
+/// node is inlined is decided once per block, not per element.
+/// \tparam Op The block operation type of the subtree
+template <typename Op>
+class FusedNode {
+ private:
+  std::optional<Op> op_;  ///< The block operation of the inlined subtree
+
+ public:
+  /// Construct an argument node
+  FusedNode() = default;
+
+  /// Construct an inlined node
+
+  /// \param op The block operation of the subtree
+  explicit FusedNode(Op&& op) : op_(std::move(op)) {}
+
+  /// \return The number of scratch blocks used by this node
+  std::size_t slots() const { return op_ ? op_->slots() : 0ul; }
+
+  /// \param args The blocks of the arguments of this node
+  /// \param n The number of elements of the block
+  /// \param scratch slots() scratch blocks
+  /// \return The block of this node
+  template <typename T>
+  const T* operator()(const T* const* args, const std::size_t n,
+                      T* scratch) const {
+    return op_ ? (*op_)(args, n, scratch) : args[0];
+  }
+
+};  // class FusedNode
+
+/// \return \c true if \c engine will be inlined into the fused kernel of its
+/// parent
+template <typename Engine>
+bool is_fused(const Engine& engine) {
+  if constexpr (is_fusable_engine_v<Engine>)
+    return TiledArray::detail::fused_eval_enabled() && engine.fusable();
+  else
+    return false;
+}
+
+/// Append the distributed evaluator of \c engine to the arguments of a fused
+/// kernel
+
+/// \tparam Tile The tile type of the fused kernel
+/// \tparam Policy The tensor policy class
+/// \tparam Engine The engine type
+/// \param engine The engine
+/// \param args The arguments of the fused kernel
+template <typename Tile, typename Policy, typename Engine>
+void push_fused_arg(const Engine& engine,
+                    TiledArray::detail::FusedEvalArgs<Tile, Policy>& args) {
+  if constexpr (has_fused_arg<
+                    Engine,
+                    TiledArray::detail::FusedEvalArgs<Tile, Policy>>::value)
+    engine.make_fused_arg(args);
+  else
+    args.push_back(TiledArray::detail::make_fused_eval_arg<Tile, Policy>(
+        engine.make_dist_eval()));
+}
+
+/// Construct a node of the block operation of a fused kernel
+
+/// \c engine is inlined if it supports fusion, otherwise its distributed
+/// evaluator is appended to \c args .
+/// \tparam Tile The tile type of the fused kernel
+/// \tparam Policy The tensor policy class
+/// \tparam Engine The engine type
+/// \param engine The engine
+/// \param args The arguments of the fused kernel
+/// \return The node of the block operation
+template <typename Tile, typename Policy, typename Engine>
+auto make_fused_node(const Engine& engine,
+                     TiledArray::detail::FusedEvalArgs<Tile, Policy>& args) {
+  static_assert(
+      std::is_same_v<typename EngineTrait<Engine>::eval_type, Tile>,
+      "the arguments of a fused kernel must evaluate to the fused tile type");
+  if constexpr (is_fusable_engine_v<Engine>) {
+    using op_type = decltype(engine.make_fused_op(args));
+    if (is_fused(engine)) return FusedNode<op_type>(engine.make_fused_op(args));
+    push_fused_arg(engine, args);
+    return FusedNode<op_type>();
+  } else {
+    push_fused_arg(engine, args);
+    return TiledArray::detail::FusedArgOp();
+  }
+}
+
+}  // namespace expressions
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_EXPRESSIONS_FUSED_ENGINE_H__INCLUDED
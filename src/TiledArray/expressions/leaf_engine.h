@@ -27,6 +27,7 @@
 #define TILEDARRAY_EXPRESSIONS_LEAF_ENGINE_H__INCLUDED
 
 #include <TiledArray/dist_eval/array_eval.h>
+#include <TiledArray/dist_eval/fused_eval.h>
 #include <TiledArray/expressions/expr_engine.h>
 
 namespace TiledArray {
@@ -159,18 +160,45 @@ class LeafEngine : public ExprEngine<Derived> {
 
   /// Construct the distributed evaluator for array
   dist_eval_type make_dist_eval() const {
+    return make_dist_eval(ExprEngine_::make_op());
+  }
+
+  /// Construct the distributed evaluator for array
+
+  /// \param op The tile operation
+  /// \return The distributed evaluator that applies \c op to the tiles
+  dist_eval_type make_dist_eval(const op_type& op) const {
     // Define the distributed evaluator implementation type
     typedef TiledArray::detail::ArrayEvalImpl<array_type, op_type, policy>
         impl_type;
 
     /// Create the pimpl for the distributed evaluator
-    std::shared_ptr<impl_type> pimpl =
-        std::make_shared<impl_type>(array_, *world_, trange_, shape_, pmap_,
-                                    outer(perm_), ExprEngine_::make_op());
+    std::shared_ptr<impl_type> pimpl = std::make_shared<impl_type>(
+        array_, *world_, trange_, shape_, pmap_, outer(perm_), op);
 
     return dist_eval_type(pimpl);
   }
 
+  /// Append the distributed evaluator for array to the arguments of a fused
+  /// kernel
+
+  /// If the tiles must be permuted, the fused kernel reads them through their
+  /// permuted strides, rather than permuting them in a separate tile
+  /// operation.
+  /// \tparam Tile The tile type of the fused kernel
+  /// \tparam Policy The tensor policy class
+  /// \param args The arguments of the fused kernel
+  template <typename Tile, typename Policy>
+  void make_fused_arg(
+      TiledArray::detail::FusedEvalArgs<Tile, Policy>& args) const {
+    if (perm_ && permute_tiles_)
+      args.push_back(TiledArray::detail::make_fused_eval_arg<Tile, Policy>(
+          derived().make_dist_eval(derived().make_tile_op()), outer(perm_)));
+    else
+      args.push_back(TiledArray::detail::make_fused_eval_arg<Tile, Policy>(
+          derived().make_dist_eval()));
+  }
+
 };  // class LeafEngine
 
 }  // namespace expressions
@@ -437,14 +437,25 @@ class MultEngine : public ContEngine<MultEngine<Left, Right, Result>> {
     abort();  // unreachable
   }
 
+  /// Fused element operation factory function
+
+  /// \return The element operation of the fused (Hadamard) kernel
+  static auto make_fused_element_op() {
+    return [](const auto& left, const auto& right) { return left * right; };
+  }
+
   /// Construct the distributed evaluator for this expression
 
+  /// A Hadamard product with inlined element-wise arguments is evaluated by
+  /// a fused kernel.
   /// \return The distributed evaluator that will evaluate this expression
   dist_eval_type make_dist_eval() const {
     if (this->product_type() == TensorProduct::Contraction)
       return ContEngine_::make_dist_eval();
-    else
-      return BinaryEngine_::make_dist_eval();
+    if constexpr (BinaryEngine_::fused_eval_supported) {
+      if (this->is_fused_eval()) return this->make_fused_dist_eval();
+    }
+    return BinaryEngine_::make_dist_eval();
   }
 
   /// Expression identification tag
@@ -608,12 +619,16 @@ class ScalMultEngine
 
   /// Construct the distributed evaluator for this expression
 
+  /// A Hadamard product with inlined element-wise arguments is evaluated by
+  /// a fused kernel.
   /// \return The distributed evaluator that will evaluate this expression
   dist_eval_type make_dist_eval() const {
     if (this->product_type() == TensorProduct::Contraction)
       return ContEngine_::make_dist_eval();
-    else
-      return BinaryEngine_::make_dist_eval();
+    if constexpr (BinaryEngine_::fused_eval_supported) {
+      if (this->is_fused_eval()) return this->make_fused_dist_eval();
+    }
+    return BinaryEngine_::make_dist_eval();
   }
 
   /// Non-permuting tiled range factory function
@@ -671,6 +686,16 @@ class ScalMultEngine
     return op_type(op_base_type(ContEngine_::factor_), perm);
   }
 
+  /// Fused element operation factory function
+
+  /// \return The element operation of the fused (Hadamard) kernel
+  auto make_fused_element_op() const {
+    const scalar_type factor = ContEngine_::factor_;
+    return [factor](const auto& left, const auto& right) {
+      return (left * right) * factor;
+    };
+  }
+
   /// Expression identification tag
 
   /// \return An expression tag used to identify this expression
@@ -152,6 +152,14 @@ class ScalEngine : public UnaryEngine<ScalEngine<Arg, Scalar, Result>> {
     return op_type(perm, factor_);
   }
 
+  /// Fused element operation factory function
+
+  /// \return The element operation of the fused kernel
+  auto make_fused_element_op() const {
+    const scalar_type factor = factor_;
+    return [factor](const auto& arg) { return arg * factor; };
+  }
+
   /// Expression identification tag
 
   /// \return An expression tag used to identify this expression
@@ -26,6 +26,7 @@
 #ifndef TILEDARRAY_EXPRESSIONS_SCAL_TSR_ENGINE_H__INCLUDED
 #define TILEDARRAY_EXPRESSIONS_SCAL_TSR_ENGINE_H__INCLUDED
 
+#include <TiledArray/expressions/fused_engine.h>
 #include <TiledArray/expressions/leaf_engine.h>
 #include <TiledArray/tile_op/scal.h>
 #include <TiledArray/tile_op/unary_wrapper.h>
@@ -113,14 +114,39 @@ class ScalTsrEngine : public LeafEngine<ScalTsrEngine<Array, Scalar, Result>> {
   typedef typename EngineTrait<ScalTsrEngine_>::pmap_interface
       pmap_interface;  ///< Process map interface type
 
+  /// \c true if this expression may be inlined into a fused kernel, see
+  /// is_fusable_engine
+  static constexpr bool fused_eval_supported =
+      is_fused_eval_tile_v<typename EngineTrait<ScalTsrEngine_>::eval_type> &&
+      std::is_same_v<typename EngineTrait<ScalTsrEngine_>::eval_type,
+                     typename op_base_type::argument_type>;
+
  private:
   scalar_type factor_;  ///< The scaling factor
+  bool scaling_deferred_ = false;  ///< If \c true , the consumer of the
+                                   ///< tiles applies the scaling factor
 
  public:
   template <typename A, typename S>
   ScalTsrEngine(const ScalTsrExpr<A, S>& expr)
       : LeafEngine_(expr), factor_(expr.factor()) {}
 
+  /// Scaling factor accessor
+
+  /// \return The scaling factor
+  scalar_type factor() const { return factor_; }
+
+  /// Defer the scaling of the tiles to their consumer
+
+  /// After this call the tiles of this expression are the (possibly
+  /// permuted) tiles of the array, and the consumer is responsible for
+  /// applying factor() , e.g. a contraction applies a complex conjugation
+  /// via ConjTranspose.
+  void defer_scaling() {
+    TA_ASSERT(fused_eval_supported);
+    scaling_deferred_ = true;
+  }
+
   /// Non-permuting shape factory function
 
   /// \return The result shape
@@ -137,7 +163,9 @@ class ScalTsrEngine : public LeafEngine<ScalTsrEngine<Array, Scalar, Result>> {
   /// Non-permuting tile operation factory function
 
   /// \return The tile operation
-  op_type make_tile_op() const { return op_type(op_base_type(factor_)); }
+  op_type make_tile_op() const {
+    return op_type(op_base_type(factor_, scaling_deferred_));
+  }
 
   /// Permuting tile operation factory function
 
@@ -146,7 +174,38 @@ class ScalTsrEngine : public LeafEngine<ScalTsrEngine<Array, Scalar, Result>> {
   template <typename Perm, typename = std::enable_if_t<
                                TiledArray::detail::is_permutation_v<Perm>>>
   op_type make_tile_op(const Perm& perm) const {
-    return op_type(op_base_type(factor_), perm);
+    return op_type(op_base_type(factor_, scaling_deferred_), perm);
+  }
+
+  /// Fusion query
+
+  /// \return \c true , the scaling (and permutation) can always be applied
+  /// by the fused kernel of the parent expression
+  bool fusable() const { return true; }
+
+  /// Construct the block operation of the fused kernel of this expression
+
+  /// The unscaled (and unpermuted) tiles of the array are appended to \c args
+  /// , and the scaling (including complex conjugation) is applied by the
+  /// block operation, i.e. it costs no separate pass over the tiles.
+  /// \param args The arguments of the fused kernel
+  /// \return The block operation of this expression
+  template <typename Tile, typename Policy>
+  auto make_fused_op(
+      TiledArray::detail::FusedEvalArgs<Tile, Policy>& args) const {
+    const Permutation tile_perm =
+        (LeafEngine_::perm_ && LeafEngine_::permute_tiles_)
+            ? outer(LeafEngine_::perm_)
+            : Permutation();
+    args.push_back(TiledArray::detail::make_fused_eval_arg<Tile, Policy>(
+        LeafEngine_::make_dist_eval(op_type(op_base_type(factor_, true))),
+        tile_perm));
+
+    const scalar_type factor = factor_;
+    auto op = [factor](const auto& value) { return value * factor; };
+    return TiledArray::detail::FusedUnaryOp<TiledArray::detail::FusedArgOp,
+                                            decltype(op)>(
+        TiledArray::detail::FusedArgOp(), op);
   }
 
   /// Expression identification tag
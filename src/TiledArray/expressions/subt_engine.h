@@ -201,6 +201,13 @@ class SubtEngine : public BinaryEngine<SubtEngine<Left, Right, Result>> {
     return op_type(op_base_type(), perm);
   }
 
+  /// Fused element operation factory function
+
+  /// \return The element operation of the fused kernel
+  static auto make_fused_element_op() {
+    return [](const auto& left, const auto& right) { return left - right; };
+  }
+
   /// Expression identification tag
 
   /// \return An expression tag used to identify this expression
@@ -302,6 +309,16 @@ class ScalSubtEngine
     return op_type(op_base_type(factor_), perm);
   }
 
+  /// Fused element operation factory function
+
+  /// \return The element operation of the fused kernel
+  auto make_fused_element_op() const {
+    const scalar_type factor = factor_;
+    return [factor](const auto& left, const auto& right) {
+      return (left - right) * factor;
+    };
+  }
+
   /// Expression identification tag
 
   /// \return An expression tag used to identify this expression
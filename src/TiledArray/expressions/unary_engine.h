@@ -28,6 +28,7 @@
 
 #include <TiledArray/dist_eval/unary_eval.h>
 #include <TiledArray/expressions/expr_engine.h>
+#include <TiledArray/expressions/fused_engine.h>
 
 namespace TiledArray {
 namespace expressions {
@@ -68,6 +69,14 @@ class UnaryEngine : ExprEngine<Derived> {
   static constexpr bool consumable = true;
   static constexpr unsigned int leaves = argument_type::leaves;
 
+  /// \c true if this expression may be evaluated by a fused kernel, see
+  /// is_fusable_engine
+  static constexpr bool fused_eval_supported =
+      is_fused_eval_tile_v<value_type> &&
+      std::is_same_v<typename EngineTrait<Derived>::eval_type, value_type> &&
+      std::is_same_v<typename EngineTrait<argument_type>::eval_type,
+                     value_type>;
+
  protected:
   // Import base class variables to this scope
   using ExprEngine_::indices_;
@@ -154,10 +163,36 @@ class UnaryEngine : ExprEngine<Derived> {
     return perm ^ arg_.trange();
   }
 
+  /// Fusion query
+
+  /// \return \c true if this expression can be inlined into the fused kernel
+  /// of its parent expression
+  bool fusable() const { return !perm_; }
+
+  /// Construct the block operation of the fused kernel of this expression
+
+  /// The arguments of the fused kernel are appended to \c args in the order
+  /// expected by the returned block operation.
+  /// \param args The arguments of the fused kernel
+  /// \return The block operation of this expression
+  auto make_fused_op(
+      TiledArray::detail::FusedEvalArgs<value_type, policy>& args) const {
+    auto arg = make_fused_node<value_type, policy>(arg_, args);
+    auto op = derived().make_fused_element_op();
+    return TiledArray::detail::FusedUnaryOp<decltype(arg), decltype(op)>(arg,
+                                                                        op);
+  }
+
   /// Construct the distributed evaluator for this expression
 
+  /// If the argument is an element-wise expression that can be inlined, this
+  /// expression is evaluated by a single fused kernel.
   /// \return The distributed evaluator that will evaluate this expression
   dist_eval_type make_dist_eval() const {
+    if constexpr (fused_eval_supported) {
+      if (is_fused(arg_)) return make_fused_dist_eval();
+    }
+
     typedef TiledArray::detail::UnaryEvalImpl<
         typename argument_type::dist_eval_type, typename Derived::op_type,
         typename dist_eval_type::policy>
@@ -173,6 +208,25 @@ class UnaryEngine : ExprEngine<Derived> {
     return dist_eval_type(pimpl);
   }
 
+  /// Construct the fused distributed evaluator for this expression
+
+  /// \return The distributed evaluator that will evaluate this expression
+  dist_eval_type make_fused_dist_eval() const {
+    TiledArray::detail::FusedEvalArgs<value_type, policy> args;
+    auto op = make_fused_op(args);
+    typedef TiledArray::detail::FusedEvalImpl<value_type, policy, decltype(op)>
+        impl_type;
+
+    // Construct the distributed evaluator type
+    const Permutation tile_perm =
+        (perm_ && permute_tiles_) ? outer(perm_) : Permutation();
+    std::shared_ptr<impl_type> pimpl = std::make_shared<impl_type>(
+        args, *world_, trange_, shape_, pmap_, perm_,
+        typename impl_type::op_type(op, tile_perm));
+
+    return dist_eval_type(pimpl);
+  }
+
   /// Expression print
 
   /// \param os The output stream
@@ -0,0 +1,247 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  mapped_array.h
+ *
+ */
+
+#ifndef TILEDARRAY_MAPPED_ARRAY_H__INCLUDED
+#define TILEDARRAY_MAPPED_ARRAY_H__INCLUDED
+
+#include <TiledArray/checkpoint.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TILEDARRAY_HAS_MMAP 1
+#endif
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+namespace detail {
+
+/// The alignment of the tiles in a mapped array data file
+constexpr std::int64_t mapped_array_alignment = 4096;
+
+/// The magic number of a mapped array index file ("TAMAPD01")
+constexpr std::uint64_t mapped_array_magic = 0x54414d4150443031ul;
+
+#ifdef TILEDARRAY_HAS_MMAP
+
+/// A read-only memory mapping of a file
+
+/// The file is mapped privately, i.e. the pages are shared with the page
+/// cache (and with the other processes that map the file) until they are
+/// written to, and writes are never carried through to the file.
+class MappedFile {
+ private:
+  void* data_ = nullptr;     ///< The mapped memory
+  std::size_t bytes_ = 0ul;  ///< The size of the mapping
+
+ public:
+  MappedFile() = delete;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /// Map a file
+
+  /// \param name The name of the file
+  /// \throw TiledArray::Exception if the file cannot be mapped
+  explicit MappedFile(const std::string& name) {
+    const int fd = open(name.c_str(), O_RDONLY);
+    if (fd < 0) TA_EXCEPTION("MappedFile: cannot open file");
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+      close(fd);
+      TA_EXCEPTION("MappedFile: cannot stat file");
+    }
+    bytes_ = status.st_size;
+    if (bytes_ > 0ul) {
+      data_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      if (data_ == MAP_FAILED) data_ = nullptr;
+    }
+    close(fd);
+    if (bytes_ > 0ul && !data_) TA_EXCEPTION("MappedFile: cannot map file");
+  }
+
+  ~MappedFile() {
+    if (data_) munmap(data_, bytes_);
+  }
+
+  /// \return A pointer to the mapped memory
+  void* data() const { return data_; }
+
+  /// \return The size of the mapping
+  std::size_t size() const { return bytes_; }
+
+};  // class MappedFile
+
+#endif  // TILEDARRAY_HAS_MMAP
+
+}  // namespace detail
+
+/// Write an array in a memory-mappable layout
+
+/// The format is that of write_checkpoint(), i.e. every process writes its
+/// local tiles to its own data file (only the first process, if the array
+/// is replicated) and the first process writes the index file, except that the tiles are stored as raw elements (not serialized),
+/// each aligned to a page boundary. Such arrays are read with map_array().
+/// \tparam Tile The tile type; must be a plain tensor of scalars, e.g.
+/// TiledArray::Tensor<double>
+/// \tparam Policy The policy type
+/// \param array The array to be written
+/// \param prefix The path prefix of the files
+/// \throw TiledArray::Exception if a file cannot be written
+/// \note This is a collective operation.
+template <typename Tile, typename Policy>
+void write_mapped_array(const DistArray<Tile, Policy>& array,
+                        const std::string& prefix) {
+  static_assert(detail::is_ta_tensor_v<Tile> &&
+                    !detail::is_tensor_of_tensor_v<Tile>,
+                "write_mapped_array: the tiles must be tensors of scalars");
+  typedef typename Tile::value_type value_type;
+  static_assert(std::is_trivially_copyable_v<value_type>,
+                "write_mapped_array: the elements must be trivially copyable");
+
+  World& world = array.world();
+  world.gop.fence();
+
+  detail::CheckpointIndex index = detail::make_checkpoint_index(array);
+  // Every process holds every tile of a replicated array; only the first
+  // process writes them, so that each tile is in the index once
+  if (!array.pmap()->is_replicated() || world.rank() == 0) {
+    std::ofstream file(detail::checkpoint_file_name(prefix, world.rank()),
+                       std::ios::binary | std::ios::trunc);
+    if (!file)
+      TA_EXCEPTION("write_mapped_array: cannot open data file");
+
+    std::int64_t offset = 0;
+    const std::vector<char> padding(detail::mapped_array_alignment, 0);
+    for (const auto i : *array.pmap()) {
+      if (array.is_zero(i)) continue;
+      const Tile tile = array.find(i).get();
+      TA_ASSERT(tile.range() == array.trange().make_tile_range(i));
+      const std::int64_t bytes = tile.range().volume() * sizeof(value_type);
+      file.write(reinterpret_cast<const char*>(tile.data()), bytes);
+      index.files[i] = world.rank() + 1;
+      index.offsets[i] = offset;
+      index.bytes[i] = bytes;
+
+      // pad the tile to the next page boundary
+      const std::int64_t end = offset + bytes;
+      offset = (end + detail::mapped_array_alignment - 1) /
+               detail::mapped_array_alignment * detail::mapped_array_alignment;
+      file.write(padding.data(), offset - end);
+    }
+    if (!file) TA_EXCEPTION("write_mapped_array: cannot write data file");
+  }
+
+  detail::write_checkpoint_index(world, index, prefix,
+                                 detail::mapped_array_magic, array.trange(),
+                                 array.shape());
+}
+
+/// Map an array written by write_mapped_array()
+
+/// Every process maps the data files that hold the tiles it owns; the local
+/// tiles of the result are zero-copy views of the mappings. No data is read
+/// until a tile is first touched, and the pages are shared, via the page
+/// cache, by all processes of a node. The number of processes and the
+/// process map may differ from those of the array that was written.
+/// \tparam Array The array type; must be the type of the array that was
+/// written
+/// \param world The world of the result
+/// \param prefix The path prefix of the files
+/// \param pmap The process map of the result; the default process map is
+/// used if null
+/// \return The array
+/// \warning The tiles of the result are meant to be read-only: modifying a
+/// tile in place creates a private copy of the modified pages, and the
+/// modifications are never written to the files.
+/// \throw TiledArray::Exception if the files cannot be mapped, or if they do
+/// not hold an \c Array
+/// \note This is a collective operation.
+template <typename Array>
+Array map_array(World& world, const std::string& prefix,
+                std::shared_ptr<typename Array::pmap_interface> pmap = {}) {
+  typedef typename Array::ordinal_type ordinal_type;
+  typedef typename Array::value_type value_type;
+  typedef typename value_type::value_type numeric_type;
+
+#ifdef TILEDARRAY_HAS_MMAP
+  detail::CheckpointIndex index;
+  typename Array::trange_type trange;
+  typename Array::shape_type shape;
+  {
+    const auto name = detail::checkpoint_index_name(prefix);
+    if (!std::ifstream(name))
+      TA_EXCEPTION("map_array: cannot open index file");
+    madness::archive::BinaryFstreamInputArchive ar(name.c_str());
+    std::uint64_t magic = 0ul;
+    ar& magic;
+    if (magic != detail::mapped_array_magic)
+      TA_EXCEPTION("map_array: invalid index file");
+    ar& index;
+    if (index.typeid_hash != typeid(Array).hash_code())
+      TA_EXCEPTION("map_array: source DistArray type != this DistArray type");
+    ar& trange& shape;
+  }
+
+  const ordinal_type ntiles = trange.tiles_range().volume();
+  TA_ASSERT(index.files.size() == ntiles);
+  if (!pmap) pmap = detail::policy_t<Array>::default_pmap(world, ntiles);
+  Array result(world, trange, shape, pmap);
+
+  std::map<std::int64_t, std::shared_ptr<detail::MappedFile>> files;
+  for (const auto i : *pmap) {
+    if (result.is_zero(i)) continue;
+    if (index.files[i] < 0)
+      TA_EXCEPTION("map_array: tile is missing from the files");
+
+    auto& file = files[index.files[i]];
+    if (!file)
+      file = std::make_shared<detail::MappedFile>(
+          detail::checkpoint_file_name(prefix, index.files[i]));
+    auto range = trange.make_tile_range(i);
+    if (index.bytes[i] !=
+            std::int64_t(range.volume() * sizeof(numeric_type)) ||
+        std::size_t(index.offsets[i] + index.bytes[i]) > file->size())
+      TA_EXCEPTION("map_array: invalid data file");
+
+    auto* data = reinterpret_cast<numeric_type*>(
+        static_cast<char*>(file->data()) + index.offsets[i]);
+    result.set(i, value_type(std::move(range), data, file));
+  }
+
+  world.gop.fence();
+  return result;
+#else
+  TA_EXCEPTION("map_array: memory-mapped files are not supported");
+  return Array();
+#endif  // TILEDARRAY_HAS_MMAP
+}
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_MAPPED_ARRAY_H__INCLUDED
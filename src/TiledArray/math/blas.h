@@ -26,6 +26,7 @@
 #ifndef TILEDARRAY_MATH_BLAS_H__INCLUDED
 #define TILEDARRAY_MATH_BLAS_H__INCLUDED
 
+#include <TiledArray/config.h>
 #include <TiledArray/external/eigen.h>
 #include <TiledArray/type_traits.h>
 
@@ -37,6 +38,15 @@
 
 #include <cstdint>
 
+#if defined(TILEDARRAY_HAS_INTEL_MKL)
+#include <mkl_cblas.h>
+#include <mkl_version.h>
+// *gemm_batch_strided appeared in MKL 2020 Update 2
+#if INTEL_MKL_VERSION >= 20200002
+#define TILEDARRAY_HAS_BLAS_GEMM_BATCH 1
+#endif
+#endif
+
 namespace TiledArray::math::blas {
 
 /// the integer type used by C++ BLAS/LAPACK interface, same as that used by
@@ -196,6 +206,116 @@ inline void gemm(Op op_a, Op op_b, const integer m, const integer n,
                lda, beta, c, ldc);
 }
 
+// Batched BLAS _GEMM wrapper functions
+
+/// Batched GEMM of uniformly-sized (row-major) matrices
+
+/// Computes <tt>C[i] = alpha * op_a(A[i]) * op_b(B[i]) + beta * C[i]</tt> for
+/// each \c i in <tt>[0, batch_size)</tt>. This is the portable
+/// implementation, it simply loops over the batch.
+template <typename S1, typename T1, typename T2, typename S2, typename T3>
+inline void gemm_batch(Op op_a, Op op_b, const integer m, const integer n,
+                       const integer k, const S1 alpha, const T1* const* a,
+                       const integer lda, const T2* const* b,
+                       const integer ldb, const S2 beta, T3* const* c,
+                       const integer ldc, const integer batch_size) {
+  for (integer i = 0; i != batch_size; ++i)
+    gemm(op_a, op_b, m, n, k, alpha, a[i], lda, b[i], ldb, beta, c[i], ldc);
+}
+
+/// Strided batched GEMM of uniformly-sized (row-major) matrices
+
+/// Same as gemm_batch, with <tt>A[i] = a + i * stride_a</tt>, <tt>B[i] = b + i
+/// * stride_b</tt>, and <tt>C[i] = c + i * stride_c</tt>. This is the
+/// portable implementation, it simply loops over the batch.
+template <typename S1, typename T1, typename T2, typename S2, typename T3>
+inline void gemm_batch_strided(Op op_a, Op op_b, const integer m,
+                               const integer n, const integer k,
+                               const S1 alpha, const T1* a, const integer lda,
+                               const integer stride_a, const T2* b,
+                               const integer ldb, const integer stride_b,
+                               const S2 beta, T3* c, const integer ldc,
+                               const integer stride_c,
+                               const integer batch_size) {
+  for (integer i = 0; i != batch_size;
+       ++i, a += stride_a, b += stride_b, c += stride_c)
+    gemm(op_a, op_b, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+#ifdef TILEDARRAY_HAS_BLAS_GEMM_BATCH
+
+inline CBLAS_TRANSPOSE to_cblas(Op op) {
+  if (op == NoTranspose)
+    return CblasNoTrans;
+  else if (op == Transpose)
+    return CblasTrans;
+  else  // op == ConjTranspose
+    return CblasConjTrans;
+}
+
+template <typename T>
+inline auto to_cblas_scalar(const T& x) {
+  if constexpr (TiledArray::detail::is_complex_v<T>)
+    return static_cast<const void*>(&x);
+  else
+    return x;
+}
+
+template <typename T>
+inline auto to_cblas_input_array(const T* const* x) {
+  if constexpr (TiledArray::detail::is_complex_v<T>)
+    return reinterpret_cast<const void**>(const_cast<const T**>(x));
+  else
+    return const_cast<const T**>(x);
+}
+
+template <typename T>
+inline auto to_cblas_output_array(T* const* x) {
+  if constexpr (TiledArray::detail::is_complex_v<T>)
+    return reinterpret_cast<void**>(const_cast<T**>(x));
+  else
+    return const_cast<T**>(x);
+}
+
+// N.B. as in gemm, row-major C = A * B is computed as col-major C^T = B^T A^T
+#define TILEDARRAY_MKL_GEMM_BATCH(T, prefix)                                   \
+  inline void gemm_batch(Op op_a, Op op_b, const integer m, const integer n,   \
+                         const integer k, const T alpha, const T* const* a,    \
+                         const integer lda, const T* const* b,                 \
+                         const integer ldb, const T beta, T* const* c,         \
+                         const integer ldc, const integer batch_size) {        \
+    const CBLAS_TRANSPOSE trans_a = to_cblas(op_a);                            \
+    const CBLAS_TRANSPOSE trans_b = to_cblas(op_b);                            \
+    const MKL_INT m_ = m, n_ = n, k_ = k, lda_ = lda, ldb_ = ldb, ldc_ = ldc,  \
+                  group_size = batch_size;                                     \
+    cblas_##prefix##gemm_batch(CblasColMajor, &trans_b, &trans_a, &n_, &m_,    \
+                               &k_, &alpha, to_cblas_input_array(b),           \
+                               &ldb_, to_cblas_input_array(a), &lda_,          \
+                               &beta, to_cblas_output_array(c),                \
+                               &ldc_, 1, &group_size);                         \
+  }                                                                            \
+  inline void gemm_batch_strided(                                              \
+      Op op_a, Op op_b, const integer m, const integer n, const integer k,     \
+      const T alpha, const T* a, const integer lda, const integer stride_a,    \
+      const T* b, const integer ldb, const integer stride_b, const T beta,     \
+      T* c, const integer ldc, const integer stride_c,                         \
+      const integer batch_size) {                                              \
+    cblas_##prefix##gemm_batch_strided(                                        \
+        CblasColMajor, to_cblas(op_b), to_cblas(op_a), n, m,                   \
+        k, to_cblas_scalar(alpha), b, ldb, stride_b, a, lda,                   \
+        stride_a, to_cblas_scalar(beta), c, ldc, stride_c,                     \
+        batch_size);                                                           \
+  }
+
+TILEDARRAY_MKL_GEMM_BATCH(float, s)
+TILEDARRAY_MKL_GEMM_BATCH(double, d)
+TILEDARRAY_MKL_GEMM_BATCH(std::complex<float>, c)
+TILEDARRAY_MKL_GEMM_BATCH(std::complex<double>, z)
+
+#undef TILEDARRAY_MKL_GEMM_BATCH
+
+#endif  // TILEDARRAY_HAS_BLAS_GEMM_BATCH
+
 // BLAS _SCAL wrapper functions
 
 template <typename T, typename U>
@@ -256,6 +376,37 @@ inline std::complex<double> dot(integer n, const std::complex<double>* x,
   return ::blas::dot(n, x, 1, y, 1);
 }
 
+// BLAS _DOTC wrapper functions
+
+/// Conjugated dot product, \f$ \sum_i x_i^* y_i \f$
+
+/// For real types this is the same as dot.
+template <typename T>
+T dotc(const integer n, const T* x, const T* y) {
+  // N.B. Eigen's dot conjugates its first argument
+  return Vector<T>::Map(x, n).dot(Vector<T>::Map(y, n));
+}
+
+inline float dotc(const integer n, const float* x, const float* y) {
+  return ::blas::dot(n, x, 1, y, 1);
+}
+
+inline double dotc(const integer n, const double* x, const double* y) {
+  return ::blas::dot(n, x, 1, y, 1);
+}
+
+// N.B. ::blas::dot is the conjugated dot product (i.e. ?dotc) for complex types
+inline std::complex<float> dotc(const integer n, const std::complex<float>* x,
+                                const std::complex<float>* y) {
+  return ::blas::dot(n, x, 1, y, 1);
+}
+
+inline std::complex<double> dotc(const integer n,
+                                 const std::complex<double>* x,
+                                 const std::complex<double>* y) {
+  return ::blas::dot(n, x, 1, y, 1);
+}
+
 // Import the madness dot functions into the TiledArray namespace
 using ::blas::dot;
 
@@ -0,0 +1,197 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sfc_pmap.h
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_SFC_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_SFC_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/pmap.h>
+#include <TiledArray/range.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+namespace detail {
+
+/// A space-filling-curve process map
+
+/// Map the tiles of a multidimensional tile index space among P processes by
+/// ordering the tiles along a space-filling curve (Hilbert or Morton/Z-order)
+/// and splitting the curve into P contiguous segments of approximately N/P
+/// tiles. Unlike BlockedPmap, which assigns slabs along the slowest index,
+/// the tiles of each process form compact hyper-blocks, so that block
+/// expressions, permutations, and contraction panels touch fewer owners.
+/// Extents that are not powers of two are supported; the curve simply skips
+/// the indices outside the tile index space.
+/// \note The owners of all tiles are stored, i.e. the memory requirement is
+/// O(N) per process.
+class SfcPmap : public Pmap {
+ protected:
+  // Import Pmap protected variables
+  using Pmap::local_;  ///< The local tiles
+  using Pmap::procs_;  ///< The number of processes
+  using Pmap::rank_;   ///< The rank of this process
+  using Pmap::size_;   ///< The number of tiles mapped among all processes
+
+ public:
+  typedef Pmap::size_type size_type;  ///< Key type
+
+  /// The space-filling curve type
+  enum class Curve {
+    Hilbert,  ///< Hilbert curve; consecutive tiles are always neighbors
+    Morton    ///< Morton (Z-order) curve; cheaper, but with occasional jumps
+  };
+
+ private:
+  std::vector<ProcessID> owners_;  ///< The owner of each tile
+
+  /// Compute the curve key of a tile
+
+  /// \param coords The coordinates of the tile (overwritten)
+  /// \param bits The number of bits per coordinate
+  /// \param curve The curve type
+  /// \return The position of the tile along the curve
+  static std::uint64_t curve_key(std::vector<std::uint64_t>& coords,
+                                 const unsigned int bits, const Curve curve) {
+    const std::size_t n = coords.size();
+    if (curve == Curve::Hilbert && bits > 0u) {
+      // Transform the coordinates into the transposed Hilbert index
+      // (J. Skilling, AIP Conf. Proc. 707, 381 (2004))
+      const std::uint64_t m = std::uint64_t(1) << (bits - 1u);
+      for (std::uint64_t q = m; q > 1u; q >>= 1) {
+        const std::uint64_t p = q - 1u;
+        for (std::size_t i = 0ul; i < n; ++i) {
+          if (coords[i] & q) {
+            coords[0] ^= p;
+          } else {
+            const std::uint64_t t = (coords[0] ^ coords[i]) & p;
+            coords[0] ^= t;
+            coords[i] ^= t;
+          }
+        }
+      }
+      // Gray encode
+      for (std::size_t i = 1ul; i < n; ++i) coords[i] ^= coords[i - 1];
+      std::uint64_t t = 0u;
+      for (std::uint64_t q = m; q > 1u; q >>= 1)
+        if (coords[n - 1] & q) t ^= q - 1u;
+      for (std::size_t i = 0ul; i < n; ++i) coords[i] ^= t;
+    }
+
+    // Interleave the coordinate bits, most significant first
+    std::uint64_t key = 0u;
+    for (unsigned int b = bits; b > 0u; --b)
+      for (std::size_t i = 0ul; i < n; ++i)
+        key = (key << 1) | ((coords[i] >> (b - 1u)) & 1u);
+    return key;
+  }
+
+ public:
+  /// Construct a space-filling-curve map
+
+  /// \param world The world where the tiles will be mapped
+  /// \param extents The extents of the tile index space; tiles are numbered
+  /// in row-major order
+  /// \param curve The curve type
+  SfcPmap(World& world, const std::vector<size_type>& extents,
+          const Curve curve = Curve::Hilbert)
+      : Pmap(world, std::accumulate(extents.begin(), extents.end(),
+                                    size_type(1), std::multiplies<>())) {
+    const std::size_t n = extents.size();
+
+    // The number of bits needed for the largest extent
+    unsigned int bits = 0u;
+    const size_type max_extent =
+        (n ? *std::max_element(extents.begin(), extents.end()) : 0ul);
+    while ((size_type(1) << bits) < max_extent) ++bits;
+    TA_ASSERT(n * bits <= 64u);
+
+    // Order the tiles along the curve
+    std::vector<std::pair<std::uint64_t, size_type>> order;
+    order.reserve(size_);
+    std::vector<std::uint64_t> coords(n);
+    for (size_type tile = 0ul; tile < size_; ++tile) {
+      for (size_type i = n, t = tile; i > 0ul; --i) {
+        coords[i - 1] = t % extents[i - 1];
+        t /= extents[i - 1];
+      }
+      order.emplace_back(curve_key(coords, bits, curve), tile);
+    }
+    std::sort(order.begin(), order.end());
+
+    // Split the curve into contiguous segments, as in BlockedPmap
+    const size_type block_size = size_ / procs_;
+    const size_type remainder = size_ % procs_;
+    owners_.resize(size_);
+    for (size_type i = 0ul, p = 0ul, last = 0ul; i < size_; ++i) {
+      while (i >= last) {
+        last += block_size + (p < remainder ? 1ul : 0ul);
+        ++p;
+      }
+      owners_[order[i].second] = p - 1ul;
+    }
+
+    // Cache the local tiles
+    for (size_type tile = 0ul; tile < size_; ++tile)
+      if (size_type(owners_[tile]) == rank_) local_.push_back(tile);
+    this->local_size_ = local_.size();
+  }
+
+  /// Construct a space-filling-curve map for a tile index space
+
+  /// \param world The world where the tiles will be mapped
+  /// \param range The tile index space, e.g. \c trange.tiles_range()
+  /// \param curve The curve type
+  SfcPmap(World& world, const Range& range, const Curve curve = Curve::Hilbert)
+      : SfcPmap(world,
+                std::vector<size_type>(range.extent().begin(),
+                                       range.extent().end()),
+                curve) {}
+
+  virtual ~SfcPmap() {}
+
+  /// Maps \c tile to the processor that owns it
+
+  /// \param tile The tile to be queried
+  /// \return Processor that logically owns \c tile
+  virtual size_type owner(const size_type tile) const {
+    TA_ASSERT(tile < size_);
+    return owners_[tile];
+  }
+
+  /// Check that the tile is owned by this process
+
+  /// \param tile The tile to be checked
+  /// \return \c true if \c tile is owned by this process, otherwise \c false .
+  virtual bool is_local(const size_type tile) const {
+    return SfcPmap::owner(tile) == rank_;
+  }
+
+};  // class SfcPmap
+
+}  // namespace detail
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_PMAP_SFC_PMAP_H__INCLUDED
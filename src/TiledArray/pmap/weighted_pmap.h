@@ -0,0 +1,199 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  weighted_pmap.h
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_WEIGHTED_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_WEIGHTED_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/pmap.h>
+#include <TiledArray/shape.h>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace TiledArray {
+namespace detail {
+
+/// A cost-weighted process map
+
+/// Map N tiles among P processes such that the total weight (i.e. the
+/// estimated cost) of the tiles of each process is approximately the same.
+/// The tiles are distributed with the longest-processing-time-first (LPT)
+/// heuristic: in order of decreasing weight, each tile is assigned to the
+/// process with the smallest total weight so far (ties are broken by the
+/// number of tiles, then by rank). The maximum weight of any process exceeds
+/// the average by at most the largest tile weight.
+/// \note The weights must be identical on all processes. Unlike the other
+/// process maps, the owners of all tiles are stored, i.e. the memory
+/// requirement is O(N) per process.
+class WeightedPmap : public Pmap {
+ protected:
+  // Import Pmap protected variables
+  using Pmap::local_;  ///< The local tiles
+  using Pmap::procs_;  ///< The number of processes
+  using Pmap::rank_;   ///< The rank of this process
+  using Pmap::size_;   ///< The number of tiles mapped among all processes
+
+ private:
+  std::vector<ProcessID> owners_;  ///< The owner of each tile
+  double local_weight_ = 0.0;      ///< The total weight of the local tiles
+  double max_weight_ = 0.0;  ///< The maximum total weight of any process
+
+  /// Distribute the tiles
+
+  /// \param weights The weights of the tiles
+  void init(const std::vector<double>& weights) {
+    TA_ASSERT(weights.size() == size_);
+
+    // Order the tiles by decreasing weight
+    std::vector<size_type> order(size_);
+    std::iota(order.begin(), order.end(), size_type(0));
+    std::stable_sort(order.begin(), order.end(),
+                     [&weights](const size_type l, const size_type r) {
+                       return weights[l] > weights[r];
+                     });
+
+    // Assign each tile to the least loaded process
+    typedef std::tuple<double, size_type, size_type>
+        load_type;  // {weight, tiles, rank}
+    std::priority_queue<load_type, std::vector<load_type>,
+                        std::greater<load_type>>
+        loads;
+    for (size_type p = 0ul; p < procs_; ++p) loads.emplace(0.0, 0ul, p);
+
+    owners_.resize(size_);
+    for (const auto tile : order) {
+      TA_ASSERT(weights[tile] >= 0.0);
+      auto [weight, tiles, p] = loads.top();
+      loads.pop();
+      owners_[tile] = p;
+      loads.emplace(weight + weights[tile], tiles + 1ul, p);
+    }
+
+    while (!loads.empty()) {
+      const auto [weight, tiles, p] = loads.top();
+      loads.pop();
+      max_weight_ = std::max(max_weight_, weight);
+      if (p == rank_) local_weight_ = weight;
+    }
+
+    // Cache the local tiles
+    for (size_type tile = 0ul; tile < size_; ++tile)
+      if (size_type(owners_[tile]) == rank_) local_.push_back(tile);
+    this->local_size_ = local_.size();
+  }
+
+ public:
+  typedef Pmap::size_type size_type;  ///< Key type
+
+  /// Construct a weighted map from a list of tile weights
+
+  /// \param world The world where the tiles will be mapped
+  /// \param weights The (non-negative) weights of the tiles, i.e.
+  /// \c weights[i] is the cost of tile \c i
+  WeightedPmap(World& world, const std::vector<double>& weights)
+      : Pmap(world, weights.size()) {
+    init(weights);
+  }
+
+  /// Construct a weighted map from a tile weight function
+
+  /// \tparam Op The weight function type
+  /// \param world The world where the tiles will be mapped
+  /// \param size The number of tiles to be mapped
+  /// \param op The weight function, \c op(i) is the (non-negative) cost of
+  /// tile \c i
+  template <typename Op,
+            typename = std::enable_if_t<
+                std::is_invocable_r_v<double, const Op&, size_type>>>
+  WeightedPmap(World& world, const size_type size, const Op& op)
+      : Pmap(world, size) {
+    std::vector<double> weights(size);
+    for (size_type tile = 0ul; tile < size; ++tile) weights[tile] = op(tile);
+    init(weights);
+  }
+
+  /// Construct a weighted map for a block-sparse array
+
+  /// The weight of a tile is its norm estimate, i.e. the (per-element) norm
+  /// of the shape times the tile volume; zero tiles have zero weight. For
+  /// dense shapes the weight of a tile is its volume.
+  /// \tparam TRange The tiled range type
+  /// \tparam Shape The shape type, e.g. SparseShape
+  /// \param world The world where the tiles will be mapped
+  /// \param trange The tiled range of the array
+  /// \param shape The shape of the array
+  template <typename TRange, typename Shape,
+            typename = decltype(std::declval<const TRange&>().tiles_range())>
+  WeightedPmap(World& world, const TRange& trange, const Shape& shape)
+      : Pmap(world, trange.tiles_range().volume()) {
+    std::vector<double> weights(size_, 0.0);
+    if constexpr (is_dense_v<Shape>) {
+      for (size_type tile = 0ul; tile < size_; ++tile)
+        weights[tile] = trange.tile(tile).volume();
+    } else {
+      const auto& norms = shape.data();
+      for (size_type tile = 0ul; tile < size_; ++tile)
+        if (!shape.is_zero(tile))
+          weights[tile] = double(norms[tile]) * trange.tile(tile).volume();
+    }
+    init(weights);
+  }
+
+  virtual ~WeightedPmap() {}
+
+  /// Maps \c tile to the processor that owns it
+
+  /// \param tile The tile to be queried
+  /// \return Processor that logically owns \c tile
+  virtual size_type owner(const size_type tile) const {
+    TA_ASSERT(tile < size_);
+    return owners_[tile];
+  }
+
+  /// Check that the tile is owned by this process
+
+  /// \param tile The tile to be checked
+  /// \return \c true if \c tile is owned by this process, otherwise \c false .
+  virtual bool is_local(const size_type tile) const {
+    return WeightedPmap::owner(tile) == rank_;
+  }
+
+  /// Local weight accessor
+
+  /// \return The total weight of the tiles of this process
+  double local_weight() const { return local_weight_; }
+
+  /// Maximum weight accessor
+
+  /// \return The maximum total weight of the tiles of any process
+  double max_weight() const { return max_weight_; }
+
+};  // class WeightedPmap
+
+}  // namespace detail
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_PMAP_WEIGHTED_PMAP_H__INCLUDED
@@ -21,6 +21,11 @@
 #define TILEDARRAY_REPLICATOR_H__INCLUDED
 
 #include <TiledArray/external/madness.h>
+#include <TiledArray/tile_interface/bytes.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
 
 namespace TiledArray {
 namespace detail {
@@ -28,7 +33,16 @@ namespace detail {
 /// Replicate a \c Array object
 
 /// This object will create a replicated \c Array from a distributed
-/// \c Array.
+/// \c Array. The local tiles of each process are broadcast along a binomial
+/// tree rooted at that process, so every process sends each tile at most
+/// O(log P) times (instead of P-1 times from the owner). The local tiles are
+/// split into chunks of approximately \c chunk_bytes bytes that are broadcast
+/// independently, which pipelines the broadcast of large amounts of data
+/// through the tree. The processes that share a node (as detected with
+/// \c MPI_Comm_split_type ) are grouped, and the tree first spans one process
+/// per node and then the processes within each node, so that every node
+/// receives each tile only once. The replication is complete on a process
+/// once its local tiles have been sent and all remote tiles have been set.
 /// \tparam A The array type
 /// Homeworld = M7R-227
 template <typename A>
@@ -41,16 +55,28 @@ class Replicator : public madness::WorldObject<Replicator<A> >,
   typedef std::stack<madness::CallbackInterface*,
                      std::vector<madness::CallbackInterface*> >
       callback_type;  ///< Callback interface
+  typedef typename A::ordinal_type ordinal_type;  ///< Tile ordinal type
+  typedef typename A::value_type value_type;      ///< Tile type
 
   A destination_;  ///< The replicated array
-  std::vector<typename A::ordinal_type>
-      indices_;  ///< List of local tile indices
-  std::vector<Future<typename A::value_type> > data_;  ///< List of local tiles
-  madness::AtomicInt sent_;  ///< The number of nodes the data has been sent to
+  std::vector<ordinal_type> indices_;  ///< List of local tile indices
+  std::vector<Future<value_type> > data_;  ///< List of local tiles
+  std::size_t chunk_bytes_;  ///< The target size of a broadcast message
+  std::vector<std::vector<ProcessID> > nodes_;  ///< The processes of each node
+  std::vector<ProcessID> node_of_;    ///< The node of each process
+  std::vector<ProcessID> node_rank_;  ///< The index of each process in its node
+  bool sent_;  ///< \c true when the local data has been sent
+  std::size_t expected_;  ///< The number of remote tiles to be received
+  std::size_t received_;  ///< The number of remote tiles received so far
   World& world_;
   volatile callback_type callbacks_;  ///< A callback stack
   volatile mutable bool probe_;       ///< Cache for local data probe
 
+  /// \note Assume object is already locked
+  /// \return \c true when the local tiles have been sent and all remote
+  /// tiles have been set
+  bool complete() const { return sent_ && received_ == expected_; }
+
   /// \note Assume object is already locked
   void do_callbacks() {
     callback_type& callbacks = const_cast<callback_type&>(callbacks_);
@@ -110,11 +136,11 @@ class Replicator : public madness::WorldObject<Replicator<A> >,
     return probe_;
   }
 
-  /// Send data to the next node when it is ready
+  /// Send data to the children when it is ready
   void delay_send() {
     if (probe()) {
       // The data is ready so send it now.
-      send();  // Replication is done
+      send();
     } else {
       // The local data is not ready to be sent, so create a task that will
       // send it when it is ready.
@@ -123,46 +149,182 @@ class Replicator : public madness::WorldObject<Replicator<A> >,
     }
   }
 
-  /// Send all local data to the next node
-  void send() {
-    const long sent = ++sent_;
-    const ProcessID dest = (world_.rank() + sent) % world_.size();
+  // Broadcast tree --------------------------------------------------------
+
+  /// Children of a node of a binomial tree
+
+  /// The parent of node \c v is \c v minus its highest bit, i.e. the
+  /// children of \c v are <tt>v + 2^k</tt> for all <tt>2^k > v</tt>.
+  /// \param v The node, relative to the root (node 0)
+  /// \param n The number of nodes of the tree
+  /// \return The children of \c v , largest subtree first
+  static std::vector<ProcessID> binomial_children(const ProcessID v,
+                                                  const ProcessID n) {
+    std::vector<ProcessID> children;
+    ProcessID mask = 1;
+    while (mask < n) mask <<= 1;
+    for (mask >>= 1; mask > v; mask >>= 1)
+      if (v + mask < n) children.push_back(v + mask);
+    return children;
+  }
 
-    if (dest != world_.rank()) {
-      wobj_type::task(dest, &Replicator_::send_handler, indices_, data_,
+  /// The processes this process forwards the data of \c root to
+
+  /// \param root The process that owns the data
+  /// \return The children of this process in the broadcast tree of \c root
+  std::vector<ProcessID> children(const ProcessID root) const {
+    const ProcessID rank = world_.rank();
+    const ProcessID nodes = nodes_.size();
+    // The index, within each node, of the process that receives the data
+    // from other nodes
+    auto leader = [&](const ProcessID node) -> ProcessID {
+      return node_rank_[root] % ProcessID(nodes_[node].size());
+    };
+
+    std::vector<ProcessID> result;
+
+    // Tree among the node leaders
+    const ProcessID node = node_of_[rank];
+    const ProcessID root_node = node_of_[root];
+    if (node_rank_[rank] == leader(node))
+      for (const auto c :
+           binomial_children((node - root_node + nodes) % nodes, nodes)) {
+        const ProcessID dest = (root_node + c) % nodes;
+        result.push_back(nodes_[dest][leader(dest)]);
+      }
+
+    // Tree within the node of this process
+    const std::vector<ProcessID>& members = nodes_[node];
+    const ProcessID size = members.size();
+    const ProcessID local_leader = leader(node);
+    for (const auto c : binomial_children(
+             (node_rank_[rank] - local_leader + size) % size, size))
+      result.push_back(members[(local_leader + c) % size]);
+
+    return result;
+  }
+
+  /// Group the processes by node
+
+  /// The processes of each node are ordered by rank, and the nodes are
+  /// ordered by the rank of their first process.
+  /// \note This is a collective operation.
+  void init_nodes() {
+    const ProcessID procs = world_.size();
+    const ProcessID rank = world_.rank();
+
+    // The first process of the node of each process
+    std::vector<int> first(procs, 0);
+    if (procs > 1) {
+      auto node_comm = world_.mpi.comm().Split_type(
+          SafeMPI::Intracomm::SHARED_SPLIT_TYPE, 0);
+      int node_first = rank;
+      MPI_Bcast(&node_first, 1, MPI_INT, 0, node_comm.Get_mpi_comm());
+      first[rank] = node_first;
+      world_.gop.sum(first.data(), procs);
+    }
+
+    node_of_.resize(procs);
+    node_rank_.resize(procs);
+    for (ProcessID p = 0; p < procs; ++p) {
+      if (first[p] == p) {
+        node_of_[p] = nodes_.size();
+        nodes_.emplace_back();
+      } else {
+        node_of_[p] = node_of_[first[p]];
+      }
+      node_rank_[p] = nodes_[node_of_[p]].size();
+      nodes_[node_of_[p]].push_back(p);
+    }
+  }
+
+  /// Send the tiles of \c root to the children of this process
+  void forward(const ProcessID root, const std::vector<ordinal_type>& indices,
+               const std::vector<value_type>& data) {
+    for (const auto dest : children(root))
+      wobj_type::task(dest, &Replicator_::send_handler, root, indices, data,
                       madness::TaskAttributes::hipri());
-    } else
-      do_callbacks();  // Replication is done
   }
 
-  void send_handler(const std::vector<typename A::ordinal_type>& indices,
-                    const std::vector<Future<typename A::value_type> >& data) {
-    typename std::vector<typename A::ordinal_type>::const_iterator index_it =
+  /// Broadcast all local data, in chunks
+  void send() {
+    const ProcessID rank = world_.rank();
+    const std::size_t n = data_.size();
+    std::vector<ordinal_type> indices;
+    std::vector<value_type> data;
+    std::size_t bytes = 0ul;
+    for (std::size_t i = 0ul; i < n; ++i) {
+      indices.push_back(indices_[i]);
+      data.push_back(data_[i].get());
+      bytes += tile_bytes(data.back());
+      if (bytes >= chunk_bytes_ || i + 1ul == n) {
+        forward(rank, indices, data);
+        indices.clear();
+        data.clear();
+        bytes = 0ul;
+      }
+    }
+
+    madness::ScopedMutex<madness::Spinlock> locker(this);
+    sent_ = true;
+    if (complete()) do_callbacks();  // Replication is done
+  }
+
+  void send_handler(const ProcessID root,
+                    const std::vector<ordinal_type>& indices,
+                    const std::vector<value_type>& data) {
+    // Pass the data down the tree before storing it
+    forward(root, indices, data);
+
+    typename std::vector<ordinal_type>::const_iterator index_it =
         indices.begin();
-    typename std::vector<Future<typename A::value_type> >::const_iterator
-        data_it = data.begin();
-    typename std::vector<Future<typename A::value_type> >::const_iterator
-        data_end = data.end();
+    typename std::vector<value_type>::const_iterator data_it = data.begin();
+    typename std::vector<value_type>::const_iterator data_end = data.end();
 
     for (; data_it != data_end; ++data_it, ++index_it)
-      destination_.set(*index_it, data_it->get());
+      destination_.set(*index_it, *data_it);
 
-    delay_send();
+    madness::ScopedMutex<madness::Spinlock> locker(this);
+    received_ += data.size();
+    TA_ASSERT(received_ <= expected_);
+    if (complete()) do_callbacks();  // Replication is done
+  }
+
+  // Static variable initialization ----------------------------------------
+
+  /// \return The default chunk size, from \c TA_REPLICATOR_CHUNK_SIZE (in
+  /// bytes; default 8 MiB)
+  static std::size_t init_chunk_bytes() {
+    const char* chunk_bytes = getenv("TA_REPLICATOR_CHUNK_SIZE");
+    if (chunk_bytes) return std::stoul(chunk_bytes);
+    return 8ul << 20;
   }
 
  public:
-  Replicator(const A& source, const A destination)
+  /// Constructor
+
+  /// \param source The distributed array
+  /// \param destination The replicated array
+  /// \param chunk_bytes The target size of the broadcast messages; local
+  /// tiles are sent in chunks of at least one tile
+  /// \note This is a collective operation.
+  Replicator(const A& source, const A destination,
+             const std::size_t chunk_bytes = init_chunk_bytes())
       : wobj_type(source.world()),
         madness::Spinlock(),
         destination_(destination),
         indices_(),
         data_(),
-        sent_(),
+        chunk_bytes_(chunk_bytes),
+        nodes_(),
+        node_of_(),
+        node_rank_(),
+        sent_(false),
+        expected_(0ul),
+        received_(0ul),
         world_(source.world()),
         callbacks_(),
         probe_(false) {
-    sent_ = 0;
-
     // Generate a list of local tiles from other.
     typename A::pmap_interface::const_iterator end = source.pmap()->end();
     typename A::pmap_interface::const_iterator it = source.pmap()->begin();
@@ -185,7 +347,18 @@ class Replicator : public madness::WorldObject<Replicator<A> >,
         }
     }
 
-    /// Send the data to the first node
+    // Count the remote tiles that this process will receive
+    std::size_t nonzero = 0ul;
+    if (source.is_dense())
+      nonzero = source.size();
+    else
+      for (ordinal_type i = 0ul; i < source.size(); ++i)
+        if (!source.is_zero(i)) ++nonzero;
+    expected_ = nonzero - indices_.size();
+
+    init_nodes();
+
+    /// Send the data to the first nodes of the tree
     delay_send();
 
     // Process any pending messages
@@ -194,21 +367,22 @@ class Replicator : public madness::WorldObject<Replicator<A> >,
 
   /// Check that the replication is complete
 
-  /// \return \c true when all data has been transfered.
+  /// \return \c true when the local data has been sent and all remote
+  /// tiles have been set in the destination array
   bool done() {
     madness::ScopedMutex<madness::Spinlock> locker(this);
-    return sent_ == world_.size();
+    return complete();
   }
 
   /// Add a callback
 
-  /// The callback is called when the local data has been sent to all
-  /// nodes. If the data has already been sent to all nodes, the callback
-  /// is notified immediately.
+  /// The callback is called when the local data has been sent and all
+  /// remote tiles have been set. If the replication is already complete, the
+  /// callback is notified immediately.
   /// \param callback The callback object
   void register_callback(madness::CallbackInterface* callback) {
     madness::ScopedMutex<madness::Spinlock> locker(this);
-    if (sent_ == world_.size())
+    if (complete())
       callback->notify();
     else
       const_cast<callback_type&>(callbacks_).push(callback);
@@ -0,0 +1,204 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  subworld.h
+ *
+ */
+
+#ifndef TILEDARRAY_SUBWORLD_H__INCLUDED
+#define TILEDARRAY_SUBWORLD_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace TiledArray {
+
+/// A partition of a world into disjoint sub-worlds
+
+/// The processes of the parent world are split into \c n groups of
+/// consecutive ranks, each of which forms a sub-world. Independent
+/// expressions, e.g. per-k-point or per-irrep contractions, may then be
+/// evaluated concurrently on different sub-worlds, each with a smaller
+/// process grid. Arrays are moved between the parent world and the
+/// sub-worlds with scatter() and gather(), and batches of independent
+/// computations are driven by for_each().
+/// \note The construction and destruction of this object, scatter(),
+/// gather(), and for_each() are collective operations over the parent world.
+class SubWorlds {
+ private:
+  World& parent_;                 ///< The parent world
+  std::size_t size_;              ///< The number of sub-worlds
+  std::size_t color_;             ///< The sub-world of this process
+  std::unique_ptr<World> world_;  ///< The sub-world of this process
+
+  /// \return The sub-world of process \c rank of the parent world
+  std::size_t color_of(const ProcessID rank) const {
+    return std::size_t(rank) * size_ / parent_.size();
+  }
+
+ public:
+  SubWorlds() = delete;
+  SubWorlds(const SubWorlds&) = delete;
+  SubWorlds& operator=(const SubWorlds&) = delete;
+
+  /// Split a world into sub-worlds
+
+  /// \param parent The world to be split
+  /// \param n The number of sub-worlds, <tt>0 < n <= parent.size()</tt>
+  SubWorlds(World& parent, const std::size_t n)
+      : parent_(parent), size_(n), color_(0ul) {
+    TA_ASSERT(n > 0ul);
+    TA_ASSERT(n <= std::size_t(parent.size()));
+    color_ = color_of(parent.rank());
+    parent_.gop.fence();
+    world_ = std::make_unique<World>(
+        parent_.mpi.comm().Split(int(color_), parent_.rank()));
+  }
+
+  ~SubWorlds() {
+    world_->gop.fence();
+    world_.reset();
+    parent_.gop.fence();
+  }
+
+  /// \return The parent world
+  World& parent() const { return parent_; }
+
+  /// \return The sub-world of this process
+  World& world() const { return *world_; }
+
+  /// \return The number of sub-worlds
+  std::size_t size() const { return size_; }
+
+  /// \return The index of the sub-world of this process
+  std::size_t color() const { return color_; }
+
+  /// \param c The index of a sub-world
+  /// \return The rank, in the parent world, of the first process of
+  /// sub-world \c c
+  ProcessID root(const std::size_t c) const {
+    TA_ASSERT(c < size_);
+    return ProcessID((c * parent_.size() + size_ - 1ul) / size_);
+  }
+
+  /// Copy an array of the parent world to the sub-world of this process
+
+  /// Every sub-world receives a complete copy of \c array , distributed
+  /// with the default process map of the sub-world. The tiles are fetched
+  /// directly from their owners in the parent world, grouped by owner.
+  /// \tparam Tile The tile type
+  /// \tparam Policy The policy type
+  /// \param array An array of the parent world
+  /// \return A copy of \c array in the sub-world of this process
+  template <typename Tile, typename Policy>
+  DistArray<Tile, Policy> scatter(const DistArray<Tile, Policy>& array) const {
+    TA_ASSERT(&array.world() == &parent_);
+    typedef typename DistArray<Tile, Policy>::ordinal_type ordinal_type;
+
+    DistArray<Tile, Policy> result(*world_, array.trange(), array.shape());
+    std::vector<ordinal_type> indices;
+    for (const auto i : *result.pmap())
+      if (!result.is_zero(i)) indices.push_back(i);
+    auto tiles = array.find_batch(indices);
+    for (std::size_t j = 0ul; j < indices.size(); ++j)
+      result.set(indices[j], tiles[j]);
+
+    // Wait for the tiles to arrive
+    parent_.gop.fence();
+    return result;
+  }
+
+  /// Copy an array of a sub-world to the parent world
+
+  /// The tiled range and shape of \c array are broadcast from the first
+  /// process of sub-world \c c , and each process of sub-world \c c sends
+  /// its local tiles to their owners in the parent world.
+  /// \tparam Tile The tile type
+  /// \tparam Policy The policy type
+  /// \param array An array of sub-world \c c ; ignored on the processes of
+  /// other sub-worlds
+  /// \param c The index of the sub-world that holds \c array
+  /// \return A copy of \c array in the parent world, distributed with its
+  /// default process map
+  template <typename Tile, typename Policy>
+  DistArray<Tile, Policy> gather(const DistArray<Tile, Policy>& array,
+                                 const std::size_t c) const {
+    TA_ASSERT(c < size_);
+    const bool mine = (c == color_);
+    TA_ASSERT(!mine || &array.world() == world_.get());
+
+    typename DistArray<Tile, Policy>::trange_type trange;
+    typename DistArray<Tile, Policy>::shape_type shape;
+    if (mine) {
+      trange = array.trange();
+      shape = array.shape();
+    }
+    parent_.gop.broadcast_serializable(trange, root(c));
+    parent_.gop.broadcast_serializable(shape, root(c));
+
+    DistArray<Tile, Policy> result(parent_, trange, shape);
+    if (mine) {
+      // Finish the evaluation of array before its tiles are sent
+      world_->gop.fence();
+      for (const auto i : *array.pmap())
+        if (!array.is_zero(i)) result.set(i, array.find_local(i));
+    }
+
+    // Wait for the tiles to arrive
+    parent_.gop.fence();
+    return result;
+  }
+
+  /// Evaluate a batch of independent computations on the sub-worlds
+
+  /// Computation \c t is evaluated on sub-world <tt>t % size()</tt> , i.e.
+  /// the sub-worlds evaluate their computations concurrently, and the
+  /// results are gathered in the parent world.
+  /// \tparam Op The computation type
+  /// \param n The number of computations
+  /// \param op The computation; <tt>op(world, t)</tt> evaluates computation
+  /// \c t in sub-world \c world and returns its result, a DistArray of
+  /// \c world
+  /// \return The results of the computations, in the parent world
+  template <typename Op,
+            typename Array = std::invoke_result_t<Op&, World&, std::size_t>>
+  std::vector<Array> for_each(const std::size_t n, Op&& op) const {
+    std::map<std::size_t, Array> local_results;
+    for (std::size_t t = color_; t < n; t += size_)
+      local_results.emplace(t, op(*world_, t));
+    world_->gop.fence();
+
+    std::vector<Array> results;
+    results.reserve(n);
+    const Array none;
+    for (std::size_t t = 0ul; t < n; ++t) {
+      const auto it = local_results.find(t);
+      results.push_back(
+          gather(it != local_results.end() ? it->second : none, t % size_));
+    }
+    return results;
+  }
+
+};  // class SubWorlds
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_SUBWORLD_H__INCLUDED
@@ -191,6 +191,22 @@ inline ComplexConjugate<ComplexNegTag> ComplexConjugate<void>::operator-()
 template <typename S>
 struct is_numeric<ComplexConjugate<S>> : public std::true_type {};
 
+/// Detect complex conjugation operators
+
+/// Kernels that can conjugate their arguments on the fly (e.g. GEMM via
+/// ConjTranspose) use this to skip the separate conjugation pass.
+/// \tparam S The type to be tested
+template <typename S>
+struct is_complex_conjugate : public std::false_type {};
+
+template <typename S>
+struct is_complex_conjugate<ComplexConjugate<S>> : public std::true_type {};
+
+/// \c is_complex_conjugate_v<S> is an alias for \c
+/// is_complex_conjugate<S>::value
+template <typename S>
+constexpr const bool is_complex_conjugate_v = is_complex_conjugate<S>::value;
+
 /// ComplexConjugate operator factory function
 
 /// \tparam S The scalar type
@@ -28,6 +28,8 @@
 #include "TiledArray/tile_interface/permute.h"
 #include "TiledArray/tile_interface/trace.h"
 #include "TiledArray/util/logger.h"
+#include "TiledArray/util/memory.h"
+
 namespace TiledArray {
 
 // Forward declare Tensor for type traits
@@ -36,6 +38,9 @@ class Tensor;
 
 namespace detail {
 
+template <typename InnerTensor>
+class TensorArena;
+
 /// Signals that we can take the trace of a Tensor<T, A> (for numeric \c T)
 template <typename T, typename A>
 struct TraceIsDefined<Tensor<T, A>, enable_if_numeric_t<T>> : std::true_type {};
@@ -84,6 +89,12 @@ class Tensor {
   template <typename X>
   using numeric_t = typename TiledArray::detail::numeric_type<X>::type;
 
+  /// \c true if norms and inner products of this tensor type can be
+  /// computed by BLAS (see math::blas::dotc )
+  static constexpr bool blas_reducible =
+      std::is_same_v<value_type, numeric_type> &&
+      std::is_floating_point_v<scalar_type>;
+
   /// Evaluation tensor
 
   /// This tensor is used as an evaluated intermediate for other tensors.
@@ -99,7 +110,7 @@ class Tensor {
     /// \param range The N-dimensional range for this tensor
     explicit Impl(const range_type& range)
         : allocator_type(), range_(range), data_(NULL) {
-      data_ = allocator_type::allocate(range.volume());
+      data_ = allocate(range.volume());
     }
 
     /// Construct with rvalue range
@@ -107,18 +118,50 @@ class Tensor {
     /// \param range The N-dimensional range for this tensor
     explicit Impl(range_type&& range)
         : allocator_type(), range_(range), data_(NULL) {
-      data_ = allocator_type::allocate(range.volume());
+      data_ = allocate(range.volume());
     }
 
+    /// Construct a view of externally-owned data
+
+    /// \param range The N-dimensional range for this tensor
+    /// \param data The tensor data; it is neither constructed nor
+    /// destroyed by this object
+    Impl(range_type range, pointer data)
+        : allocator_type(),
+          range_(std::move(range)),
+          data_(data),
+          owns_data_(false) {}
+
     ~Impl() {
-      math::destroy_vector(range_.volume(), data_);
-      allocator_type::deallocate(data_, range_.volume());
+      if (owns_data_) {
+        math::destroy_vector(range_.volume(), data_);
+        deallocate(data_, range_.volume());
+      }
       data_ = NULL;
     }
 
-    range_type range_;  ///< Tensor size info
-    pointer data_;      ///< Tensor data
-  };                    // class Impl
+    /// Allocate the data of \c n elements, and account for it (see
+    /// tensor_bytes() )
+    pointer allocate(const std::size_t n) {
+      pointer result = allocator_type::allocate(n);
+      detail::memory_tracker().allocated(n * sizeof(value_type));
+      return result;
+    }
+
+    /// Deallocate the data of \c n elements allocated by allocate()
+    void deallocate(pointer p, const std::size_t n) {
+      if (!p) return;
+      allocator_type::deallocate(p, n);
+      detail::memory_tracker().deallocated(n * sizeof(value_type));
+    }
+
+    range_type range_;        ///< Tensor size info
+    pointer data_;            ///< Tensor data
+    bool owns_data_ = true;  ///< If false, \c data_ is owned elsewhere
+  };                          // class Impl
+
+  template <typename InnerTensor>
+  friend class detail::TensorArena;
 
   template <typename... Ts>
   struct is_tensor {
@@ -213,6 +256,19 @@ class Tensor {
   Tensor(const Range& range, std::initializer_list<T> il)
       : Tensor(range, il.begin()) {}
 
+  /// Construct a view of externally-owned data
+
+  /// The tensor refers to \c data , i.e. the elements are neither copied
+  /// nor destroyed by the tensor. \c owner is kept alive as long as the
+  /// tensor (or any shallow copy of it) exists.
+  /// \param range The range of the tensor
+  /// \param data The tensor data, which holds \c range.volume() elements
+  /// \param owner The object that owns \c data
+  Tensor(const range_type& range, pointer data,
+         std::shared_ptr<const void> owner)
+      : pimpl_(new Impl(range, data),
+               [owner = std::move(owner)](Impl* impl) { delete impl; }) {}
+
   /// Construct a copy of a tensor interface object
 
   /// \tparam T1 A tensor type
@@ -652,17 +708,32 @@ class Tensor {
       std::shared_ptr<Impl> temp = std::make_shared<Impl>();
       temp->data_ = temp->allocate(n);
       try {
-        // need to construct elements of data_ using placement new in case its
-        // default ctor is not trivial N.B. for fundamental types and standard
-        // alloc this incurs no overhead (Eigen::aligned_alloc OK also)
-        auto* data_ptr = temp->data_;
-        for (ordinal_type i = 0; i != n; ++i, ++data_ptr)
-          new (static_cast<void*>(data_ptr)) value_type;
-
-        ar& madness::archive::wrap(temp->data_, n);
+        if constexpr (detail::is_ta_tensor_v<value_type> &&
+                      detail::is_scalar_v<typename value_type::value_type>) {
+          // tensor of tensors: each inner tensor is stored as its volume,
+          // data, and range (see the output serialization function); the
+          // inner data is read directly into a single arena (see
+          // detail::TensorArena::load ), so that the inner tensors cost O(1)
+          // allocations
+          auto arena = detail::TensorArena<value_type>::load(ar, n);
+          auto* data_ptr = temp->data_;
+          for (ordinal_type i = 0; i != n; ++i, ++data_ptr)
+            new (static_cast<void*>(data_ptr)) value_type(arena->tensor(i));
+        } else {
+          // need to construct elements of data_ using placement new in case
+          // its default ctor is not trivial N.B. for fundamental types and
+          // standard alloc this incurs no overhead (Eigen::aligned_alloc OK
+          // also)
+          auto* data_ptr = temp->data_;
+          for (ordinal_type i = 0; i != n; ++i, ++data_ptr)
+            new (static_cast<void*>(data_ptr)) value_type;
+
+          ar& madness::archive::wrap(temp->data_, n);
+        }
         ar & temp->range_;
       } catch (...) {
         temp->deallocate(temp->data_, n);
+        temp->data_ = NULL;
         throw;
       }
 
@@ -1879,6 +1950,161 @@ class Tensor {
     return *this;
   }
 
+  /// Contract two permuted tensors and accumulate the scaled result to this
+  /// tensor
+
+  /// Computes the same result as
+  /// \code
+  ///   this->gemm(left_perm * left, right_perm * right, factor, gemm_helper);
+  /// \endcode
+  /// but reads the arguments in place with their own strides, i.e. without
+  /// materializing the permuted arguments. The loops are driven by
+  /// precomputed offset tables, hence this is only competitive with the
+  /// transpose-transpose-GEMM-transpose (TTGT) approach for small tensors,
+  /// where the cost of the permutations dominates the cost of the GEMM.
+  /// \tparam U The left-hand tensor element type
+  /// \tparam AU The left-hand tensor allocator type
+  /// \tparam V The right-hand tensor element type
+  /// \tparam AV The right-hand tensor allocator type
+  /// \tparam W The type of the scaling factor
+  /// \param left The left-hand tensor that will be contracted
+  /// \param right The right-hand tensor that will be contracted
+  /// \param factor The contraction result will be scaling by this value, then
+  /// accumulated into \c this
+  /// \param gemm_helper The *GEMM operation meta data, which refers to the
+  /// permuted arguments
+  /// \param left_perm The permutation that maps \p left to the layout
+  /// expected by \p gemm_helper (empty = no permutation)
+  /// \param right_perm The permutation that maps \p right to the layout
+  /// expected by \p gemm_helper (empty = no permutation)
+  /// \return A reference to \c this
+  /// \note if this is uninitialized, i.e., if \c this->empty()==true , it is
+  /// initialized to zero first
+  template <typename U, typename AU, typename V, typename AV, typename W,
+            typename = std::enable_if_t<detail::is_numeric_v<W>>>
+  Tensor_& gemm(const Tensor<U, AU>& left, const Tensor<V, AV>& right,
+                const W factor, const math::GemmHelper& gemm_helper,
+                const Permutation& left_perm, const Permutation& right_perm) {
+    static_assert(
+        !detail::is_tensor_of_tensor_v<Tensor_, Tensor<U, AU>, Tensor<V, AV>>,
+        "TA::Tensor<T>::gemm without custom element op is only applicable to "
+        "plain tensors");
+
+    // Check that the arguments are not empty and have the correct ranks
+    TA_ASSERT(!left.empty());
+    TA_ASSERT(left.range().rank() == gemm_helper.left_rank());
+    TA_ASSERT(!right.empty());
+    TA_ASSERT(right.range().rank() == gemm_helper.right_rank());
+    TA_ASSERT(!left_perm || left_perm.size() == gemm_helper.left_rank());
+    TA_ASSERT(!right_perm || right_perm.size() == gemm_helper.right_rank());
+
+    const range_type left_range =
+        (left_perm ? left_perm * left.range() : left.range());
+    const range_type right_range =
+        (right_perm ? right_perm * right.range() : right.range());
+
+    // Check that the inner dimensions of left and right match
+    TA_ASSERT(ignore_tile_position() ||
+              gemm_helper.left_right_congruent(left_range.lobound_data(),
+                                               right_range.lobound_data()));
+    TA_ASSERT(ignore_tile_position() ||
+              gemm_helper.left_right_congruent(left_range.upbound_data(),
+                                               right_range.upbound_data()));
+    TA_ASSERT(gemm_helper.left_right_congruent(left_range.extent_data(),
+                                               right_range.extent_data()));
+
+    if (this->empty()) {  // initialize, if empty
+      *this = Tensor_(
+          gemm_helper.make_result_range<range_type>(left_range, right_range),
+          numeric_type(0));
+    } else {
+      TA_ASSERT(pimpl_->range_.rank() == gemm_helper.result_rank());
+      TA_ASSERT(gemm_helper.left_result_congruent(
+          left_range.extent_data(), pimpl_->range_.extent_data()));
+      TA_ASSERT(gemm_helper.right_result_congruent(
+          right_range.extent_data(), pimpl_->range_.extent_data()));
+    }
+
+    // Gather the extents and strides of the (virtually) permuted argument,
+    // i.e. dimension perm[d] of the permuted tensor is dimension d of arg
+    auto strided_dims = [](const range_type& range, const Permutation& perm) {
+      const auto rank = range.rank();
+      std::vector<std::pair<ordinal_type, ordinal_type>> dims(rank);
+      for (unsigned int d = 0u; d < rank; ++d)
+        dims[perm ? perm[d] : d] = {range.extent(d), range.stride(d)};
+      return dims;
+    };
+    // Compute the offsets of the elements of the subspace spanned by
+    // dims [first, last), enumerated in row-major order
+    auto make_offsets =
+        [](const std::vector<std::pair<ordinal_type, ordinal_type>>& dims,
+           const unsigned int first, const unsigned int last) {
+          std::vector<ordinal_type> offsets(1, 0);
+          for (unsigned int d = first; d < last; ++d) {
+            const auto [extent, stride] = dims[d];
+            std::vector<ordinal_type> next;
+            next.reserve(offsets.size() * extent);
+            for (const auto offset : offsets)
+              for (ordinal_type i = 0; i < extent; ++i)
+                next.push_back(offset + i * stride);
+            offsets = std::move(next);
+          }
+          return offsets;
+        };
+
+    const auto left_dims = strided_dims(left.range(), left_perm);
+    const auto right_dims = strided_dims(right.range(), right_perm);
+    // the outer (free) index space of left (M) and right (N) and the inner
+    // (contracted) index space (K), as seen from each argument
+    const auto left_m = make_offsets(left_dims, gemm_helper.left_outer_begin(),
+                                     gemm_helper.left_outer_end());
+    const auto left_k = make_offsets(left_dims, gemm_helper.left_inner_begin(),
+                                     gemm_helper.left_inner_end());
+    const auto right_k =
+        make_offsets(right_dims, gemm_helper.right_inner_begin(),
+                     gemm_helper.right_inner_end());
+    const auto right_n =
+        make_offsets(right_dims, gemm_helper.right_outer_begin(),
+                     gemm_helper.right_outer_end());
+    TA_ASSERT(left_k.size() == right_k.size());
+
+    const auto m = left_m.size();
+    const auto n = right_n.size();
+    const auto k = left_k.size();
+    const auto* MADNESS_RESTRICT const a = left.data();
+    const auto* MADNESS_RESTRICT const b = right.data();
+    auto* MADNESS_RESTRICT const c = pimpl_->data_;
+    // ConjTranspose arguments are conjugated on the fly
+    auto contract = [&](auto conj_left, auto conj_right) {
+      for (std::size_t i = 0ul; i < m; ++i) {
+        const auto* MADNESS_RESTRICT const a_i = a + left_m[i];
+        auto* MADNESS_RESTRICT const c_i = c + i * n;
+        for (std::size_t l = 0ul; l < k; ++l) {
+          const numeric_type a_il =
+              factor * (conj_left ? detail::conj(a_i[left_k[l]])
+                                  : a_i[left_k[l]]);
+          const auto* MADNESS_RESTRICT const b_l = b + right_k[l];
+          for (std::size_t j = 0ul; j < n; ++j)
+            c_i[j] += a_il * (conj_right ? detail::conj(b_l[right_n[j]])
+                                         : b_l[right_n[j]]);
+        }
+      }
+    };
+    const bool conj_left = gemm_helper.left_op() == math::blas::ConjTranspose;
+    const bool conj_right =
+        gemm_helper.right_op() == math::blas::ConjTranspose;
+    if (conj_left && conj_right)
+      contract(std::true_type{}, std::true_type{});
+    else if (conj_left)
+      contract(std::true_type{}, std::false_type{});
+    else if (conj_right)
+      contract(std::false_type{}, std::true_type{});
+    else
+      contract(std::false_type{}, std::false_type{});
+
+    return *this;
+  }
+
   template <typename U, typename AU, typename V, typename AV,
             typename ElementMultiplyAddOp,
             typename = std::enable_if_t<std::is_invocable_r_v<
@@ -1962,6 +2188,189 @@ class Tensor {
     return *this;
   }
 
+  /// Contract two tensors of tensors whose elements are contracted via GEMM
+
+  /// This computes the same result as
+  /// \code
+  ///   gemm(left, right, gemm_helper,
+  ///        [&](auto& result, const auto& left, const auto& right) {
+  ///          if (result.empty())
+  ///            result = left.gemm(right, inner_factor, inner_gemm_helper);
+  ///          else
+  ///            result.gemm(left, right, inner_factor, inner_gemm_helper);
+  ///        });
+  /// \endcode
+  /// but, rather than executing one small GEMM per element multiply-add, the
+  /// element GEMMs that contribute to distinct result elements are grouped
+  /// into batched GEMM calls (see math::blas::gemm_batch). Runs of
+  /// uniformly-sized elements whose data is equally spaced in memory (e.g.
+  /// elements stored contiguously, see make_contiguous_tensor_of_tensor) are
+  /// dispatched as strided batches.
+  /// \tparam U The left-hand tensor element type
+  /// \tparam AU The left-hand tensor allocator type
+  /// \tparam V The right-hand tensor element type
+  /// \tparam AV The right-hand tensor allocator type
+  /// \tparam W The type of the scaling factor
+  /// \param left The left-hand tensor that will be contracted
+  /// \param right The right-hand tensor that will be contracted
+  /// \param gemm_helper The *GEMM operation meta data for the (outer) tensors
+  /// \param inner_factor The scaling factor of the element contractions
+  /// \param inner_gemm_helper The *GEMM operation meta data for the elements
+  /// \return A reference to \c this
+  /// \note elements of \p left or \p right that are empty do not contribute
+  template <typename U, typename AU, typename V, typename AV, typename W,
+            typename = std::enable_if_t<
+                detail::is_tensor_of_tensor_v<Tensor_, Tensor<U, AU>,
+                                              Tensor<V, AV>> &&
+                detail::is_numeric_v<W>>>
+  Tensor_& gemm(const Tensor<U, AU>& left, const Tensor<V, AV>& right,
+                const math::GemmHelper& gemm_helper, const W inner_factor,
+                const math::GemmHelper& inner_gemm_helper) {
+    // Check that the arguments are not empty and have the correct ranks
+    TA_ASSERT(!left.empty());
+    TA_ASSERT(left.range().rank() == gemm_helper.left_rank());
+    TA_ASSERT(!right.empty());
+    TA_ASSERT(right.range().rank() == gemm_helper.right_rank());
+
+    // Check that the inner dimensions of left and right match
+    TA_ASSERT(gemm_helper.left_right_congruent(left.range().extent_data(),
+                                               right.range().extent_data()));
+
+    if (this->empty()) {  // initialize, if empty
+      *this = Tensor_(gemm_helper.make_result_range<range_type>(left.range(),
+                                                                right.range()));
+    } else {
+      TA_ASSERT(gemm_helper.left_result_congruent(
+          left.range().extent_data(), pimpl_->range_.extent_data()));
+      TA_ASSERT(gemm_helper.right_result_congruent(
+          right.range().extent_data(), pimpl_->range_.extent_data()));
+    }
+
+    // Compute gemm dimensions
+    using integer = TiledArray::math::blas::integer;
+    integer M, N, K;
+    gemm_helper.compute_matrix_sizes(M, N, K, left.range(), right.range());
+
+    // Get the leading dimension for left and right matrices.
+    const integer lda =
+        (gemm_helper.left_op() == TiledArray::math::blas::NoTranspose ? K : M);
+    const integer ldb =
+        (gemm_helper.right_op() == TiledArray::math::blas::NoTranspose ? N : K);
+
+    using inner_numeric_type = typename value_type::numeric_type;
+    using left_numeric_type = typename U::numeric_type;
+    using right_numeric_type = typename V::numeric_type;
+
+    // One batch entry: the element GEMM dimensions and data
+    struct Entry {
+      integer m, n, k;
+      const left_numeric_type* a;
+      const right_numeric_type* b;
+      inner_numeric_type* c;
+    };
+    std::vector<Entry> batch;
+    batch.reserve(M * N);
+    std::vector<const left_numeric_type*> a_ptrs;
+    std::vector<const right_numeric_type*> b_ptrs;
+    std::vector<inner_numeric_type*> c_ptrs;
+
+    const auto inner_left_op = inner_gemm_helper.left_op();
+    const auto inner_right_op = inner_gemm_helper.right_op();
+
+    // Dispatch batch[first, last), whose elements have uniform sizes
+    auto dispatch = [&](const std::size_t first, const std::size_t last) {
+      const auto& e = batch[first];
+      const integer inner_lda =
+          (inner_left_op == TiledArray::math::blas::NoTranspose ? e.k : e.m);
+      const integer inner_ldb =
+          (inner_right_op == TiledArray::math::blas::NoTranspose ? e.n : e.k);
+      const integer batch_size = last - first;
+      if (batch_size == 1) {
+        math::blas::gemm(inner_left_op, inner_right_op, e.m, e.n, e.k,
+                         inner_factor, e.a, inner_lda, e.b, inner_ldb,
+                         inner_numeric_type(1), e.c, e.n);
+        return;
+      }
+
+      // use strided layout if the data of the elements is equally spaced
+      const auto stride_a = batch[first + 1].a - e.a;
+      const auto stride_b = batch[first + 1].b - e.b;
+      const auto stride_c = batch[first + 1].c - e.c;
+      bool strided = stride_a >= 0 && stride_b >= 0 && stride_c >= e.m * e.n;
+      for (std::size_t i = first + 2; strided && i < last; ++i) {
+        strided = (batch[i].a - batch[i - 1].a == stride_a) &&
+                  (batch[i].b - batch[i - 1].b == stride_b) &&
+                  (batch[i].c - batch[i - 1].c == stride_c);
+      }
+      if (strided) {
+        math::blas::gemm_batch_strided(
+            inner_left_op, inner_right_op, e.m, e.n, e.k, inner_factor, e.a,
+            inner_lda, stride_a, e.b, inner_ldb, stride_b,
+            inner_numeric_type(1), e.c, e.n, stride_c, batch_size);
+      } else {
+        a_ptrs.clear();
+        b_ptrs.clear();
+        c_ptrs.clear();
+        for (std::size_t i = first; i < last; ++i) {
+          a_ptrs.push_back(batch[i].a);
+          b_ptrs.push_back(batch[i].b);
+          c_ptrs.push_back(batch[i].c);
+        }
+        math::blas::gemm_batch(inner_left_op, inner_right_op, e.m, e.n, e.k,
+                               inner_factor, a_ptrs.data(), inner_lda,
+                               b_ptrs.data(), inner_ldb, inner_numeric_type(1),
+                               c_ptrs.data(), e.n, batch_size);
+      }
+    };
+
+    // The element GEMMs that contribute to distinct result elements are
+    // independent, hence batch over the result elements, one k at a time
+    for (integer k = 0; k != K; ++k) {
+      batch.clear();
+      for (integer m = 0; m != M; ++m) {
+        const auto& a =
+            *(left.data() +
+              (gemm_helper.left_op() == TiledArray::math::blas::NoTranspose
+                   ? m * lda + k
+                   : k * lda + m));
+        if (a.empty()) continue;
+        for (integer n = 0; n != N; ++n) {
+          const auto& b =
+              *(right.data() +
+                (gemm_helper.right_op() == TiledArray::math::blas::NoTranspose
+                     ? k * ldb + n
+                     : n * ldb + k));
+          if (b.empty()) continue;
+          auto& c = *(pimpl_->data_ + m * N + n);
+          if (c.empty())
+            c = value_type(inner_gemm_helper.make_result_range<
+                               typename value_type::range_type>(a.range(),
+                                                                b.range()),
+                           inner_numeric_type(0));
+          Entry e;
+          inner_gemm_helper.compute_matrix_sizes(e.m, e.n, e.k, a.range(),
+                                                 b.range());
+          e.a = a.data();
+          e.b = b.data();
+          e.c = c.data();
+          batch.push_back(e);
+        }
+      }
+
+      // dispatch runs of uniformly-sized entries
+      std::size_t first = 0;
+      for (std::size_t i = 1; i <= batch.size(); ++i) {
+        if (i == batch.size() || batch[i].m != batch[first].m ||
+            batch[i].n != batch[first].n || batch[i].k != batch[first].k) {
+          if (i != first) dispatch(first, i);
+          first = i;
+        }
+      }
+    }
+
+    return *this;
+  }
+
   // Reduction operations
 
   /// Generalized tensor trace
@@ -2046,6 +2455,12 @@ class Tensor {
 
   /// \return The vector norm of this tensor
   scalar_type squared_norm() const {
+    if constexpr (blas_reducible) {
+      // the conjugated dot product, i.e. ||x||^2 = x^H x
+      if (!this->empty())
+        return std::real(math::blas::dotc(this->size(), this->data(),
+                                          this->data()));
+    }
     auto square_op = [](scalar_type& MADNESS_RESTRICT res,
                         const numeric_type arg) {
       res += TiledArray::detail::norm(arg);
@@ -2145,6 +2560,13 @@ class Tensor {
   template <typename Right,
             typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
   numeric_type inner_product(const Right& other) const {
+    if constexpr (blas_reducible && std::is_same_v<Right, Tensor_>) {
+      // the conjugated dot product, i.e. x^H y
+      if (!this->empty() && !other.empty()) {
+        TA_ASSERT(detail::is_range_congruent(*this, other));
+        return math::blas::dotc(this->size(), this->data(), other.data());
+      }
+    }
     auto mult_add_op = [](numeric_type& res, const numeric_type l,
                           const numeric_t<Right> r) {
       res += TiledArray::detail::inner_product(l, r);
@@ -2171,6 +2593,216 @@ bool operator!=(const Tensor<T, A>& a, const Tensor<T, A>& b) {
 
 namespace detail {
 
+/// Contiguous storage for the inner tensors of a tensor of tensors
+
+/// The data of all inner tensors is packed, in order, into a single buffer,
+/// and the implementation objects of the inner tensors are kept in a table
+/// owned by the arena. Inner tensors refer to the arena via aliasing shared
+/// pointers, hence creating a tile with \c n inner tensors costs O(1) heap
+/// allocations instead of O(n), and the inner data has ideal locality. The
+/// arena stays alive as long as any of its inner tensors does.
+/// \tparam InnerTensor the inner tensor type, must be a TA::Tensor
+template <typename InnerTensor>
+class TensorArena {
+  static_assert(is_ta_tensor_v<InnerTensor>,
+                "TensorArena<InnerTensor>: InnerTensor must be a TA::Tensor");
+
+ public:
+  typedef TensorArena<InnerTensor> TensorArena_;  ///< This class type
+  typedef InnerTensor inner_type;                   ///< Inner tensor type
+  typedef typename inner_type::range_type range_type;  ///< Inner range type
+  typedef typename inner_type::ordinal_type ordinal_type;  ///< Ordinal type
+  typedef typename inner_type::value_type value_type;  ///< Element type
+  typedef typename inner_type::allocator_type
+      allocator_type;                             ///< Allocator type
+  typedef typename inner_type::pointer pointer;  ///< Element pointer type
+
+ private:
+  typedef typename inner_type::Impl impl_type;
+
+  allocator_type allocator_;         ///< Allocator for \c data_
+  std::vector<impl_type> impls_;     ///< Inner tensor implementation objects
+  std::vector<ordinal_type> offsets_;  ///< Offsets of the inner tensors'
+                                       ///< data in \c data_
+  pointer data_ = nullptr;             ///< The inner tensors' data
+  ordinal_type capacity_ = 0;          ///< The number of elements allocated
+                                       ///< at \c data_
+  std::weak_ptr<TensorArena_> self_;   ///< Used to share ownership of this
+
+ public:
+  TensorArena() = delete;
+  TensorArena(const TensorArena_&) = delete;
+  TensorArena_& operator=(const TensorArena_&) = delete;
+
+  /// Construct an arena for \c n inner tensors
+
+  /// \tparam RangeOp callable with signature `range_type(ordinal_type)`
+  /// \param n The number of inner tensors
+  /// \param range_op Returns the range of the inner tensor with a given
+  /// ordinal; a default-constructed (rank-0) range denotes an empty inner
+  /// tensor
+  /// \note the inner data is uninitialized (for scalar element types)
+  template <typename RangeOp>
+  TensorArena(const ordinal_type n, RangeOp&& range_op)
+      : allocator_(), impls_(), offsets_(n + 1, 0) {
+    impls_.reserve(n);
+    for (ordinal_type i = 0; i != n; ++i) {
+      impls_.emplace_back(range_op(i), pointer(NULL));
+      offsets_[i + 1] = offsets_[i] + impls_.back().range_.volume();
+    }
+    const auto volume = offsets_.back();
+    if (volume) {
+      data_ = allocator_.allocate(volume);
+      capacity_ = volume;
+      memory_tracker().allocated(volume * sizeof(value_type));
+      if constexpr (!is_scalar_v<value_type>)
+        math::uninitialized_fill_vector(volume, value_type(), data_);
+    }
+    for (ordinal_type i = 0; i != n; ++i)
+      impls_[i].data_ = data_ + offsets_[i];
+  }
+
+  /// Construct an arena that adopts the data of its inner tensors
+
+  /// \param ranges The ranges of the inner tensors; a default-constructed
+  /// (rank-0) range denotes an empty inner tensor
+  /// \param data The data of the inner tensors, packed in order, allocated
+  /// with \c allocator_type and accounted for (see tensor_bytes() ); the
+  /// arena takes ownership of it
+  /// \param capacity The number of elements allocated at \c data
+  TensorArena(std::vector<range_type>&& ranges, const pointer data,
+              const ordinal_type capacity)
+      : allocator_(),
+        impls_(),
+        offsets_(ranges.size() + 1, 0),
+        data_(data),
+        capacity_(capacity) {
+    static_assert(is_scalar_v<value_type>,
+                  "TensorArena: only arenas of scalars can adopt data");
+    const ordinal_type n = ranges.size();
+    impls_.reserve(n);
+    for (ordinal_type i = 0; i != n; ++i) {
+      impls_.emplace_back(std::move(ranges[i]), pointer(NULL));
+      offsets_[i + 1] = offsets_[i] + impls_.back().range_.volume();
+      impls_.back().data_ = data_ + offsets_[i];
+    }
+    TA_ASSERT(offsets_.back() <= capacity_);
+  }
+
+  ~TensorArena() {
+    if (data_) {
+      math::destroy_vector(offsets_.back(), data_);
+      allocator_.deallocate(data_, capacity_);
+      memory_tracker().deallocated(capacity_ * sizeof(value_type));
+      data_ = nullptr;
+    }
+  }
+
+  /// Arena factory
+
+  /// \tparam RangeOp callable with signature `range_type(ordinal_type)`
+  /// \param n The number of inner tensors
+  /// \param range_op Returns the range of the inner tensor with a given
+  /// ordinal
+  /// \return A shared pointer to a new arena
+  template <typename RangeOp>
+  static std::shared_ptr<TensorArena_> make(const ordinal_type n,
+                                            RangeOp&& range_op) {
+    auto result = std::make_shared<TensorArena_>(
+        n, std::forward<RangeOp>(range_op));
+    result->self_ = result;
+    return result;
+  }
+
+  /// Read \c n inner tensors, each stored as its volume, data and range
+  /// (see Tensor::serialize() ), directly into a new arena
+
+  /// The buffer is sized assuming that the inner tensors that remain to be
+  /// read are as large as the current one; it only grows, and its contents
+  /// are moved, if that assumption fails.
+  /// \tparam Archive The input archive type
+  /// \param ar The input archive
+  /// \param n The number of inner tensors
+  /// \return A shared pointer to a new arena
+  template <typename Archive>
+  static std::shared_ptr<TensorArena_> load(Archive& ar,
+                                            const ordinal_type n) {
+    static_assert(is_scalar_v<value_type>,
+                  "TensorArena::load: only arenas of scalars can be loaded");
+    allocator_type allocator;
+    std::vector<range_type> ranges(n);
+    pointer data = nullptr;
+    ordinal_type capacity = 0, volume = 0;
+    try {
+      for (ordinal_type i = 0; i != n; ++i) {
+        ordinal_type inner_n = 0ul;
+        ar& inner_n;
+        if (!inner_n) continue;
+        if (volume + inner_n > capacity) {
+          const ordinal_type new_capacity =
+              std::max(volume + inner_n * (n - i), 2 * capacity);
+          pointer new_data = allocator.allocate(new_capacity);
+          memory_tracker().allocated(new_capacity * sizeof(value_type));
+          if (data) {
+            std::copy_n(data, volume, new_data);
+            allocator.deallocate(data, capacity);
+            memory_tracker().deallocated(capacity * sizeof(value_type));
+          }
+          data = new_data;
+          capacity = new_capacity;
+        }
+        ar& madness::archive::wrap(data + volume, inner_n);
+        ar& ranges[i];
+        volume += inner_n;
+      }
+    } catch (...) {
+      if (data) {
+        allocator.deallocate(data, capacity);
+        memory_tracker().deallocated(capacity * sizeof(value_type));
+      }
+      throw;
+    }
+    auto result =
+        std::make_shared<TensorArena_>(std::move(ranges), data, capacity);
+    result->self_ = result;
+    return result;
+  }
+
+  /// \return The number of inner tensors in this arena
+  ordinal_type ntensors() const { return impls_.size(); }
+
+  /// \return The total number of elements held by this arena
+  ordinal_type volume() const { return offsets_.back(); }
+
+  /// \return A pointer to the data of the first inner tensor
+  pointer data() const { return data_; }
+
+  /// \param i An inner tensor ordinal
+  /// \return The offset of the data of inner tensor \c i in \c data()
+  ordinal_type offset(const ordinal_type i) const {
+    TA_ASSERT(i < ntensors());
+    return offsets_[i];
+  }
+
+  /// Inner tensor accessor
+
+  /// \param i An inner tensor ordinal
+  /// \return A shallow tensor object that refers to the data of inner tensor
+  /// \c i , or an empty tensor if the range of inner tensor \c i is rank-0
+  /// \note must be created via TensorArena::make
+  inner_type tensor(const ordinal_type i) {
+    TA_ASSERT(i < ntensors());
+    inner_type result;
+    if (impls_[i].range_.rank() != 0u) {
+      auto self = self_.lock();
+      TA_ASSERT(self);
+      result.pimpl_ = std::shared_ptr<impl_type>(std::move(self), &impls_[i]);
+    }
+    return result;
+  }
+
+};  // class TensorArena
+
 /// Implements taking the trace of a Tensor<T> (\c T is a numeric type)
 ///
 /// \tparam T The type of the elements in the tensor. For this specialization
@@ -2245,6 +2877,35 @@ struct transform<Tensor<T, A>> {
 };
 }  // namespace detail
 
+/// Construct a tensor of tensors with contiguous inner storage
+
+/// The data of all inner tensors of the result is stored contiguously in a
+/// single arena (see detail::TensorArena), thus creating the tile costs O(1)
+/// heap allocations irrespective of the number of inner tensors. The result
+/// is an ordinary tensor of tensors, i.e. it can be used with all tile
+/// operations.
+/// \tparam ToT A tensor of tensors type whose elements are TA::Tensor
+/// \tparam InnerRangeOp A callable with signature `Range(ordinal_type)`
+/// \param range The (outer) range of the result
+/// \param inner_range_op Returns the range of the inner tensor at a given
+/// ordinal of \p range ; a default-constructed (rank-0) range denotes an empty
+/// inner tensor
+/// \return A tensor of tensors whose inner data is uninitialized
+template <typename ToT, typename InnerRangeOp,
+          typename = std::enable_if_t<
+              detail::is_ta_tensor_v<ToT> &&
+              detail::is_ta_tensor_v<typename ToT::value_type>>>
+ToT make_contiguous_tensor_of_tensor(const Range& range,
+                                     InnerRangeOp&& inner_range_op) {
+  using ordinal_type = typename ToT::ordinal_type;
+  ToT result(range);
+  const ordinal_type n = range.volume();
+  auto arena = detail::TensorArena<typename ToT::value_type>::make(
+      n, std::forward<InnerRangeOp>(inner_range_op));
+  for (ordinal_type i = 0; i != n; ++i) result.data()[i] = arena->tensor(i);
+  return result;
+}
+
 #ifndef TILEDARRAY_HEADER_ONLY
 
 extern template class Tensor<double, Eigen::aligned_allocator<double>>;
@@ -82,6 +82,22 @@ class TensorImpl : private NO_DEFAULTS {
   /// Virtual destructor
   virtual ~TensorImpl() {}
 
+ protected:
+  /// Reset the process map
+
+  /// Only the process map is replaced; the derived class is responsible for
+  /// moving the tiles to their new owners.
+  /// \param pmap The new tile-process map
+  void pmap(const std::shared_ptr<pmap_interface>& pmap) {
+    TA_ASSERT(pmap);
+    TA_ASSERT(pmap->size() == pmap_->size());
+    TA_ASSERT(pmap->rank() == pmap_->rank());
+    TA_ASSERT(pmap->procs() == pmap_->procs());
+    pmap_ = pmap;
+  }
+
+ public:
+
   /// Tensor process map accessor
 
   /// \return A shared pointer to the process map of this tensor
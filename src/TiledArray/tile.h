@@ -21,6 +21,7 @@
 #define TILEDARRAY_TILE_H__INCLUDED
 
 #include <TiledArray/tensor/tensor_interface.h>
+#include <TiledArray/tile_interface/bytes.h>
 #include <TiledArray/tile_interface/cast.h>
 #include <TiledArray/tile_interface/trace.h>
 #include <memory>
@@ -648,6 +649,17 @@ inline bool empty(const Tile<Arg>& arg) {
 }
 #endif
 
+/// Approximate memory footprint of \c arg
+
+/// \tparam Arg The tile argument type
+/// \param arg The tile argument
+/// \return The size of \c arg plus the footprint of its tensor, in bytes
+template <typename Arg>
+inline std::size_t size_of(const Tile<Arg>& arg) {
+  return sizeof(Tile<Arg>) +
+         (arg.empty() ? 0ul : detail::tile_bytes(arg.tensor()));
+}
+
 // Permutation operations ----------------------------------------------------
 
 /// Create a permuted copy of \c arg
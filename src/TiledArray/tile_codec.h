@@ -0,0 +1,325 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tile_codec.h
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_CODEC_H__INCLUDED
+#define TILEDARRAY_TILE_CODEC_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/tile_interface/bytes.h>
+
+#include <madness/world/vector_archive.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace TiledArray {
+
+/// Tile compression settings
+
+/// Selects how tiles are encoded when they are sent to other processes (see
+/// DistArray::set_codec() ) or written to checkpoints (see
+/// write_checkpoint() ). Only tiles whose data is one contiguous buffer of
+/// trivially copyable values (see
+/// detail::is_contiguous_trivially_copyable_tile ) are encoded; other tiles
+/// are serialized as usual.
+struct TileCodec {
+  enum class Kind : std::int32_t {
+    none = 0,      ///< Tiles are serialized as usual
+    lossless = 1,  ///< Consecutive values are XOR'ed and their leading zero
+                   ///< bytes are dropped; exact
+    bounded = 2    ///< Real floating-point values are quantized with a bounded
+                   ///< absolute error, and the differences of consecutive
+                   ///< quantized values are stored as variable-length
+                   ///< integers; other tiles are encoded losslessly
+  };
+
+  Kind kind = Kind::none;  ///< The codec
+  double tolerance = 0.0;  ///< The maximum absolute error of an element, for
+                           ///< Kind::bounded
+
+  /// \return The lossless codec
+  static TileCodec lossless() { return TileCodec{Kind::lossless, 0.0}; }
+
+  /// \param tolerance The maximum absolute error of an element; a natural
+  /// choice is the zero threshold of the shape, e.g.
+  /// SparseShape<float>::threshold() , below which tile norms are
+  /// considered to be zero
+  /// \return The error-bounded lossy codec
+  static TileCodec bounded(const double tolerance) {
+    TA_ASSERT(tolerance >= 0.0);
+    return TileCodec{Kind::bounded, tolerance};
+  }
+
+  /// \return \c true if tiles are encoded
+  explicit operator bool() const { return kind != Kind::none; }
+
+  template <typename Archive>
+  void serialize(Archive& ar) {
+    auto k = static_cast<std::int32_t>(kind);
+    ar& k& tolerance;
+    kind = static_cast<Kind>(k);
+  }
+};  // struct TileCodec
+
+namespace detail {
+
+/// Append an unsigned variable-length integer (7 bits per byte)
+inline void put_varint(std::vector<unsigned char>& out, std::uint64_t x) {
+  while (x >= 0x80u) {
+    out.push_back(static_cast<unsigned char>(x | 0x80u));
+    x >>= 7;
+  }
+  out.push_back(static_cast<unsigned char>(x));
+}
+
+/// Read an unsigned variable-length integer written by put_varint()
+inline std::uint64_t get_varint(const unsigned char*& in,
+                                const unsigned char* const end) {
+  std::uint64_t x = 0ul;
+  for (unsigned shift = 0u; in != end && shift < 64u; shift += 7u) {
+    const unsigned char byte = *in++;
+    x |= std::uint64_t(byte & 0x7fu) << shift;
+    if (!(byte & 0x80u)) return x;
+  }
+  TA_EXCEPTION("decode_tile: invalid encoded tile");
+  return x;
+}
+
+/// The unsigned word type used by the lossless codec for values of type \c T
+template <typename T>
+using codec_word_t = std::conditional_t<
+    sizeof(T) % 8 == 0, std::uint64_t,
+    std::conditional_t<sizeof(T) % 4 == 0, std::uint32_t,
+                       std::conditional_t<sizeof(T) % 2 == 0, std::uint16_t,
+                                          std::uint8_t>>>;
+
+/// The control field of a zero word in encode_lossless()
+constexpr const unsigned zero_word = 0xfu;
+
+/// Lossless encoding of \c n words
+
+/// Each word is XOR'ed with the previous nonzero word, and only the
+/// significant bytes of the result are stored; the number of significant
+/// bytes of each word is stored in a 4-bit control field, in which
+/// \c zero_word marks zero words. Zeros, repeated values, and slowly
+/// varying values therefore take few bytes.
+template <typename Word>
+void encode_lossless(const unsigned char* data, const std::size_t n,
+                     std::vector<unsigned char>& out) {
+  const std::size_t control = out.size();
+  out.reserve(control + (n + 1) / 2 + n * sizeof(Word));
+  out.resize(control + (n + 1) / 2, 0u);
+  Word prev = 0u;
+  for (std::size_t i = 0ul; i < n; ++i) {
+    Word word;
+    std::memcpy(&word, data + i * sizeof(Word), sizeof(Word));
+    if (word == 0u) {
+      out[control + i / 2] |= static_cast<unsigned char>(zero_word
+                                                         << (4 * (i % 2)));
+      continue;
+    }
+    Word x = word ^ prev;
+    prev = word;
+    unsigned nbytes = 0u;
+    for (; x != 0u; ++nbytes, x = Word(x >> 7 >> 1))
+      out.push_back(static_cast<unsigned char>(x & 0xffu));
+    out[control + i / 2] |=
+        static_cast<unsigned char>(nbytes << (4 * (i % 2)));
+  }
+}
+
+/// Decode \c n words encoded by encode_lossless()
+template <typename Word>
+void decode_lossless(const unsigned char* in, const unsigned char* const end,
+                     const std::size_t n, unsigned char* data) {
+  const unsigned char* control = in;
+  in += (n + 1) / 2;
+  if (in > end) TA_EXCEPTION("decode_tile: invalid encoded tile");
+  Word prev = 0u;
+  for (std::size_t i = 0ul; i < n; ++i) {
+    const unsigned nbytes = (control[i / 2] >> (4 * (i % 2))) & 0xfu;
+    if (nbytes == zero_word) {
+      std::memset(data + i * sizeof(Word), 0, sizeof(Word));
+      continue;
+    }
+    if (nbytes > sizeof(Word) || in + nbytes > end)
+      TA_EXCEPTION("decode_tile: invalid encoded tile");
+    Word x = 0u;
+    for (unsigned b = 0u; b < nbytes; ++b) x |= Word(Word(*in++) << (8 * b));
+    prev ^= x;
+    std::memcpy(data + i * sizeof(Word), &prev, sizeof(Word));
+  }
+}
+
+/// Error-bounded encoding of \c n real values
+
+/// Each value is rounded to the nearest multiple of twice the tolerance, and
+/// the differences of consecutive multiples are stored as zigzag
+/// variable-length integers, with runs of zero differences stored as a
+/// count. Values smaller than the tolerance become exact zeros.
+/// \return \c false if a value cannot be quantized (e.g. it is not finite,
+/// or too large for the tolerance)
+template <typename T>
+bool encode_bounded(const T* data, const std::size_t n, const double tolerance,
+                    std::vector<unsigned char>& out) {
+  const double scale = 0.5 / tolerance;
+  constexpr double max_q = 4.0e18;  // well within std::int64_t
+  std::int64_t prev = 0;
+  std::uint64_t run = 0ul;
+  for (std::size_t i = 0ul; i < n; ++i) {
+    const double s = double(data[i]) * scale;
+    if (!(std::abs(s) < max_q)) return false;
+    const std::int64_t q = std::llround(s);
+    const std::uint64_t d = std::uint64_t(q) - std::uint64_t(prev);
+    prev = q;
+    if (d == 0ul) {
+      ++run;
+      continue;
+    }
+    if (run) {
+      put_varint(out, 0ul);
+      put_varint(out, run - 1ul);
+      run = 0ul;
+    }
+    // zigzag encoding of the signed difference
+    put_varint(out, (d << 1) ^ (std::uint64_t(0) - (d >> 63)));
+  }
+  if (run) {
+    put_varint(out, 0ul);
+    put_varint(out, run - 1ul);
+  }
+  return true;
+}
+
+/// Decode \c n values encoded by encode_bounded()
+template <typename T>
+void decode_bounded(const unsigned char* in, const unsigned char* const end,
+                    const std::size_t n, const double tolerance, T* data) {
+  const double step = 2.0 * tolerance;
+  std::int64_t q = 0;
+  for (std::size_t i = 0ul; i < n;) {
+    const std::uint64_t z = get_varint(in, end);
+    if (z == 0ul) {
+      const std::uint64_t run = get_varint(in, end) + 1ul;
+      if (run > n - i) TA_EXCEPTION("decode_tile: invalid encoded tile");
+      for (std::uint64_t r = 0ul; r < run; ++r, ++i) data[i] = T(q * step);
+    } else {
+      q = std::int64_t(std::uint64_t(q) +
+                       ((z >> 1) ^ (std::uint64_t(0) - (z & 1u))));
+      data[i++] = T(q * step);
+    }
+  }
+}
+
+/// Encoding methods of an encoded tile
+enum class TileEncoding : std::int32_t { empty = 0, lossless = 1, bounded = 2 };
+
+/// Encode a tile
+
+/// \tparam Tile A tile type that satisfies
+/// is_contiguous_trivially_copyable_tile
+/// \param tile The tile
+/// \param codec The codec
+/// \return The encoded tile, which holds the range, the encoding method, and
+/// the encoded data
+template <typename Tile>
+std::vector<unsigned char> encode_tile(const Tile& tile,
+                                       const TileCodec& codec) {
+  static_assert(is_contiguous_trivially_copyable_tile_v<Tile>,
+                "encode_tile: the tile type is not supported");
+  typedef typename Tile::value_type value_type;
+  typedef codec_word_t<value_type> word_type;
+
+  std::vector<unsigned char> payload;
+  auto encoding = TileEncoding::empty;
+  if (!tile.empty()) {
+    encoding = TileEncoding::lossless;
+    if constexpr (std::is_floating_point_v<value_type>) {
+      if (codec.kind == TileCodec::Kind::bounded && codec.tolerance > 0.0) {
+        if (encode_bounded(tile.data(), tile.size(), codec.tolerance,
+                           payload))
+          encoding = TileEncoding::bounded;
+        else
+          payload.clear();
+      }
+    }
+    if (encoding == TileEncoding::lossless)
+      encode_lossless<word_type>(
+          reinterpret_cast<const unsigned char*>(tile.data()),
+          tile.size() * sizeof(value_type) / sizeof(word_type), payload);
+  }
+
+  std::vector<unsigned char> result;
+  result.reserve(payload.size() + 128ul);
+  madness::archive::VectorOutputArchive ar(result);
+  ar& static_cast<std::int32_t>(encoding);
+  if (encoding != TileEncoding::empty)
+    ar& tile.range() & codec.tolerance & payload;
+  return result;
+}
+
+/// Decode a tile encoded by encode_tile()
+
+/// \tparam Tile The tile type
+/// \param buffer The encoded tile
+/// \return The tile
+/// \throw TiledArray::Exception if \c buffer is not a valid encoded tile
+template <typename Tile>
+Tile decode_tile(const std::vector<unsigned char>& buffer) {
+  static_assert(is_contiguous_trivially_copyable_tile_v<Tile>,
+                "decode_tile: the tile type is not supported");
+  typedef typename Tile::value_type value_type;
+  typedef codec_word_t<value_type> word_type;
+
+  madness::archive::VectorInputArchive ar(buffer);
+  std::int32_t encoding = 0;
+  ar& encoding;
+  if (encoding == std::int32_t(TileEncoding::empty)) return Tile();
+
+  typename Tile::range_type range;
+  double tolerance = 0.0;
+  std::vector<unsigned char> payload;
+  ar& range& tolerance& payload;
+  Tile tile(range);
+  const auto* in = payload.data();
+  const auto* end = in + payload.size();
+  if (encoding == std::int32_t(TileEncoding::lossless)) {
+    decode_lossless<word_type>(
+        in, end, tile.size() * sizeof(value_type) / sizeof(word_type),
+        reinterpret_cast<unsigned char*>(tile.data()));
+  } else if (encoding == std::int32_t(TileEncoding::bounded)) {
+    if constexpr (std::is_floating_point_v<value_type>)
+      decode_bounded(in, end, tile.size(), tolerance, tile.data());
+    else
+      TA_EXCEPTION("decode_tile: invalid encoded tile");
+  } else {
+    TA_EXCEPTION("decode_tile: invalid encoded tile");
+  }
+  return tile;
+}
+
+}  // namespace detail
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_TILE_CODEC_H__INCLUDED
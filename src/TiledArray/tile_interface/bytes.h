@@ -0,0 +1,99 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  bytes.h
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_INTERFACE_BYTES_H__INCLUDED
+#define TILEDARRAY_TILE_INTERFACE_BYTES_H__INCLUDED
+
+#include "../tensor/type_traits.h"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace TiledArray {
+
+/// Approximate memory footprint of a tensor
+
+/// This is the size of the tensor object plus the size of its element data,
+/// including the data of the inner tensors of a tensor of tensors.
+/// \note \c size_of is the customization point of the memory accounting of
+/// tiles (see detail::tile_bytes() ): user-defined tile types provide a
+/// \c size_of(const Tile&) function in the namespace of the tile type, which
+/// is found by argument-dependent lookup.
+/// \tparam Arg A TiledArray::Tensor type
+/// \param arg The tensor
+/// \return The number of bytes used by \c arg
+template <typename Arg,
+          typename std::enable_if<detail::is_ta_tensor_v<Arg>>::type* = nullptr>
+inline std::size_t size_of(const Arg& arg) {
+  std::size_t bytes = sizeof(Arg);
+  if (arg.empty()) return bytes;
+  if constexpr (detail::is_tensor_of_tensor_v<Arg>) {
+    for (const auto& inner : arg) bytes += size_of(inner);
+  } else {
+    bytes += arg.size() * sizeof(typename Arg::value_type);
+  }
+  return bytes;
+}
+
+namespace detail {
+
+/// Detects tile types with a \c size_of function
+template <typename Arg, typename Enabler = void>
+struct has_size_of : public std::false_type {};
+
+template <typename Arg>
+struct has_size_of<
+    Arg, std::void_t<decltype(size_of(std::declval<const Arg&>()))>>
+    : public std::true_type {};
+
+/// Approximate memory footprint of a tile
+
+/// \tparam Arg The tile type
+/// \param arg The tile
+/// \return The number of bytes used by \c arg , as given by \c size_of(arg)
+/// , or \c sizeof(Arg) if there is no \c size_of function for \c Arg
+template <typename Arg>
+inline std::size_t tile_bytes(const Arg& arg) {
+  if constexpr (has_size_of<Arg>::value)
+    return size_of(arg);
+  else
+    return sizeof(Arg);
+}
+
+/// Detects tiles whose data is a single contiguous buffer of trivially
+/// copyable values, i.e. TA tensors of scalars
+template <typename T, typename Enabler = void>
+struct is_contiguous_trivially_copyable_tile : public std::false_type {};
+
+template <typename T>
+struct is_contiguous_trivially_copyable_tile<
+    T, std::enable_if_t<is_ta_tensor_v<T> && !is_tensor_of_tensor_v<T>>>
+    : public std::bool_constant<
+          std::is_trivially_copyable_v<typename T::value_type>> {};
+
+template <typename T>
+constexpr const bool is_contiguous_trivially_copyable_tile_v =
+    is_contiguous_trivially_copyable_tile<T>::value;
+
+}  // namespace detail
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_TILE_INTERFACE_BYTES_H__INCLUDED
@@ -29,11 +29,14 @@
 #include <TiledArray/math/gemm_helper.h>
 #include <TiledArray/permutation.h>
 #include <TiledArray/tensor/complex.h>
+#include <TiledArray/tensor/type_traits.h>
 #include <TiledArray/tile_op/tile_interface.h>
 #include <TiledArray/util/function.h>
 #include "../tile_interface/add.h"
 #include "../tile_interface/permute.h"
 
+#include <optional>
+
 namespace TiledArray {
 namespace detail {
 
@@ -107,6 +110,15 @@ class ContractReduceBase {
     /// type-erased reference to custom element multiply-add op
     /// \note the lifetime is managed by the callee!
     TiledArray::function_ref<elem_muladd_op_type> elem_muladd_op_;
+
+    /// if \c elem_muladd_op_ is a (scaled) GEMM of the elements, its
+    /// metadata and scaling factor; used to batch the element GEMMs
+    std::optional<std::pair<math::GemmHelper, scalar_type>> inner_gemm_;
+
+    Permutation left_perm_;   ///< Permutation that maps the left-hand
+                              ///< argument to GEMM layout
+    Permutation right_perm_;  ///< Permutation that maps the right-hand
+                              ///< argument to GEMM layout
   };
 
   std::shared_ptr<Impl> pimpl_;
@@ -184,6 +196,93 @@ class ContractReduceBase {
     return pimpl_->elem_muladd_op_;
   }
 
+  /// Declare the element multiply-add op to be an element contraction
+
+  /// Enables batching of the element GEMMs; the element multiply-add op must
+  /// be equivalent to
+  /// `gemm(result, left, right, inner_alpha, inner_gemm_helper)`
+  /// \param inner_gemm_helper The *GEMM operation meta data for the elements
+  /// \param inner_alpha The scaling factor of the element contractions
+  void set_inner_gemm(const math::GemmHelper& inner_gemm_helper,
+                      const scalar_type inner_alpha) {
+    TA_ASSERT(pimpl_);
+    TA_ASSERT(pimpl_->elem_muladd_op_);
+    pimpl_->inner_gemm_.emplace(inner_gemm_helper, inner_alpha);
+  }
+
+  /// Element contraction accessor
+
+  /// \return The *GEMM operation meta data and scaling factor of the element
+  /// contraction, if set by set_inner_gemm()
+  const std::optional<std::pair<math::GemmHelper, scalar_type>>& inner_gemm()
+      const {
+    TA_ASSERT(pimpl_);
+    return pimpl_->inner_gemm_;
+  }
+
+  /// Declare the arguments to be unpermuted
+
+  /// By default the arguments are expected to be in GEMM layout, as
+  /// described by gemm_helper(). After this call the arguments are expected
+  /// to be in their original layout, and are mapped to GEMM layout by
+  /// \p left_perm and \p right_perm ; for each pair of arguments the
+  /// contraction is then either evaluated directly, without permuting the
+  /// arguments, or by permuting the arguments followed by GEMM, whichever
+  /// is estimated to be cheaper by prefer_direct_contraction().
+  /// \param left_perm The permutation that maps the left-hand argument to
+  /// GEMM layout (empty = no permutation)
+  /// \param right_perm The permutation that maps the right-hand argument to
+  /// GEMM layout (empty = no permutation)
+  void set_argument_perms(const Permutation& left_perm,
+                          const Permutation& right_perm) {
+    TA_ASSERT(pimpl_);
+    TA_ASSERT(!pimpl_->elem_muladd_op_);
+    TA_ASSERT(!left_perm || left_perm.size() == left_rank());
+    TA_ASSERT(!right_perm || right_perm.size() == right_rank());
+    pimpl_->left_perm_ = left_perm;
+    pimpl_->right_perm_ = right_perm;
+  }
+
+  /// Left-hand argument permutation accessor
+
+  /// \return The permutation that maps the left-hand argument to GEMM layout
+  const Permutation& left_perm() const {
+    TA_ASSERT(pimpl_);
+    return pimpl_->left_perm_;
+  }
+
+  /// Right-hand argument permutation accessor
+
+  /// \return The permutation that maps the right-hand argument to GEMM
+  /// layout
+  const Permutation& right_perm() const {
+    TA_ASSERT(pimpl_);
+    return pimpl_->right_perm_;
+  }
+
+  /// Relative cost of permuting one element, in units of multiply-adds
+
+  /// Permutations are memory-bound and need a temporary, hence are much more
+  /// expensive per element than a (cache-resident) multiply-add
+  static constexpr std::size_t permute_cost = 8;
+
+  /// Selects the contraction algorithm for unpermuted arguments
+
+  /// \param m The number of rows of the result matrix
+  /// \param n The number of columns of the result matrix
+  /// \param k The contracted dimension
+  /// \param permuted_volume The total volume of the arguments that must be
+  /// permuted into GEMM layout
+  /// \return \c true if permuting the arguments is estimated to cost more
+  /// than their contraction, i.e. if the arguments should be contracted
+  /// directly
+  static bool prefer_direct_contraction(const std::size_t m,
+                                        const std::size_t n,
+                                        const std::size_t k,
+                                        const std::size_t permuted_volume) {
+    return permute_cost * permuted_volume > m * n * k;
+  }
+
   //-------------- these are only used for unit tests -----------------
 
   /// Compute the number of contracted ranks
@@ -323,15 +422,36 @@ class ContractReduce : public ContractReduceBase<Result, Left, Right, Scalar> {
                   const second_argument_type& right) const {
     if constexpr (!ContractReduceBase_::plain_tensors) {
       TA_ASSERT(this->elem_muladd_op());
-      // not yet implemented
       using TiledArray::empty;
       using TiledArray::gemm;
+      const auto& inner_gemm = ContractReduceBase_::inner_gemm();
+      if constexpr (TiledArray::detail::is_ta_tensor_v<Result> &&
+                    TiledArray::detail::is_ta_tensor_v<Left> &&
+                    TiledArray::detail::is_ta_tensor_v<Right> &&
+                    TiledArray::detail::is_numeric_v<scalar_type>) {
+        if (inner_gemm) {
+          gemm(result, left, right, ContractReduceBase_::gemm_helper(),
+               inner_gemm->second, inner_gemm->first);
+          return;
+        }
+      }
       gemm(result, left, right, ContractReduceBase_::gemm_helper(),
            this->elem_muladd_op());
     } else {  // plain tensors
       TA_ASSERT(!this->elem_muladd_op());
       using TiledArray::empty;
       using TiledArray::gemm;
+      if constexpr (TiledArray::detail::is_ta_tensor_v<Result> &&
+                    TiledArray::detail::is_ta_tensor_v<Left> &&
+                    TiledArray::detail::is_ta_tensor_v<Right> &&
+                    TiledArray::detail::is_numeric_v<scalar_type>) {
+        const auto& left_perm = ContractReduceBase_::left_perm();
+        const auto& right_perm = ContractReduceBase_::right_perm();
+        if (left_perm || right_perm) {
+          contract_unpermuted(result, left, left_perm, right, right_perm);
+          return;
+        }
+      }
       if (empty(result))
         result = gemm(left, right, ContractReduceBase_::factor(),
                       ContractReduceBase_::gemm_helper());
@@ -341,6 +461,56 @@ class ContractReduce : public ContractReduceBase<Result, Left, Right, Scalar> {
     }
   }
 
+ private:
+  /// Contract a pair of tiles that are not in GEMM layout
+
+  /// \param[in,out] result The result object that will be the reduction
+  /// target
+  /// \param[in] left The left-hand tile to be contracted
+  /// \param[in] left_perm The permutation that maps \p left to GEMM layout
+  /// \param[in] right The right-hand tile to be contracted
+  /// \param[in] right_perm The permutation that maps \p right to GEMM layout
+  void contract_unpermuted(result_type& result,
+                           const first_argument_type& left,
+                           const Permutation& left_perm,
+                           const second_argument_type& right,
+                           const Permutation& right_perm) const {
+    using TiledArray::empty;
+    using TiledArray::gemm;
+    const auto& gemm_helper = ContractReduceBase_::gemm_helper();
+
+    // The volumes are invariant under permutation, hence the GEMM sizes
+    // follow from the number of contracted elements
+    const Permutation left_inv_perm = (left_perm ? left_perm.inv()
+                                                 : Permutation{});
+    std::size_t k = 1ul;
+    for (auto d = gemm_helper.left_inner_begin();
+         d != gemm_helper.left_inner_end(); ++d)
+      k *= left.range().extent(left_perm ? left_inv_perm[d] : d);
+    const std::size_t m = left.range().volume() / k;
+    const std::size_t n = right.range().volume() / k;
+    const std::size_t permuted_volume =
+        (left_perm ? left.range().volume() : 0ul) +
+        (right_perm ? right.range().volume() : 0ul);
+
+    if (ContractReduceBase_::prefer_direct_contraction(m, n, k,
+                                                       permuted_volume)) {
+      gemm(result, left, right, ContractReduceBase_::factor(), gemm_helper,
+           left_perm, right_perm);
+    } else {
+      using TiledArray::permute;
+      const Left left_gemm = (left_perm ? permute(left, left_perm) : left);
+      const Right right_gemm =
+          (right_perm ? permute(right, right_perm) : right);
+      if (empty(result))
+        result = gemm(left_gemm, right_gemm, ContractReduceBase_::factor(),
+                      gemm_helper);
+      else
+        gemm(result, left_gemm, right_gemm, ContractReduceBase_::factor(),
+             gemm_helper);
+    }
+  }
+
 };  // class ContractReduce
 
 /// Contract and (sum) reduce operation
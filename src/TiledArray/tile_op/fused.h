@@ -0,0 +1,363 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  fused.h
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_OP_FUSED_H__INCLUDED
+#define TILEDARRAY_TILE_OP_FUSED_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/math/vector_op.h>
+#include <TiledArray/permutation.h>
+#include <TiledArray/range.h>
+#include <TiledArray/tensor/type_traits.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+namespace detail {
+
+/// The number of elements that a fused kernel evaluates at a time; the
+/// intermediate results of a block stay in cache
+constexpr std::size_t fused_block_size = 512ul;
+
+/// \return A reference to the flag that enables fusion of element-wise
+/// expressions, which is read once from \c TA_FUSED_EVAL (fusion is disabled
+/// if it is 0); it may be changed between evaluations, e.g. by tests
+inline bool& fused_eval_enabled() {
+  static bool enabled = [] {
+    const char* value = getenv("TA_FUSED_EVAL");
+    return !(value && std::string(value) == "0");
+  }();
+  return enabled;
+}
+
+/// Reads the elements of a tile in the order of a permutation of the tile
+
+/// This gathers the blocks of a permuted argument of a fused kernel through
+/// the permuted strides of the tile, i.e. without permuting the tile.
+/// \tparam T The element type
+template <typename T>
+class FusedPermutedReader {
+ private:
+  const T* data_;                    ///< The data of the tile
+  std::vector<std::size_t> extent_;  ///< The extents of the permuted range
+  std::vector<std::size_t> stride_;  ///< The strides of the tile, permuted
+  std::vector<std::size_t> index_;   ///< The index of the next element
+
+ public:
+  /// \param data The data of the tile
+  /// \param range The range of the tile
+  /// \param perm The permutation of the tile
+  FusedPermutedReader(const T* data, const Range& range,
+                      const Permutation& perm)
+      : data_(data),
+        extent_(range.rank()),
+        stride_(range.rank()),
+        index_(range.rank()) {
+    TA_ASSERT(perm.size() == range.rank());
+    for (std::size_t d = 0ul; d < range.rank(); ++d) {
+      extent_[perm[d]] = range.extent_data()[d];
+      stride_[perm[d]] = range.stride_data()[d];
+    }
+  }
+
+  /// Read a block of elements
+
+  /// \param offset The ordinal, in the permuted range, of the first element
+  /// \param n The number of elements
+  /// \param block The block
+  void read(std::size_t offset, const std::size_t n, T* block) {
+    const std::size_t rank = extent_.size();
+    if (rank == 0ul) {
+      std::fill_n(block, n, data_[0]);
+      return;
+    }
+    std::size_t source = 0ul;
+    for (std::size_t d = rank; d > 0ul; --d) {
+      index_[d - 1] = offset % extent_[d - 1];
+      offset /= extent_[d - 1];
+      source += index_[d - 1] * stride_[d - 1];
+    }
+    const std::size_t last = rank - 1ul;
+    const std::size_t stride = stride_[last];
+    for (std::size_t k = 0ul; k < n;) {
+      // The rest of the current row is read with a constant stride
+      const std::size_t m = std::min(n - k, extent_[last] - index_[last]);
+      for (std::size_t j = 0ul; j < m; ++j)
+        block[k + j] = data_[source + j * stride];
+      k += m;
+      source += m * stride;
+      index_[last] += m;
+      for (std::size_t d = last; d > 0ul && index_[d] == extent_[d]; --d) {
+        source -= extent_[d] * stride_[d];
+        index_[d] = 0ul;
+        ++index_[d - 1];
+        source += stride_[d - 1];
+      }
+    }
+  }
+};  // class FusedPermutedReader
+
+/// An argument of the block operation of a fused kernel
+
+/// Block operations map a block of elements of each argument of a fused
+/// kernel, <tt>const T* const* args</tt> , to a block of result elements.
+/// This returns the elements of the first argument as they are, i.e.
+/// without copying them.
+class FusedArgOp {
+ public:
+  /// \return The number of scratch blocks used by this operation
+  static constexpr std::size_t slots() { return 0ul; }
+
+  /// \param args The blocks of the arguments
+  /// \return The block of this argument
+  template <typename T>
+  const T* operator()(const T* const* args, std::size_t, T*) const {
+    return args[0];
+  }
+};  // class FusedArgOp
+
+/// A unary node of the block operation of a fused kernel
+
+/// \tparam Arg The block operation of the argument
+/// \tparam ElementOp The element operation type, e.g. a scaling
+template <typename Arg, typename ElementOp>
+class FusedUnaryOp {
+ private:
+  Arg arg_;       ///< The block operation of the argument
+  ElementOp op_;  ///< The element operation
+
+ public:
+  /// \param arg The block operation of the argument
+  /// \param op The element operation
+  FusedUnaryOp(const Arg& arg, const ElementOp& op) : arg_(arg), op_(op) {}
+
+  /// \return The number of scratch blocks used by this operation
+  std::size_t slots() const { return 1ul + arg_.slots(); }
+
+  /// Evaluate a block into \c result
+
+  /// \param args The blocks of the arguments
+  /// \param n The number of elements of the block
+  /// \param result The result block
+  /// \param scratch The scratch blocks of the argument
+  template <typename T>
+  void eval_to(const T* const* args, const std::size_t n, T* result,
+               T* scratch) const {
+    math::vector_op_serial(op_, n, result, arg_(args, n, scratch));
+  }
+
+  /// \param args The blocks of the arguments
+  /// \param n The number of elements of the block
+  /// \param scratch slots() scratch blocks
+  /// \return The result block, i.e. the first scratch block
+  template <typename T>
+  const T* operator()(const T* const* args, const std::size_t n,
+                      T* scratch) const {
+    eval_to(args, n, scratch, scratch + fused_block_size);
+    return scratch;
+  }
+};  // class FusedUnaryOp
+
+/// A binary node of the block operation of a fused kernel
+
+/// \tparam Left The block operation of the left-hand argument
+/// \tparam Right The block operation of the right-hand argument
+/// \tparam ElementOp The element operation type, e.g. an addition
+template <typename Left, typename Right, typename ElementOp>
+class FusedBinaryOp {
+ private:
+  Left left_;    ///< The block operation of the left-hand argument
+  Right right_;  ///< The block operation of the right-hand argument
+  std::size_t left_arity_;  ///< The number of arguments of \c left_
+  ElementOp op_;            ///< The element operation
+
+ public:
+  /// \param left The block operation of the left-hand argument
+  /// \param right The block operation of the right-hand argument
+  /// \param left_arity The number of arguments of \c left
+  /// \param op The element operation
+  FusedBinaryOp(const Left& left, const Right& right,
+                const std::size_t left_arity, const ElementOp& op)
+      : left_(left), right_(right), left_arity_(left_arity), op_(op) {}
+
+  /// \return The number of scratch blocks used by this operation
+  std::size_t slots() const { return 1ul + left_.slots() + right_.slots(); }
+
+  /// Evaluate a block into \c result
+
+  /// \param args The blocks of the arguments
+  /// \param n The number of elements of the block
+  /// \param result The result block
+  /// \param scratch The scratch blocks of the arguments
+  template <typename T>
+  void eval_to(const T* const* args, const std::size_t n, T* result,
+               T* scratch) const {
+    const T* left = left_(args, n, scratch);
+    const T* right = right_(args + left_arity_, n,
+                            scratch + left_.slots() * fused_block_size);
+    math::vector_op_serial(op_, n, result, left, right);
+  }
+
+  /// \param args The blocks of the arguments
+  /// \param n The number of elements of the block
+  /// \param scratch slots() scratch blocks
+  /// \return The result block, i.e. the first scratch block
+  template <typename T>
+  const T* operator()(const T* const* args, const std::size_t n,
+                      T* scratch) const {
+    eval_to(args, n, scratch, scratch + fused_block_size);
+    return scratch;
+  }
+};  // class FusedBinaryOp
+
+/// Fused element-wise tile operation
+
+/// Evaluates an element-wise expression of any number of argument tiles in
+/// a single pass over the elements, i.e. without creating intermediate tiles.
+/// The elements are evaluated in blocks of fused_block_size: each node of the
+/// expression computes its block with a vectorized loop (see
+/// math::vector_op_serial ) into a scratch block, and the root writes into the
+/// result tile. Zero (i.e. empty) argument tiles contribute zero elements.
+/// Arguments may be given with a permutation, in which case their blocks are
+/// read through the permuted strides of the tile (see FusedPermutedReader ).
+/// The result is written into a consumable, unpermuted argument tile, if
+/// there is one. If a permutation is given, it is applied to the result tile.
+/// \tparam Result The result and argument tile type; must be a plain
+/// TiledArray::Tensor
+/// \tparam Op The block operation type, e.g. FusedBinaryOp
+template <typename Result, typename Op>
+class Fused {
+ public:
+  typedef Fused<Result, Op> Fused_;  ///< This object type
+  typedef Result result_type;        ///< The result tile type
+  typedef Result argument_type;      ///< The argument tile type
+  typedef typename Result::numeric_type
+      numeric_type;  ///< The element type of the tiles
+
+  static_assert(is_ta_tensor_v<Result> && !is_tensor_of_tensor_v<Result>,
+                "Fused can only evaluate plain TiledArray::Tensor tiles");
+
+ private:
+  Op op_;             ///< The block operation
+  Permutation perm_;  ///< The permutation applied to the result
+
+ public:
+  Fused() = delete;
+  Fused(const Fused_&) = default;
+  Fused(Fused_&&) = default;
+  ~Fused() = default;
+  Fused_& operator=(const Fused_&) = default;
+  Fused_& operator=(Fused_&&) = default;
+
+  /// Constructor
+
+  /// \param op The block operation
+  /// \param perm The permutation applied to the result tile
+  explicit Fused(const Op& op, const Permutation& perm = {})
+      : op_(op), perm_(perm) {}
+
+  /// Evaluate the fused tile operation
+
+  /// \param args The argument tiles; zero tiles are represented by empty
+  /// tiles, but at least one argument must be non-empty
+  /// \param consumable Flags the argument tiles that may be overwritten
+  /// \return The result tile
+  result_type operator()(const std::vector<argument_type>& args,
+                         const std::vector<bool>& consumable) const {
+    return (*this)(args, consumable,
+                   std::vector<Permutation>(args.size(), Permutation()));
+  }
+
+  /// Evaluate the fused tile operation
+
+  /// \param args The argument tiles; zero tiles are represented by empty
+  /// tiles, but at least one argument must be non-empty
+  /// \param consumable Flags the argument tiles that may be overwritten
+  /// \param perms The permutations of the argument tiles; an argument is
+  /// read as if it was permuted by its permutation, if it has one
+  /// \return The result tile
+  result_type operator()(const std::vector<argument_type>& args,
+                         const std::vector<bool>& consumable,
+                         const std::vector<Permutation>& perms) const {
+    TA_ASSERT(args.size() == consumable.size());
+    TA_ASSERT(args.size() == perms.size());
+    const std::size_t nargs = args.size();
+    std::size_t first = 0ul;
+    while (first < nargs && args[first].empty()) ++first;
+    TA_ASSERT(first < nargs);
+    const auto range = perms[first] ? perms[first] * args[first].range()
+                                    : args[first].range();
+
+    std::vector<const numeric_type*> data(nargs, nullptr);
+    std::vector<std::size_t> permuted;
+    std::vector<FusedPermutedReader<numeric_type>> readers;
+    result_type result;
+    bool has_zero_args = false;
+    for (std::size_t a = 0ul; a < nargs; ++a) {
+      if (args[a].empty()) {
+        has_zero_args = true;
+        continue;
+      }
+      if (perms[a]) {
+        TA_ASSERT(perms[a] * args[a].range() == range);
+        permuted.push_back(a);
+        readers.emplace_back(args[a].data(), args[a].range(), perms[a]);
+        continue;
+      }
+      TA_ASSERT(args[a].range() == range);
+      data[a] = args[a].data();
+      if (consumable[a] && result.empty()) result = args[a];
+    }
+    if (result.empty()) result = result_type(range);
+
+    // The blocks of an argument are read before the corresponding block of
+    // the result is written, hence the result may alias an argument
+    const std::vector<numeric_type> zeros(
+        has_zero_args ? fused_block_size : 0ul, numeric_type(0));
+    std::vector<numeric_type> scratch(op_.slots() * fused_block_size);
+    std::vector<numeric_type> gathered(permuted.size() * fused_block_size);
+    std::vector<const numeric_type*> blocks(nargs);
+    const std::size_t volume = range.volume();
+    for (std::size_t offset = 0ul; offset < volume;
+         offset += fused_block_size) {
+      const std::size_t n = std::min(fused_block_size, volume - offset);
+      for (std::size_t a = 0ul; a < nargs; ++a)
+        blocks[a] = data[a] ? data[a] + offset : zeros.data();
+      for (std::size_t p = 0ul; p < permuted.size(); ++p) {
+        numeric_type* block = gathered.data() + p * fused_block_size;
+        readers[p].read(offset, n, block);
+        blocks[permuted[p]] = block;
+      }
+      op_.eval_to(blocks.data(), n, result.data() + offset, scratch.data());
+    }
+
+    if (perm_) return result.permute(perm_);
+    return result;
+  }
+};  // class Fused
+
+}  // namespace detail
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_TILE_OP_FUSED_H__INCLUDED
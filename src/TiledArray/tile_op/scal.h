@@ -55,6 +55,8 @@ class Scal {
 
  private:
   scalar_type factor_;  ///< Scaling factor
+  bool deferred_ = false;  ///< If \c true , the scaling is applied by the
+                           ///< consumer of the result tiles
 
   // Permuting tile evaluation function
   // These operations cannot consume the argument tile since this operation
@@ -62,6 +64,12 @@ class Scal {
   template <typename Perm,
             typename = std::enable_if_t<detail::is_permutation_v<Perm>>>
   result_type eval(const Arg& arg, const Perm& perm) const {
+    if constexpr (std::is_same_v<result_type, argument_type>) {
+      if (deferred_) {
+        using TiledArray::permute;
+        return permute(arg, perm);
+      }
+    }
     using TiledArray::scale;
     return scale(arg, factor_, perm);
   }
@@ -72,12 +80,16 @@ class Scal {
 
   template <bool C, typename std::enable_if<!C>::type* = nullptr>
   result_type eval(const argument_type& arg) const {
+    if constexpr (std::is_same_v<result_type, argument_type>) {
+      if (deferred_) return arg;
+    }
     using TiledArray::scale;
     return scale(arg, factor_);
   }
 
   template <bool C, typename std::enable_if<C>::type* = nullptr>
   result_type eval(argument_type& arg) const {
+    if (deferred_) return arg;
     using TiledArray::scale_to;
     return scale_to(arg, factor_);
   }
@@ -96,6 +108,18 @@ class Scal {
   /// \param factor The scaling factor for the operation
   explicit Scal(const scalar_type factor) : factor_(factor) {}
 
+  /// Constructor
+
+  /// \param factor The scaling factor for the operation
+  /// \param deferred If \c true , the argument tiles are not scaled, i.e.
+  /// the consumer of the result tiles applies \p factor itself (e.g. a
+  /// complex conjugation is applied by GEMM via ConjTranspose); only valid if
+  /// the result and argument tile types are the same
+  Scal(const scalar_type factor, const bool deferred)
+      : factor_(factor), deferred_(deferred) {
+    TA_ASSERT(!deferred_ || std::is_same_v<result_type, argument_type>);
+  }
+
   /// Scale and permute operator
 
   /// \param arg The tile argument
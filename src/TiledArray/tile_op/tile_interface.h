@@ -34,6 +34,7 @@
 namespace TiledArray {
 
 // Forward declaration
+class Permutation;
 namespace math {
 class GemmHelper;
 }  // namespace math
@@ -841,6 +842,66 @@ inline Result& gemm(Result& result, const Left& left, const Right& right,
       std::forward<ElementMultiplyAddOp>(element_multiplyadd_op));
 }
 
+/// Contract 2 tensors of tensors over head/tail modes, with their elements
+/// contracted via GEMM, and accumulate into \c result
+
+/// This is equivalent to calling
+/// `gemm(result, left, right, gemm_config, element_multiplyadd_op)` with
+/// \c element_multiplyadd_op that contracts elements with
+/// `gemm(result, left, right, inner_factor, inner_gemm_config)`, but allows
+/// the tile to batch the element contractions.
+/// \tparam Result The result tile type
+/// \tparam Left The left-hand tile type
+/// \tparam Right The right-hand tile type
+/// \tparam Scalar A numeric type
+/// \param result The contracted result; this can be null, will be initialized
+/// as needed
+/// \param left The left-hand argument to be contracted
+/// \param right The right-hand argument to be contracted
+/// \param gemm_config A helper object used to simplify gemm operations
+/// \param inner_factor The scaling factor of the element contractions
+/// \param inner_gemm_config A helper object used to simplify the element gemm
+/// operations
+template <typename Result, typename Left, typename Right, typename Scalar,
+          std::enable_if_t<TiledArray::detail::is_numeric_v<Scalar>>* = nullptr>
+inline Result& gemm(Result& result, const Left& left, const Right& right,
+                    const math::GemmHelper& gemm_config,
+                    const Scalar inner_factor,
+                    const math::GemmHelper& inner_gemm_config) {
+  return result.gemm(left, right, gemm_config, inner_factor,
+                     inner_gemm_config);
+}
+
+/// Contract 2 permuted tensors over head/tail modes, scale the product, and
+/// add the result to \c result , without permuting the arguments
+
+/// This is equivalent to
+/// `gemm(result, permute(left, left_perm), permute(right, right_perm),
+/// factor, gemm_config)`, but the arguments are read in place.
+/// \tparam Result The result tile type
+/// \tparam Left The left-hand tile type
+/// \tparam Right The right-hand tile type
+/// \tparam Scalar A numeric type
+/// \param result The contracted result; this can be null, will be initialized
+/// as needed
+/// \param left The left-hand argument to be contracted
+/// \param right The right-hand argument to be contracted
+/// \param factor The scaling factor
+/// \param gemm_config A helper object used to simplify gemm operations; it
+/// refers to the permuted arguments
+/// \param left_perm The permutation that maps \p left to the layout expected
+/// by \p gemm_config
+/// \param right_perm The permutation that maps \p right to the layout
+/// expected by \p gemm_config
+template <typename Result, typename Left, typename Right, typename Scalar,
+          std::enable_if_t<TiledArray::detail::is_numeric_v<Scalar>>* = nullptr>
+inline Result& gemm(Result& result, const Left& left, const Right& right,
+                    const Scalar factor, const math::GemmHelper& gemm_config,
+                    const Permutation& left_perm,
+                    const Permutation& right_perm) {
+  return result.gemm(left, right, factor, gemm_config, left_perm, right_perm);
+}
+
 template <typename... T>
 using result_of_gemm_t = decltype(gemm(std::declval<T>()...));
 
@@ -0,0 +1,259 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  util/memory.h
+ *
+ */
+
+#ifndef TILEDARRAY_UTIL_MEMORY_H__INCLUDED
+#define TILEDARRAY_UTIL_MEMORY_H__INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace TiledArray {
+namespace detail {
+
+class MemoryTracker;
+MemoryTracker& memory_tracker();
+
+/// Accounts for the memory allocated for the data of TiledArray::Tensor
+/// objects by this process
+
+/// Tracks the current size of the allocated tensor data, its high-water mark
+/// since the last reset, and the high-water marks of the registered
+/// TiledArray::TensorBytesPeak objects. Views of external data (e.g. mapped
+/// files) are not accounted for.
+/// Every thread accounts for its allocations in its own counter, so that
+/// allocations do not contend; the counters are summed when queried. A
+/// thread publishes its net allocations to the shared size, from which the
+/// high-water marks are raised, once they exceed \c granularity bytes;
+/// hence the high-water marks are accurate to within tolerance() bytes,
+/// while the current size is exact.
+class MemoryTracker {
+ public:
+  /// The net allocations of a thread that are published at once, in bytes
+  static constexpr std::int64_t granularity = 1l << 16;
+
+ private:
+  friend MemoryTracker& memory_tracker();
+
+  /// The counters of a thread
+  struct alignas(64) Slot {
+    std::atomic<std::int64_t> bytes{0};  ///< Net allocations of the thread
+    std::int64_t pending = 0;  ///< Net allocations that are not published
+  };
+
+  mutable std::mutex mutex_;  ///< Protects slots_ and peaks_
+  std::deque<Slot> slots_;    ///< The counters of the threads
+  std::vector<std::atomic<std::int64_t>*>
+      peaks_;  ///< The high-water marks of the registered peak trackers
+  std::atomic<std::size_t> num_peaks_{0};    ///< The size of peaks_
+  std::atomic<std::int64_t> published_{0};   ///< Published size
+  std::atomic<std::int64_t> high_water_{0};  ///< Peak size since the reset
+
+  MemoryTracker() = default;
+
+ public:
+  /// Raise a high-water mark
+
+  /// \param peak The high-water mark
+  /// \param value The new value of \c peak , if it is greater
+  static void raise(std::atomic<std::int64_t>& peak, const std::int64_t value) {
+    std::int64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current &&
+           !peak.compare_exchange_weak(current, value,
+                                       std::memory_order_relaxed))
+      ;
+  }
+
+ private:
+  /// \return The counters of the calling thread
+  Slot& slot() {
+    thread_local Slot* slot = nullptr;
+    if (!slot) {
+      std::scoped_lock lock(mutex_);
+      slot = &slots_.emplace_back();
+    }
+    return *slot;
+  }
+
+  /// Publish the pending allocations of \c slot
+  void publish(Slot& slot) {
+    const std::int64_t delta = slot.pending;
+    slot.pending = 0;
+    const std::int64_t value =
+        published_.fetch_add(delta, std::memory_order_relaxed) + delta;
+    if (delta <= 0) return;
+    raise(high_water_, value);
+    if (num_peaks_.load(std::memory_order_relaxed) != 0ul) {
+      std::scoped_lock lock(mutex_);
+      for (auto* peak : peaks_) raise(*peak, value);
+    }
+  }
+
+  /// Account for a change of the size of the calling thread
+  void add(const std::int64_t bytes) {
+    Slot& s = slot();
+    s.bytes.store(s.bytes.load(std::memory_order_relaxed) + bytes,
+                  std::memory_order_relaxed);
+    s.pending += bytes;
+    if (s.pending >= granularity || s.pending <= -granularity) publish(s);
+  }
+
+ public:
+  MemoryTracker(const MemoryTracker&) = delete;
+  MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+  /// Account for an allocation
+  void allocated(const std::size_t bytes) { add(std::int64_t(bytes)); }
+
+  /// Account for a deallocation
+  void deallocated(const std::size_t bytes) { add(-std::int64_t(bytes)); }
+
+  /// \return The current size of the tensor data, in bytes
+  std::size_t bytes() const {
+    std::int64_t result = 0;
+    std::scoped_lock lock(mutex_);
+    for (const auto& s : slots_)
+      result += s.bytes.load(std::memory_order_relaxed);
+    return std::max(result, std::int64_t(0));
+  }
+
+  /// \return The maximum error of the high-water marks, in bytes
+  std::size_t tolerance() const {
+    std::scoped_lock lock(mutex_);
+    return slots_.size() * granularity;
+  }
+
+  /// \return The peak size of the tensor data since the last call to
+  /// reset_high_water() , in bytes
+  std::size_t high_water() const {
+    return std::max(
+        std::size_t(
+            std::max(high_water_.load(std::memory_order_relaxed),
+                     std::int64_t(0))),
+        bytes());
+  }
+
+  /// Reset the high-water mark to the current size
+  void reset_high_water() {
+    high_water_.store(bytes(), std::memory_order_relaxed);
+  }
+
+  /// Register a high-water mark, which is raised with the size of the tensor
+  /// data until it is unregistered
+
+  /// \param peak The high-water mark
+  void register_peak(std::atomic<std::int64_t>& peak) {
+    std::scoped_lock lock(mutex_);
+    peaks_.push_back(&peak);
+    num_peaks_.store(peaks_.size(), std::memory_order_relaxed);
+  }
+
+  /// Unregister a high-water mark registered with register_peak()
+
+  /// \param peak The high-water mark
+  void unregister_peak(std::atomic<std::int64_t>& peak) {
+    std::scoped_lock lock(mutex_);
+    peaks_.erase(std::find(peaks_.begin(), peaks_.end(), &peak));
+    num_peaks_.store(peaks_.size(), std::memory_order_relaxed);
+  }
+};  // class MemoryTracker
+
+/// \return The memory tracker of this process
+inline MemoryTracker& memory_tracker() {
+  static MemoryTracker tracker;
+  return tracker;
+}
+
+}  // namespace detail
+
+/// \return The size of the tensor data allocated by this process, in bytes
+/// \note This includes the tiles of all arrays as well as the temporaries of
+/// expressions and of user code; see DistArray::local_bytes() for the tiles
+/// of a single array.
+inline std::size_t tensor_bytes() { return detail::memory_tracker().bytes(); }
+
+/// \return The peak size of the tensor data allocated by this process since
+/// the last call to reset_tensor_bytes_high_water() , in bytes; this is
+/// accurate to within detail::MemoryTracker::tolerance() bytes
+inline std::size_t tensor_bytes_high_water() {
+  return detail::memory_tracker().high_water();
+}
+
+/// Reset the high-water mark of the tensor data of this process to the
+/// current size
+inline void reset_tensor_bytes_high_water() {
+  detail::memory_tracker().reset_high_water();
+}
+
+/// Measures the peak increase of the tensor data allocated by this process
+/// from the construction of this object until it is stopped
+
+/// Every object measures its own peak, e.g.
+/// \code
+/// TensorBytesPeak peak;
+/// c("i,j") = a("i,k") * b("k,j");
+/// world.gop.fence();
+/// const std::size_t bytes = peak.bytes();
+/// \endcode
+/// The peak is accurate to within detail::MemoryTracker::tolerance() bytes.
+/// Every expression evaluation measures its own peak with this object, see
+/// DistArray::expression_peak_bytes() .
+class TensorBytesPeak {
+ private:
+  std::int64_t base_;                      ///< The size at construction
+  std::atomic<std::int64_t> high_water_;  ///< The peak size
+  std::atomic<bool> stopped_{false};      ///< \c true once stopped
+
+ public:
+  TensorBytesPeak()
+      : base_(detail::memory_tracker().bytes()), high_water_(base_) {
+    detail::memory_tracker().register_peak(high_water_);
+  }
+
+  TensorBytesPeak(const TensorBytesPeak&) = delete;
+  TensorBytesPeak& operator=(const TensorBytesPeak&) = delete;
+
+  ~TensorBytesPeak() { stop(); }
+
+  /// Stop the measurement, i.e. freeze the peak at its current value
+  void stop() {
+    if (stopped_.exchange(true)) return;
+    detail::MemoryTracker::raise(high_water_, detail::memory_tracker().bytes());
+    detail::memory_tracker().unregister_peak(high_water_);
+  }
+
+  /// \return The peak increase of the tensor data since the construction of
+  /// this object, until it was stopped, in bytes
+  std::size_t bytes() const {
+    std::int64_t peak = high_water_.load(std::memory_order_relaxed);
+    if (!stopped_.load())
+      peak = std::max(peak, std::int64_t(detail::memory_tracker().bytes()));
+    return std::max(peak - base_, std::int64_t(0));
+  }
+};  // class TensorBytesPeak
+
+}  // namespace TiledArray
+
+#endif  // TILEDARRAY_UTIL_MEMORY_H__INCLUDED
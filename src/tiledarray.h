@@ -36,7 +36,9 @@
 // Expression functionality
 #include <TiledArray/conversions/dense_to_sparse.h>
 #include <TiledArray/conversions/foreach.h>
+#include <TiledArray/conversions/ingest.h>
 #include <TiledArray/conversions/make_array.h>
+#include <TiledArray/conversions/node_replicated.h>
 #include <TiledArray/conversions/retile.h>
 #include <TiledArray/conversions/sparse_to_dense.h>
 #include <TiledArray/conversions/to_new_tile_type.h>
@@ -50,6 +52,8 @@
 // Process maps
 #include <TiledArray/pmap/hash_pmap.h>
 #include <TiledArray/pmap/replicated_pmap.h>
+#include <TiledArray/pmap/weighted_pmap.h>
+#include <TiledArray/pmap/sfc_pmap.h>
 
 // Utility functionality
 #include <TiledArray/conversions/eigen.h>
@@ -57,6 +61,10 @@
 // Linear algebra
 #include <TiledArray/math/linalg.h>
 
+#include <TiledArray/checkpoint.h>
 #include <TiledArray/dist_array.h>
+#include <TiledArray/mapped_array.h>
+#include <TiledArray/subworld.h>
+#include <TiledArray/tile_codec.h>
 
 #endif  // TILEDARRAY_H__INCLUDED
@@ -20,6 +20,7 @@
 #include <unistd.h>
 #include <chrono>
 #include <cstdio>
+#include <fstream>
 #include <random>
 
 #include <madness/world/binary_fstream_archive.h>
@@ -369,7 +370,7 @@ BOOST_AUTO_TEST_CASE(find_local) {
   for (auto&& tile_idx : a.range()) {
     if (a.is_local(tile_idx)) {
       const Future<ArrayN::value_type>& const_tile_fut = a.find_local(tile_idx);
-      Future<ArrayN::value_type>& nonconst_tile_fut = a.find_local(tile_idx);
+      Future<ArrayN::value_type> nonconst_tile_fut = a.find_local(tile_idx);
 
       const int value = world.rank() + 1;
       BOOST_CHECK(const_tile_fut.probe());
@@ -406,6 +407,49 @@ BOOST_AUTO_TEST_CASE(find_remote) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(find_batch) {
+  // coordinate indices
+  std::vector<ArrayN::index> indices(a.range().begin(), a.range().end());
+  std::vector<Future<ArrayN::value_type>> tiles;
+  BOOST_REQUIRE_NO_THROW(tiles = a.find_batch(indices));
+  BOOST_REQUIRE_EQUAL(tiles.size(), indices.size());
+  for (std::size_t j = 0; j < indices.size(); ++j) {
+    BOOST_CHECK_EQUAL(tiles[j].get().range(),
+                      a.trange().make_tile_range(indices[j]));
+    const int owner = a.owner(indices[j]);
+    for (const auto& value : tiles[j].get())
+      BOOST_CHECK_EQUAL(value, owner + 1);
+  }
+
+  // ordinal indices, in reverse order and with duplicates
+  std::vector<std::size_t> ordinals;
+  for (std::size_t i = a.size(); i > 0ul; --i) ordinals.push_back(i - 1ul);
+  ordinals.push_back(0ul);
+  tiles = a.find_batch(ordinals);
+  for (std::size_t j = 0; j < ordinals.size(); ++j) {
+    const int owner = a.owner(ordinals[j]);
+    for (const auto& value : tiles[j].get())
+      BOOST_CHECK_EQUAL(value, owner + 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(set_batch) {
+  ArrayN c(world, tr);
+
+  // every process sets a share of the tiles, most of them remote
+  std::vector<std::pair<std::size_t, ArrayN::value_type>> tiles;
+  for (std::size_t i = 0; i < c.size(); ++i)
+    if (i % world.size() == std::size_t(world.rank()))
+      tiles.emplace_back(i, ArrayN::value_type(c.trange().make_tile_range(i),
+                                               int(i)));
+  BOOST_REQUIRE_NO_THROW(c.set_batch(tiles));
+  world.gop.fence();
+
+  for (std::size_t i = 0; i < c.size(); ++i)
+    for (const auto& value : c.find(i).get())
+      BOOST_CHECK_EQUAL(value, int(i));
+}
+
 BOOST_AUTO_TEST_CASE(fill_tiles) {
   ArrayN a(world, tr);
 
@@ -505,6 +549,26 @@ BOOST_AUTO_TEST_CASE(truncate) {
   BOOST_CHECK(std::distance(b_trunc1.begin(), b_trunc1.end()) == 0);
 }
 
+BOOST_AUTO_TEST_CASE(remote_cache) {
+  auto c = a.clone();
+  c.enable_remote_cache(1ul << 20);
+  const auto ntiles = c.trange().tiles_range().volume();
+  for (std::size_t i = 0; i < ntiles; ++i) c.find(i).get();
+  world.gop.fence();
+
+  // in-place updates drop the cached tiles, and keep the cache enabled
+  foreach_inplace(c, [](tile_type& tile) { tile.scale_to(2); });
+  BOOST_CHECK_EQUAL(c.remote_cache_max_bytes(), 1ul << 20);
+  for (std::size_t i = 0; i < ntiles; ++i) {
+    const tile_type tile = c.find(i).get();
+    const tile_type expected = a.find(i).get().scale(2);
+    BOOST_CHECK_EQUAL(tile.range(), expected.range());
+    for (std::size_t j = 0; j < tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile[j], expected[j]);
+  }
+  world.gop.fence();
+}
+
 BOOST_AUTO_TEST_CASE(make_replicated) {
   // Get a copy of the original process map
   std::shared_ptr<ArrayN::pmap_interface> distributed_pmap = a.pmap();
@@ -529,6 +593,93 @@ BOOST_AUTO_TEST_CASE(make_replicated) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(make_node_replicated) {
+  // Get a copy of the original process map
+  std::shared_ptr<ArrayN::pmap_interface> distributed_pmap = a.pmap();
+
+  // Convert array to a node-replicated array.
+  BOOST_REQUIRE_NO_THROW(TiledArray::make_node_replicated(a));
+
+  if (GlobalFixture::world->size() == 1)
+    BOOST_CHECK(!a.pmap()->is_replicated());
+  else
+    BOOST_CHECK(a.pmap()->is_replicated());
+
+  // Check that all the data is local
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    BOOST_CHECK(a.is_local(i));
+    Future<ArrayN::value_type> tile = a.find(i);
+    BOOST_CHECK_EQUAL(tile.get().range(), a.trange().make_tile_range(i));
+    for (ArrayN::value_type::const_iterator it = tile.get().begin();
+         it != tile.get().end(); ++it)
+      BOOST_CHECK_EQUAL(*it, distributed_pmap->owner(i) + 1);
+  }
+
+  // The tiles outlive the array
+  std::vector<ArrayN::value_type> tiles;
+  for (std::size_t i = 0; i < a.size(); ++i) tiles.push_back(a.find(i).get());
+  a = ArrayN();
+  GlobalFixture::world->gop.fence();
+  for (std::size_t i = 0; i < tiles.size(); ++i)
+    for (const auto& value : tiles[i])
+      BOOST_CHECK_EQUAL(value, distributed_pmap->owner(i) + 1);
+}
+
+BOOST_AUTO_TEST_CASE(redistribute) {
+  // Get a copy of the original process map
+  std::shared_ptr<ArrayN::pmap_interface> distributed_pmap = a.pmap();
+
+  // Scatter the tiles with a hashed process map
+  auto pmap = std::make_shared<TiledArray::detail::HashPmap>(
+      *GlobalFixture::world, a.size(), 3ul);
+  BOOST_REQUIRE_NO_THROW(a.redistribute(pmap, 2ul));
+  BOOST_CHECK_EQUAL(a.pmap(), pmap);
+
+  // Check that the local tiles are in place and have not changed
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    BOOST_CHECK_EQUAL(a.owner(i), pmap->owner(i));
+    if (a.is_local(i)) {
+      const auto& tile = a.find_local(i);
+      BOOST_CHECK(tile.probe());
+    }
+    Future<ArrayN::value_type> tile = a.find(i);
+    BOOST_CHECK_EQUAL(tile.get().range(), a.trange().make_tile_range(i));
+    for (ArrayN::value_type::const_iterator it = tile.get().begin();
+         it != tile.get().end(); ++it)
+      BOOST_CHECK_EQUAL(*it, distributed_pmap->owner(i) + 1);
+  }
+
+  // Sparse arrays only move the nonzero tiles
+  std::shared_ptr<SpArrayN::pmap_interface> sp_distributed_pmap = b.pmap();
+  BOOST_REQUIRE_NO_THROW(b.redistribute(pmap));
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    if (b.is_zero(i)) continue;
+    Future<SpArrayN::value_type> tile = b.find(i);
+    for (SpArrayN::value_type::const_iterator it = tile.get().begin();
+         it != tile.get().end(); ++it)
+      BOOST_CHECK_EQUAL(*it, sp_distributed_pmap->owner(i) + 1);
+  }
+
+  // Replicate the tiles, and distribute them again
+  auto replicated_pmap = std::make_shared<TiledArray::detail::ReplicatedPmap>(
+      *GlobalFixture::world, a.size());
+  BOOST_REQUIRE_NO_THROW(a.redistribute(replicated_pmap));
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    BOOST_CHECK(a.is_local(i));
+    const auto& tile = a.find_local(i);
+    BOOST_REQUIRE(tile.probe());
+    for (const auto& value : tile.get())
+      BOOST_CHECK_EQUAL(value, distributed_pmap->owner(i) + 1);
+  }
+
+  BOOST_REQUIRE_NO_THROW(a.redistribute(distributed_pmap));
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    BOOST_CHECK_EQUAL(a.owner(i), distributed_pmap->owner(i));
+    for (const auto& value : a.find(i).get())
+      BOOST_CHECK_EQUAL(value, distributed_pmap->owner(i) + 1);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(serialization_by_tile) {
   decltype(a) acopy(a.world(), a.trange(), a.shape());
 
@@ -666,6 +817,365 @@ BOOST_AUTO_TEST_CASE(parallel_sparse_serialization) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(save_load) {
+  char archive_file_prefix_name[] = "tmp.XXXXXX";
+  mktemp(archive_file_prefix_name);
+  madness::save(b, archive_file_prefix_name);
+
+  // the number of I/O nodes is read from the archive, so stale files of an
+  // earlier archive with the same name are ignored
+  const int nio = TiledArray::detail::default_num_io_nodes(world);
+  const std::string stale_file_name =
+      to_parallel_archive_file_name(archive_file_prefix_name, nio);
+  if (world.rank() == 0) std::fclose(std::fopen(stale_file_name.c_str(), "wb"));
+  BOOST_CHECK_EQUAL(
+      TiledArray::detail::num_archive_files(world, archive_file_prefix_name),
+      nio);
+  if (world.rank() == 0) std::remove(stale_file_name.c_str());
+
+  decltype(b) bread(world, b.trange(), b.shape());
+  madness::load(bread, archive_file_prefix_name);
+
+  BOOST_CHECK_EQUAL(bread.trange(), b.trange());
+  BOOST_REQUIRE(bread.shape() == b.shape());
+  BOOST_CHECK_EQUAL_COLLECTIONS(bread.begin(), bread.end(), b.begin(), b.end());
+  world.gop.fence();
+
+  // the archive is read with as many I/O nodes as it was written with
+  setenv("TA_IO_NODES", "1", 1);
+  decltype(b) bread1(world, b.trange(), b.shape());
+  madness::load(bread1, archive_file_prefix_name);
+  unsetenv("TA_IO_NODES");
+  BOOST_CHECK_EQUAL_COLLECTIONS(bread1.begin(), bread1.end(), b.begin(),
+                                b.end());
+  world.gop.fence();
+
+  // archives without the trailer, i.e. written before it was introduced,
+  // remain readable
+  if (world.rank() < nio) {
+    const std::string file_name =
+        to_parallel_archive_file_name(archive_file_prefix_name, world.rank());
+    const auto size =
+        std::ifstream(file_name, std::ios::binary | std::ios::ate).tellg();
+    BOOST_REQUIRE_EQUAL(
+        truncate(file_name.c_str(),
+                 off_t(size) - sizeof(std::int32_t) - sizeof(std::uint64_t)),
+        0);
+  }
+  world.gop.fence();
+  BOOST_CHECK_EQUAL(
+      TiledArray::detail::num_archive_files(world, archive_file_prefix_name),
+      nio);
+  decltype(b) bread2(world, b.trange(), b.shape());
+  madness::load(bread2, archive_file_prefix_name);
+  BOOST_CHECK_EQUAL_COLLECTIONS(bread2.begin(), bread2.end(), b.begin(),
+                                b.end());
+  world.gop.fence();
+  if (world.rank() < TiledArray::detail::default_num_io_nodes(world)) {
+    std::remove(
+        to_parallel_archive_file_name(archive_file_prefix_name, world.rank())
+            .c_str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(save_load_convert) {
+  char archive_file_prefix_name[] = "tmp.XXXXXX";
+  mktemp(archive_file_prefix_name);
+  madness::save(b, archive_file_prefix_name);
+
+  // convert with TiledArray::Cast
+  TSpArrayD bread(world, b.trange(), b.shape());
+  madness::load<decltype(b)>(bread, archive_file_prefix_name);
+  BOOST_CHECK_EQUAL(bread.trange(), b.trange());
+  BOOST_REQUIRE(bread.shape() == b.shape());
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    if (b.is_zero(i) || !b.is_local(i)) continue;
+    const auto& tile = b.find(i).get();
+    const auto& tile_read = bread.find(i).get();
+    for (std::size_t j = 0; j < tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile_read[j], double(tile[j]));
+  }
+
+  // convert with a user-provided converter
+  TSpArrayD bscaled(world, b.trange(), b.shape());
+  madness::load<decltype(b)>(
+      bscaled, archive_file_prefix_name,
+      [](tile_type&& tile) {
+        return TensorD(tile, [](const int x) { return 2.0 * x; });
+      });
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    if (b.is_zero(i) || !b.is_local(i)) continue;
+    const auto& tile = b.find(i).get();
+    const auto& tile_read = bscaled.find(i).get();
+    for (std::size_t j = 0; j < tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile_read[j], 2.0 * tile[j]);
+  }
+
+  world.gop.fence();
+  if (world.rank() < TiledArray::detail::default_num_io_nodes(world)) {
+    std::remove(
+        to_parallel_archive_file_name(archive_file_prefix_name, world.rank())
+            .c_str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(checkpoint) {
+  char prefix[] = "tmp.XXXXXX";
+  mktemp(prefix);
+  BOOST_REQUIRE_NO_THROW(write_checkpoint(b, prefix));
+
+  // restart with the default pmap
+  decltype(b) bread;
+  BOOST_REQUIRE_NO_THROW(bread = read_checkpoint<decltype(b)>(world, prefix));
+  BOOST_CHECK_EQUAL(bread.trange(), b.trange());
+  BOOST_REQUIRE(bread.shape() == b.shape());
+  BOOST_CHECK_EQUAL_COLLECTIONS(bread.begin(), bread.end(), b.begin(), b.end());
+
+  // restart with a different pmap
+  auto pmap = std::make_shared<detail::HashPmap>(world, b.size(), 3ul);
+  decltype(b) bhash = read_checkpoint<decltype(b)>(world, prefix, pmap);
+  BOOST_CHECK_EQUAL(bhash.pmap(), pmap);
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    BOOST_CHECK_EQUAL(bhash.is_zero(i), b.is_zero(i));
+    if (!b.is_zero(i))
+      BOOST_CHECK(bhash.find(i).get() == b.find(i).get());
+  }
+
+  // the type is checked
+  BOOST_CHECK_THROW(read_checkpoint<ArrayN>(world, prefix),
+                    TiledArray::Exception);
+
+  // each tile of a replicated array is written once
+  world.gop.fence();
+  decltype(b) brep(world, b.trange(), b.shape(),
+                   std::make_shared<detail::ReplicatedPmap>(world, b.size()));
+  for (std::size_t i = 0; i < b.size(); ++i)
+    if (!b.is_zero(i)) brep.set(i, b.find(i).get());
+  BOOST_REQUIRE_NO_THROW(write_checkpoint(brep, prefix));
+  decltype(b) brepread = read_checkpoint<decltype(b)>(world, prefix);
+  BOOST_REQUIRE(brepread.shape() == b.shape());
+  BOOST_CHECK_EQUAL_COLLECTIONS(brepread.begin(), brepread.end(), b.begin(),
+                                b.end());
+
+  // compressed checkpoint
+  world.gop.fence();
+  BOOST_REQUIRE_NO_THROW(write_checkpoint(b, prefix, TileCodec::lossless()));
+  decltype(b) bcodec = read_checkpoint<decltype(b)>(world, prefix);
+  BOOST_REQUIRE(bcodec.shape() == b.shape());
+  BOOST_CHECK_EQUAL_COLLECTIONS(bcodec.begin(), bcodec.end(), b.begin(),
+                                b.end());
+
+  world.gop.fence();
+  std::remove(to_parallel_archive_file_name(prefix, world.rank()).c_str());
+  if (world.rank() == 0) std::remove((std::string(prefix) + ".index").c_str());
+}
+
+BOOST_AUTO_TEST_CASE(mapped_array) {
+  char prefix[] = "tmp.XXXXXX";
+  mktemp(prefix);
+  BOOST_REQUIRE_NO_THROW(write_mapped_array(b, prefix));
+
+  // map with a different pmap
+  auto pmap = std::make_shared<detail::HashPmap>(world, b.size(), 3ul);
+  {
+    decltype(b) bmap;
+    BOOST_REQUIRE_NO_THROW(bmap =
+                               map_array<decltype(b)>(world, prefix, pmap));
+    BOOST_CHECK_EQUAL(bmap.trange(), b.trange());
+    BOOST_REQUIRE(bmap.shape() == b.shape());
+    for (std::size_t i = 0; i < b.size(); ++i) {
+      if (b.is_zero(i)) continue;
+      if (bmap.is_local(i)) {
+        const auto tile = bmap.find_local(i).get();
+        // the tiles are page-aligned views of the mapping
+        BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(tile.data()) %
+                              detail::mapped_array_alignment,
+                          0ul);
+      }
+      BOOST_CHECK(bmap.find(i).get() == b.find(i).get());
+    }
+  }
+
+  // the type is checked
+  BOOST_CHECK_THROW(map_array<ArrayN>(world, prefix), TiledArray::Exception);
+
+  world.gop.fence();
+  std::remove(to_parallel_archive_file_name(prefix, world.rank()).c_str());
+  if (world.rank() == 0) std::remove((std::string(prefix) + ".index").c_str());
+}
+
+BOOST_AUTO_TEST_CASE(local_ready) {
+  TiledRange1 TR0{0, 3, 8, 10};
+  TiledRange1 TR1{0, 4, 7, 10};
+  TiledRange TR{TR0, TR1};
+  TArrayD A(world, TR), B(world, TR), C, D;
+  A.fill(1.0);
+  B.fill(2.0);
+
+  // two independent expressions, without a fence in between
+  auto c_ready = (C("i,j") = A("i,k") * B("k,j")).local_ready();
+  auto d_ready = (D("i,j") = A("i,j") + B("j,i")).local_ready();
+  BOOST_CHECK(c_ready.get());
+  BOOST_CHECK(d_ready.get());
+  for (const auto i : *C.pmap())
+    BOOST_CHECK(C.find_local(i).probe());
+  for (const auto i : *D.pmap())
+    BOOST_CHECK(D.find_local(i).probe());
+
+  BOOST_REQUIRE_NO_THROW(C.wait_ready());
+  for (const auto& tile : C)
+    for (const auto& value : tile.get()) BOOST_CHECK_EQUAL(value, 20.0);
+  for (const auto& tile : D)
+    for (const auto& value : tile.get()) BOOST_CHECK_EQUAL(value, 3.0);
+
+  // tiles that are never set are not waited on
+  TArrayD E(world, TR);
+  BOOST_CHECK(E.local_ready().get());
+  BOOST_CHECK_EQUAL(E.pending_tiles(), 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(ready) {
+  TiledRange1 TR0{0, 3, 8, 10};
+  TiledRange1 TR1{0, 4, 7, 10};
+  TiledRange TR{TR0, TR1};
+  TArrayD A(world, TR);
+  BOOST_CHECK(A.ready().probe());
+
+  // init -> compute -> reduce, without fences
+  A.init_tiles([](const Range& range) { return TensorD(range, 1.0); });
+  BOOST_CHECK_LE(A.pending_tiles(), A.pmap()->local_size());
+  auto a_ready = A.ready();
+  foreach_inplace(A, [](TensorD& tile) { tile.scale_to(2.0); }, false);
+  auto sum = world.taskq.add(
+      [&A](bool) {
+        double result = 0.0;
+        for (const auto i : *A.pmap()) result += A.find_local(i).get().sum();
+        return result;
+      },
+      A.ready());
+  BOOST_CHECK(a_ready.get());
+  const auto local_volume = [&]() {
+    double result = 0.0;
+    for (const auto i : *A.pmap())
+      result += A.trange().make_tile_range(i).volume();
+    return result;
+  }();
+  BOOST_CHECK_EQUAL(sum.get(), 2.0 * local_volume);
+  BOOST_CHECK_EQUAL(A.pending_tiles(), 0ul);
+  BOOST_CHECK(A.ready().probe());
+  for (const auto i : *A.pmap()) BOOST_CHECK(A.find_local(i).probe());
+  world.gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE(ingest) {
+  TiledRange trange{{0, 2, 5}, {0, 3, 4}};
+  // the files must have the same name on all processes
+  const std::string dense_file_name = "tmp.ingest.dense";
+  const std::string coordinate_file_name = "tmp.ingest.coordinate";
+
+  // elements (i,j) of the dense file, and a few elements of tiles (0,0) and
+  // (1,1), given as (i,j,value) records, of the coordinate file
+  auto value = [](const int i, const int j) { return 10.0 * i + j + 1.0; };
+  const std::vector<std::pair<int, int>> elements = {
+      {0, 0}, {1, 2}, {4, 3}, {2, 3}, {1, 2}};
+  if (world.rank() == 0) {
+    std::ofstream dense(dense_file_name, std::ios::binary);
+    for (int i = 0; i < 5; ++i)
+      for (int j = 0; j < 4; ++j) {
+        const double x = value(i, j);
+        dense.write(reinterpret_cast<const char*>(&x), sizeof(double));
+      }
+    std::ofstream coordinate(coordinate_file_name, std::ios::binary);
+    for (const auto& e : elements) {
+      const std::int32_t index[2] = {e.first, e.second};
+      const double x = value(e.first, e.second);
+      coordinate.write(reinterpret_cast<const char*>(index), sizeof(index));
+      coordinate.write(reinterpret_cast<const char*>(&x), sizeof(double));
+    }
+  }
+  world.gop.fence();
+
+  auto a = read_dense_file<TArrayD>(world, dense_file_name, trange);
+  BOOST_CHECK_EQUAL(a.trange(), trange);
+  for (const auto i : *a.pmap()) {
+    const auto& tile = a.find(i).get();
+    for (const auto& idx : tile.range())
+      BOOST_CHECK_EQUAL(tile(idx), value(idx[0], idx[1]));
+  }
+
+  // rows that straddle the chunks and the batches
+  setenv("TA_INGEST_CHUNK_BYTES", "24", 1);
+  setenv("TA_INGEST_BATCH", "2", 1);
+  auto c = read_dense_file<TArrayD>(world, dense_file_name, trange);
+  unsetenv("TA_INGEST_CHUNK_BYTES");
+  unsetenv("TA_INGEST_BATCH");
+  for (const auto i : *c.pmap()) {
+    const auto& tile = c.find(i).get();
+    for (const auto& idx : tile.range())
+      BOOST_CHECK_EQUAL(tile(idx), value(idx[0], idx[1]));
+  }
+
+  auto b = read_coordinate_file<TSpArrayD, std::int32_t>(
+      world, coordinate_file_name, trange);
+  BOOST_CHECK(!b.is_zero({0, 0}));
+  BOOST_CHECK(b.is_zero({0, 1}));
+  BOOST_CHECK(b.is_zero({1, 0}));
+  BOOST_CHECK(!b.is_zero({1, 1}));
+  for (const auto i : *b.pmap()) {
+    if (b.is_zero(i)) continue;
+    const auto& tile = b.find(i).get();
+    for (const auto& idx : tile.range()) {
+      const bool given =
+          std::find(elements.begin(), elements.end(),
+                    std::make_pair(int(idx[0]), int(idx[1]))) != elements.end();
+      BOOST_CHECK_EQUAL(tile(idx), given ? value(idx[0], idx[1]) : 0.0);
+    }
+  }
+
+  world.gop.fence();
+  if (world.rank() == 0) {
+    std::remove(dense_file_name.c_str());
+    std::remove(coordinate_file_name.c_str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(memory_accounting) {
+  TiledRange1 TR0{0, 3, 8, 10};
+  TiledRange1 TR1{0, 4, 7, 10};
+  TiledRange TR{TR0, TR1};
+  TArrayD A(world, TR), B(world, TR), C, D;
+  A.fill(1.0);
+  B.fill(2.0);
+  world.gop.fence();
+
+  std::size_t local = 0ul;
+  for (const auto i : *A.pmap())
+    local += detail::tile_bytes(A.find_local(i).get());
+  BOOST_CHECK_EQUAL(A.local_bytes(), local);
+  std::size_t total = local;
+  world.gop.sum(total);
+  BOOST_CHECK_EQUAL(A.bytes(), total);
+  // the tiles hold (at least) the 100 elements of A
+  BOOST_CHECK_GE(A.bytes(), 100 * sizeof(double));
+
+  // the expression allocates (at least) the data of the local result tiles
+  C("i,j") = A("i,k") * B("k,j");
+  world.gop.fence();
+  std::size_t result_data = 0ul;
+  for (const auto i : *C.pmap())
+    result_data += C.find_local(i).get().size() * sizeof(double);
+  BOOST_CHECK_GE(C.expression_peak_bytes(), result_data);
+  BOOST_CHECK_GE(tensor_bytes_high_water(), tensor_bytes());
+
+  // every evaluation has its own peak, i.e. a later evaluation does not
+  // change the peak of an earlier one
+  const std::size_t c_peak = C.expression_peak_bytes();
+  D("i,j") = A("i,j") + B("i,j");
+  world.gop.fence();
+  BOOST_CHECK_EQUAL(C.expression_peak_bytes(), c_peak);
+  BOOST_CHECK_EQUAL(A.expression_peak_bytes(), 0ul);
+}
+
 BOOST_AUTO_TEST_CASE(issue_225) {
   TiledRange1 TR0{0, 3, 8, 10};
   TiledRange1 TR1{0, 4, 7, 10};
@@ -18,7 +18,9 @@
  */
 
 #include "TiledArray/distributed_storage.h"
+#include "TiledArray/pmap/round_robin_pmap.h"
 #include <iterator>
+#include <numeric>
 #include "tiledarray.h"
 #include "unit_test_config.h"
 
@@ -101,4 +103,212 @@ BOOST_AUTO_TEST_CASE(array_operator) {
   BOOST_CHECK_THROW(t.get(t.max_size() + 2), TiledArray::Exception);
 }
 
+BOOST_AUTO_TEST_CASE(hashed_storage) {
+  // HashPmap does not know its local elements, so they are stored in a hash
+  // map rather than in a dense array
+  auto hash_pmap = std::make_shared<detail::HashPmap>(world, 10);
+  Storage s(world, 10, hash_pmap);
+  BOOST_CHECK_EQUAL(s.size(), 0ul);
+
+  for (std::size_t i = 0; i < s.max_size(); ++i)
+    if (s.is_local(i)) s.set(i, int(i));
+
+  world.gop.fence();
+  std::size_t n = s.size();
+  world.gop.sum(n);
+  BOOST_CHECK_EQUAL(n, s.max_size());
+
+  for (std::size_t i = 0; i < s.max_size(); ++i)
+    BOOST_CHECK_EQUAL(s.get(i).get(), int(i));
+}
+
+BOOST_AUTO_TEST_CASE(strided_storage) {
+  // RoundRobinPmap knows its local elements, which are not contiguous; only
+  // the elements that are accessed are stored
+  auto rr_pmap = std::make_shared<detail::RoundRobinPmap>(world, 10);
+  Storage s(world, 10, rr_pmap);
+  BOOST_CHECK_EQUAL(s.size(), 0ul);
+
+  std::size_t accessed = 0ul;
+  for (std::size_t i = 0; i < s.max_size(); i += 2)
+    if (s.is_local(i)) {
+      s.set(i, int(i));
+      ++accessed;
+    }
+  BOOST_CHECK_EQUAL(s.size(), accessed);
+
+  world.gop.fence();
+  for (std::size_t i = 0; i < s.max_size(); i += 2)
+    BOOST_CHECK_EQUAL(s.get(i).get(), int(i));
+}
+
+BOOST_AUTO_TEST_CASE(batch) {
+  // every process sets a share of the elements, most of them remote
+  std::vector<std::pair<size_type, int>> elements;
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    if (i % world.size() == std::size_t(world.rank()))
+      elements.emplace_back(i, int(i));
+  BOOST_REQUIRE_NO_THROW(t.set(elements));
+  world.gop.fence();
+
+  std::vector<size_type> indices;
+  for (std::size_t i = t.max_size(); i > 0ul; --i) indices.push_back(i - 1ul);
+  std::vector<Storage::future> values = t.get(indices);
+  BOOST_REQUIRE_EQUAL(values.size(), indices.size());
+  for (std::size_t j = 0; j < indices.size(); ++j)
+    BOOST_CHECK_EQUAL(values[j].get(), int(indices[j]));
+}
+
+BOOST_AUTO_TEST_CASE(remote_cache) {
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    if (t.is_local(i)) t.set(i, int(i));
+  world.gop.fence();
+
+  std::size_t remote = 0ul;
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    if (!t.is_local(i)) ++remote;
+
+  t.enable_remote_cache(1024ul);
+  BOOST_CHECK_EQUAL(t.remote_cache_max_bytes(), 1024ul);
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    BOOST_CHECK_EQUAL(t.get(i).get(), int(i));
+  world.taskq.fence();
+  BOOST_CHECK_EQUAL(t.remote_cache_bytes(), remote * sizeof(int));
+
+  // cached elements are served without communication
+  for (std::size_t i = 0; i < t.max_size(); ++i) {
+    Storage::future f = t.get(i);
+    BOOST_CHECK(f.probe());
+    BOOST_CHECK_EQUAL(f.get(), int(i));
+  }
+
+  // cached elements are dropped at the end of a fence
+  world.gop.fence();
+  BOOST_CHECK_EQUAL(t.remote_cache_bytes(), 0ul);
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    BOOST_CHECK_EQUAL(t.get(i).get(), int(i));
+  world.taskq.fence();
+
+  // shrinking the bound evicts elements
+  t.enable_remote_cache(sizeof(int));
+  BOOST_CHECK_LE(t.remote_cache_bytes(), sizeof(int));
+
+  t.invalidate_remote_cache();
+  BOOST_CHECK_EQUAL(t.remote_cache_bytes(), 0ul);
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    BOOST_CHECK_EQUAL(t.get(i).get(), int(i));
+  world.gop.fence();
+
+  t.disable_remote_cache();
+  BOOST_CHECK_EQUAL(t.remote_cache_bytes(), 0ul);
+  BOOST_CHECK_EQUAL(t.remote_cache_max_bytes(), 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(out_of_core) {
+  t.enable_out_of_core(2 * sizeof(int));
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    if (t.is_local(i)) t.set(i, int(i));
+  world.gop.fence();
+  BOOST_CHECK_LE(t.resident_bytes(), 2 * sizeof(int));
+
+  // spilled elements are read back on access
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    BOOST_CHECK_EQUAL(t.get(i).get(), int(i));
+  world.gop.fence();
+  BOOST_CHECK_LE(t.resident_bytes(), 2 * sizeof(int));
+
+  // the futures returned by get_local() keep their elements while the
+  // elements are spilled, and spilled elements are read back into them
+  std::vector<std::pair<std::size_t, Storage::future>> held;
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    if (t.is_local(i)) held.emplace_back(i, t.get_local(i));
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    BOOST_CHECK_EQUAL(t.get(i).get(), int(i));
+  world.gop.fence();
+  BOOST_CHECK_LE(t.resident_bytes(), 2 * sizeof(int));
+  for (const auto& [i, f] : held) BOOST_CHECK_EQUAL(f.get(), int(i));
+
+  // disabling spilling reads all elements back
+  t.disable_out_of_core();
+  BOOST_CHECK_EQUAL(t.resident_bytes(), 0ul);
+  for (std::size_t i = 0; i < t.max_size(); ++i) {
+    if (!t.is_local(i)) continue;
+    Storage::future f = t.get(i);
+    BOOST_CHECK(f.probe());
+    BOOST_CHECK_EQUAL(f.get(), int(i));
+  }
+  world.gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE(codec) {
+  typedef detail::DistributedStorage<TensorD> TensorStorage;
+  static_assert(detail::is_contiguous_trivially_copyable_tile_v<TensorD>);
+  static_assert(!detail::is_contiguous_trivially_copyable_tile_v<int>);
+  TensorStorage s(world, 10, pmap);
+  BOOST_CHECK(!s.codec());
+  s.set_codec(TileCodec::bounded(1e-8));
+  BOOST_CHECK(s.codec().kind == TileCodec::Kind::bounded);
+
+  // elements are encoded when they are sent to, and requested from, other
+  // processes
+  if (world.rank() == 0)
+    for (std::size_t i = 0; i < s.max_size(); ++i)
+      s.set(i, TensorD(Range(100), 1.0 / (i + 1)));
+  world.gop.fence();
+  for (std::size_t i = 0; i < s.max_size(); ++i) {
+    const TensorD tile = s.get(i).get();
+    BOOST_CHECK_EQUAL(tile.range(), Range(100));
+    for (const auto& value : tile)
+      BOOST_CHECK_SMALL(value - 1.0 / (i + 1), 2e-8);
+  }
+  world.gop.fence();
+
+  // so are batches of elements
+  TensorStorage b(world, 10, pmap);
+  b.set_codec(TileCodec::bounded(1e-8));
+  if (world.rank() == 0) {
+    std::vector<std::pair<std::size_t, TensorD>> elements;
+    for (std::size_t i = 0; i < b.max_size(); ++i)
+      elements.emplace_back(i, TensorD(Range(100), 1.0 / (i + 1)));
+    b.set(elements);
+  }
+  world.gop.fence();
+  std::vector<std::size_t> indices(b.max_size());
+  std::iota(indices.begin(), indices.end(), 0ul);
+  const auto tiles = b.get(indices);
+  for (std::size_t i = 0; i < b.max_size(); ++i) {
+    const TensorD tile = tiles[i].get();
+    BOOST_CHECK_EQUAL(tile.range(), Range(100));
+    for (const auto& value : tile)
+      BOOST_CHECK_SMALL(value - 1.0 / (i + 1), 2e-8);
+  }
+  world.gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE(redistribute) {
+  for (std::size_t i = 0; i < t.max_size(); ++i)
+    if (t.is_local(i)) t.set(i, int(i));
+  world.gop.fence();
+
+  // dense -> hashed -> dense storage
+  const std::shared_ptr<detail::Pmap> pmaps[] = {
+      std::make_shared<detail::HashPmap>(world, 10),
+      std::make_shared<detail::RoundRobinPmap>(world, 10)};
+  for (const auto& new_pmap : pmaps) {
+    BOOST_REQUIRE_NO_THROW(t.redistribute(new_pmap, 1ul));
+    world.gop.fence();
+    BOOST_CHECK_EQUAL(t.pmap(), new_pmap);
+
+    std::size_t n = 0ul;
+    for (std::size_t i = 0; i < t.max_size(); ++i) {
+      if (t.is_local(i)) {
+        BOOST_CHECK(t.get_local(i).probe());
+        ++n;
+      }
+      BOOST_CHECK_EQUAL(t.get(i).get(), int(i));
+    }
+    BOOST_CHECK_EQUAL(t.size(), n);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
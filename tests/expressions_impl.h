@@ -1673,6 +1673,149 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(scale_mult_permute, F, Fixtures, F) {
   }
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(fused_elementwise, F, Fixtures, F) {
+  auto& a = F::a;
+  auto& b = F::b;
+  auto& c = F::c;
+
+  Permutation perm({2, 1, 0});
+
+  BOOST_REQUIRE_NO_THROW(c("a,b,c") = 2 * (a("a,b,c") + b("c,b,a")) -
+                                      a("a,b,c") * (3 * b("a,b,c")));
+
+  for (std::size_t i = 0ul; i < c.size(); ++i) {
+    const size_t perm_index = c.range().ordinal(perm * a.range().idx(i));
+    if (!c.is_zero(i)) {
+      auto c_tile = c.find(i).get();
+      auto a_tile =
+          a.is_zero(i) ? F::make_zero_tile(c_tile.range()) : a.find(i).get();
+      auto b_tile =
+          b.is_zero(i) ? F::make_zero_tile(c_tile.range()) : b.find(i).get();
+      auto bp_tile = b.is_zero(perm_index) ? F::make_zero_tile(c_tile.range())
+                                           : perm * b.find(perm_index).get();
+
+      for (std::size_t j = 0ul; j < c_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(c_tile[j], (a_tile[j] + bp_tile[j]) * 2 -
+                                         a_tile[j] * (3 * b_tile[j]));
+    }
+  }
+
+  // permuted result
+  BOOST_REQUIRE_NO_THROW(c("c,b,a") =
+                             -(a("a,b,c") - b("a,b,c")) + a("a,b,c") * 2);
+
+  for (std::size_t i = 0ul; i < c.size(); ++i) {
+    const size_t perm_index = c.range().ordinal(perm * a.range().idx(i));
+    if (!c.is_zero(i)) {
+      auto c_tile = c.find(i).get();
+      auto a_tile = a.is_zero(perm_index) ? F::make_zero_tile(c_tile.range())
+                                          : perm * a.find(perm_index).get();
+      auto b_tile = b.is_zero(perm_index) ? F::make_zero_tile(c_tile.range())
+                                          : perm * b.find(perm_index).get();
+
+      for (std::size_t j = 0ul; j < c_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(c_tile[j],
+                          -(a_tile[j] - b_tile[j]) + a_tile[j] * 2);
+    }
+  }
+
+  // Hadamard root with a permuted, scaled argument
+  BOOST_REQUIRE_NO_THROW(c("a,b,c") =
+                             (a("a,b,c") + b("a,b,c")) * (2 * b("c,b,a")));
+
+  for (std::size_t i = 0ul; i < c.size(); ++i) {
+    const size_t perm_index = c.range().ordinal(perm * a.range().idx(i));
+    if (!c.is_zero(i)) {
+      auto c_tile = c.find(i).get();
+      auto a_tile =
+          a.is_zero(i) ? F::make_zero_tile(c_tile.range()) : a.find(i).get();
+      auto b_tile =
+          b.is_zero(i) ? F::make_zero_tile(c_tile.range()) : b.find(i).get();
+      auto bp_tile = b.is_zero(perm_index) ? F::make_zero_tile(c_tile.range())
+                                           : perm * b.find(perm_index).get();
+
+      for (std::size_t j = 0ul; j < c_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(c_tile[j],
+                          (a_tile[j] + b_tile[j]) * (2 * bp_tile[j]));
+    }
+  }
+
+  // fusion disabled
+  std::decay_t<decltype(c)> d;
+  const bool fused = TiledArray::detail::fused_eval_enabled();
+  TiledArray::detail::fused_eval_enabled() = false;
+  BOOST_REQUIRE_NO_THROW(d("a,b,c") =
+                             (a("a,b,c") + b("a,b,c")) * (2 * b("c,b,a")));
+  TiledArray::detail::fused_eval_enabled() = fused;
+
+  for (std::size_t i = 0ul; i < c.size(); ++i) {
+    BOOST_CHECK_EQUAL(d.is_zero(i), c.is_zero(i));
+    if (!c.is_zero(i)) {
+      auto c_tile = c.find(i).get();
+      auto d_tile = d.find(i).get();
+      for (std::size_t j = 0ul; j < c_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(d_tile[j], c_tile[j]);
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(conj_fused, F, Fixtures, F) {
+  auto& a = F::a;
+  auto& b = F::b;
+  auto& c = F::c;
+  auto& u = F::u;
+  auto& w = F::w;
+
+  // conjugation folded into the element-wise kernel
+  BOOST_REQUIRE_NO_THROW(c("a,b,c") = a("a,b,c").conj() + b("a,b,c"));
+
+  for (std::size_t i = 0ul; i < c.size(); ++i) {
+    if (!c.is_zero(i)) {
+      auto c_tile = c.find(i).get();
+      auto a_tile =
+          a.is_zero(i) ? F::make_zero_tile(c_tile.range()) : a.find(i).get();
+      auto b_tile =
+          b.is_zero(i) ? F::make_zero_tile(c_tile.range()) : b.find(i).get();
+
+      for (std::size_t j = 0ul; j < c_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(c_tile[j],
+                          TiledArray::detail::conj(a_tile[j]) + b_tile[j]);
+    }
+  }
+
+  // conjugation folded into GEMM
+  BOOST_REQUIRE_NO_THROW(c("a,b,c") = a("a,b,c").conj());
+  BOOST_REQUIRE_NO_THROW(u("i,j") = c("k,b,i") * b("k,b,j"));
+  BOOST_REQUIRE_NO_THROW(w("i,j") = a("k,b,i").conj() * b("k,b,j"));
+
+  for (std::size_t i = 0ul; i < w.size(); ++i) {
+    BOOST_CHECK_EQUAL(w.is_zero(i), u.is_zero(i));
+    if (!w.is_zero(i)) {
+      auto w_tile = w.find(i).get();
+      auto u_tile = u.find(i).get();
+      for (std::size_t j = 0ul; j < w_tile.size(); ++j)
+        BOOST_CHECK_EQUAL(w_tile[j], u_tile[j]);
+    }
+  }
+
+  // conjugation folded into the reductions
+  typename F::element_type expected = 0;
+  for (std::size_t i = 0ul; i < a.size(); ++i) {
+    if (!a.is_zero(i) && !b.is_zero(i)) {
+      auto a_tile = a.find(i).get();
+      auto b_tile = b.find(i).get();
+
+      for (std::size_t j = 0ul; j < a_tile.size(); ++j)
+        expected += TiledArray::detail::conj(a_tile[j]) * b_tile[j];
+    }
+  }
+  BOOST_CHECK_EQUAL(a("a,b,c").conj().dot(b("a,b,c")).get(), expected);
+  BOOST_CHECK_EQUAL(a("a,b,c").inner_product(b("a,b,c")).get(), expected);
+  BOOST_CHECK_EQUAL(c("a,b,c").dot(b("a,b,c")).get(), expected);
+  BOOST_CHECK_EQUAL(a("a,b,c").conj().squared_norm().get(),
+                    a("a,b,c").squared_norm().get());
+}
+
 BOOST_FIXTURE_TEST_CASE_TEMPLATE(cont, F, Fixtures, F) {
   auto& a = F::a;
   auto& b = F::b;
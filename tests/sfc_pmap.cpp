@@ -0,0 +1,170 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/pmap/sfc_pmap.h"
+#include "global_fixture.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct SfcPmapFixture {
+  SfcPmapFixture() {}
+
+  // tile index spaces of various ranks, including non-power-of-two extents
+  static std::vector<std::vector<std::size_t>> extents() {
+    return {{1}, {17}, {4, 4}, {5, 7}, {3, 4, 5}, {2, 3, 2, 5}};
+  }
+
+  static std::size_t volume(const std::vector<std::size_t>& extents) {
+    return std::accumulate(extents.begin(), extents.end(), std::size_t(1),
+                           std::multiplies<>());
+  }
+
+  static constexpr detail::SfcPmap::Curve curves[] = {
+      detail::SfcPmap::Curve::Hilbert, detail::SfcPmap::Curve::Morton};
+};
+
+// =============================================================================
+// SfcPmap Test Suite
+
+BOOST_FIXTURE_TEST_SUITE(sfc_pmap_suite, SfcPmapFixture)
+
+BOOST_AUTO_TEST_CASE(constructor) {
+  for (const auto& ext : extents()) {
+    for (const auto curve : curves) {
+      BOOST_REQUIRE_NO_THROW(
+          TiledArray::detail::SfcPmap pmap(*GlobalFixture::world, ext, curve));
+      TiledArray::detail::SfcPmap pmap(*GlobalFixture::world, ext, curve);
+      BOOST_CHECK_EQUAL(pmap.rank(), GlobalFixture::world->rank());
+      BOOST_CHECK_EQUAL(pmap.procs(), GlobalFixture::world->size());
+      BOOST_CHECK_EQUAL(pmap.size(), volume(ext));
+    }
+  }
+
+  TiledArray::Range range({1, 2}, {4, 7});
+  TiledArray::detail::SfcPmap pmap(*GlobalFixture::world, range);
+  BOOST_CHECK_EQUAL(pmap.size(), range.volume());
+}
+
+BOOST_AUTO_TEST_CASE(owner) {
+  const std::size_t rank = GlobalFixture::world->rank();
+  const std::size_t size = GlobalFixture::world->size();
+
+  ProcessID* p_owner = new ProcessID[size];
+
+  for (const auto& ext : extents()) {
+    for (const auto curve : curves) {
+      TiledArray::detail::SfcPmap pmap(*GlobalFixture::world, ext, curve);
+
+      for (std::size_t tile = 0; tile < pmap.size(); ++tile) {
+        std::fill_n(p_owner, size, 0);
+        p_owner[rank] = pmap.owner(tile);
+        // check that the value is in range
+        BOOST_CHECK_LT(p_owner[rank], size);
+        GlobalFixture::world->gop.sum(p_owner, size);
+
+        // Make sure everyone agrees on who owns what.
+        for (std::size_t p = 0ul; p < size; ++p)
+          BOOST_CHECK_EQUAL(p_owner[p], p_owner[rank]);
+      }
+    }
+  }
+
+  delete[] p_owner;
+}
+
+BOOST_AUTO_TEST_CASE(local_size) {
+  for (const auto& ext : extents()) {
+    for (const auto curve : curves) {
+      TiledArray::detail::SfcPmap pmap(*GlobalFixture::world, ext, curve);
+      BOOST_CHECK(pmap.known_local_size());
+
+      // the curve is split into blocks, as in BlockedPmap
+      const std::size_t tiles = pmap.size();
+      const std::size_t procs = pmap.procs();
+      BOOST_CHECK_GE(pmap.local_size(), tiles / procs);
+      BOOST_CHECK_LE(pmap.local_size(), (tiles + procs - 1ul) / procs);
+
+      std::size_t total_size = pmap.local_size();
+      GlobalFixture::world->gop.sum(total_size);
+      BOOST_CHECK_EQUAL(total_size, tiles);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(local_group) {
+  ProcessID tile_owners[120];
+
+  for (const auto& ext : extents()) {
+    for (const auto curve : curves) {
+      TiledArray::detail::SfcPmap pmap(*GlobalFixture::world, ext, curve);
+      const std::size_t tiles = pmap.size();
+
+      // Check that all local elements map to this rank
+      for (detail::SfcPmap::const_iterator it = pmap.begin(); it != pmap.end();
+           ++it) {
+        BOOST_CHECK_EQUAL(pmap.owner(*it), GlobalFixture::world->rank());
+      }
+
+      std::fill_n(tile_owners, tiles, 0);
+      for (detail::SfcPmap::const_iterator it = pmap.begin(); it != pmap.end();
+           ++it) {
+        tile_owners[*it] += GlobalFixture::world->rank();
+      }
+
+      GlobalFixture::world->gop.sum(tile_owners, tiles);
+      for (std::size_t tile = 0; tile < tiles; ++tile) {
+        BOOST_CHECK_EQUAL(tile_owners[tile], pmap.owner(tile));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(locality) {
+  // a contiguous segment of the Hilbert curve is connected, i.e. the local
+  // tiles of a square grid form one connected block
+  const std::size_t n = 8ul;
+  TiledArray::detail::SfcPmap pmap(*GlobalFixture::world,
+                                   std::vector<std::size_t>{n, n});
+  if (pmap.local_size() == 0ul) return;
+
+  std::vector<bool> visited(n * n, false);
+  std::vector<std::size_t> stack(1, *pmap.begin());
+  visited[stack.front()] = true;
+  std::size_t connected = 0ul;
+  while (!stack.empty()) {
+    const std::size_t tile = stack.back();
+    stack.pop_back();
+    ++connected;
+    const std::size_t i = tile / n, j = tile % n;
+    const std::size_t neighbors[4] = {(i > 0ul ? tile - n : tile),
+                                      (i + 1ul < n ? tile + n : tile),
+                                      (j > 0ul ? tile - 1ul : tile),
+                                      (j + 1ul < n ? tile + 1ul : tile)};
+    for (const auto neighbor : neighbors) {
+      if (!visited[neighbor] && pmap.is_local(neighbor)) {
+        visited[neighbor] = true;
+        stack.push_back(neighbor);
+      }
+    }
+  }
+  BOOST_CHECK_EQUAL(connected, pmap.local_size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
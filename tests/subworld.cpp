@@ -0,0 +1,111 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/subworld.h"
+#include "global_fixture.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct SubWorldsFixture {
+  SubWorldsFixture()
+      : trange{{0, 3, 8, 10}, {0, 4, 7, 10}},
+        a(*GlobalFixture::world, trange) {
+    a.fill(1.0);
+  }
+
+  /// \return the number of sub-worlds used by the tests
+  static std::size_t nsubworlds() {
+    return std::min<std::size_t>(2ul, GlobalFixture::world->size());
+  }
+
+  TiledRange trange;
+  TArrayD a;
+};
+
+// =============================================================================
+// SubWorlds Test Suite
+
+BOOST_FIXTURE_TEST_SUITE(subworld_suite, SubWorldsFixture)
+
+BOOST_AUTO_TEST_CASE(constructor) {
+  World& world = *GlobalFixture::world;
+  const std::size_t n = nsubworlds();
+  SubWorlds subworlds(world, n);
+  BOOST_CHECK_EQUAL(&subworlds.parent(), &world);
+  BOOST_CHECK_EQUAL(subworlds.size(), n);
+  BOOST_CHECK_LT(subworlds.color(), n);
+  BOOST_CHECK_LE(subworlds.root(subworlds.color()), world.rank());
+  BOOST_CHECK_EQUAL(subworlds.root(0), 0);
+
+  // the sub-worlds partition the parent world
+  std::vector<int> sizes(n, 0);
+  if (subworlds.world().rank() == 0)
+    sizes[subworlds.color()] = subworlds.world().size();
+  world.gop.sum(sizes.data(), n);
+  int total = 0;
+  for (std::size_t c = 0ul; c < n; ++c) total += sizes[c];
+  BOOST_CHECK_EQUAL(total, world.size());
+}
+
+BOOST_AUTO_TEST_CASE(scatter_gather) {
+  SubWorlds subworlds(*GlobalFixture::world, nsubworlds());
+
+  TArrayD b = subworlds.scatter(a);
+  BOOST_CHECK_EQUAL(&b.world(), &subworlds.world());
+  BOOST_CHECK_EQUAL(b.trange(), a.trange());
+  for (const auto& tile : b)
+    for (const auto& value : tile.get()) BOOST_CHECK_EQUAL(value, 1.0);
+
+  // modify the copy in each sub-world, and gather it back
+  b("i,j") = (subworlds.color() + 2.0) * b("i,j");
+  for (std::size_t c = 0ul; c < subworlds.size(); ++c) {
+    TArrayD g = subworlds.gather(b, c);
+    BOOST_CHECK_EQUAL(&g.world(), GlobalFixture::world);
+    for (const auto& tile : g)
+      for (const auto& value : tile.get()) BOOST_CHECK_EQUAL(value, c + 2.0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(for_each) {
+  SubWorlds subworlds(*GlobalFixture::world, nsubworlds());
+  const std::size_t n = 5ul;
+
+  // N.B. scatter is collective over the parent world, so it cannot be called
+  // by the computations
+  TArrayD b = subworlds.scatter(a);
+  std::vector<TArrayD> results = subworlds.for_each(
+      n, [&](World& world, const std::size_t t) {
+        BOOST_CHECK_EQUAL(&world, &subworlds.world());
+        BOOST_CHECK_EQUAL(t % subworlds.size(), subworlds.color());
+        TArrayD c(world, trange);
+        c("i,j") = double(t) * b("i,k") * b("k,j");
+        return c;
+      });
+  BOOST_REQUIRE_EQUAL(results.size(), n);
+  for (std::size_t t = 0ul; t < n; ++t) {
+    BOOST_CHECK_EQUAL(&results[t].world(), GlobalFixture::world);
+    for (const auto& tile : results[t])
+      for (const auto& value : tile.get())
+        BOOST_CHECK_EQUAL(value, 10.0 * t);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -568,6 +568,44 @@ BOOST_AUTO_TEST_CASE(gemm) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(gemm_permuted_args) {
+  TensorD x(r);
+  rand_fill(431, x.size(), x.data());
+  TensorD y(r);
+  rand_fill(413, y.size(), y.data());
+
+  const auto ndim_free = r.rank() - r.rank() % 2;
+  const auto alpha = 1.5;
+  const auto gemm_helper_nt = math::GemmHelper(
+      TiledArray::math::blas::Op::NoTrans, TiledArray::math::blas::Op::Trans,
+      2 * ndim_free, x.range().rank(), y.range().rank());
+  const Permutation perm = make_perm();
+
+  // reference: permute, then gemm
+  const TensorD x_perm = x.permute(perm);
+  const TensorD y_perm = y.permute(perm);
+  const TensorD z_ref = x_perm.gemm(y_perm, alpha, gemm_helper_nt);
+
+  // both arguments permuted, uninitialized result
+  {
+    TensorD z;
+    BOOST_REQUIRE_NO_THROW(z.gemm(x, y, alpha, gemm_helper_nt, perm, perm));
+    BOOST_CHECK_EQUAL(z.range(), z_ref.range());
+    for (std::size_t i = 0ul; i < z_ref.size(); ++i)
+      BOOST_CHECK_EQUAL(z[i], z_ref[i]);
+  }
+
+  // only the left-hand argument permuted, accumulate into initialized result
+  {
+    const double z_init = -1.3;
+    TensorD z(z_ref.range(), z_init);
+    BOOST_REQUIRE_NO_THROW(
+        z.gemm(x, y_perm, alpha, gemm_helper_nt, perm, Permutation{}));
+    for (std::size_t i = 0ul; i < z_ref.size(); ++i)
+      BOOST_CHECK_EQUAL(z[i] - z_init, z_ref[i]);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(conj_op) {
   Permutation perm = make_perm();
   TensorZ s(r);
@@ -664,4 +702,41 @@ BOOST_AUTO_TEST_CASE(block) {
 #endif
 }
 
+BOOST_AUTO_TEST_CASE(memory_accounting) {
+  reset_tensor_bytes_high_water();
+  const std::size_t bytes = tensor_bytes();
+  BOOST_CHECK_EQUAL(tensor_bytes_high_water(), bytes);
+  {
+    TensorD x(Range(1000));
+    BOOST_CHECK_EQUAL(tensor_bytes(), bytes + 1000 * sizeof(double));
+    TensorD y = x;  // shallow copy
+    BOOST_CHECK_EQUAL(tensor_bytes(), bytes + 1000 * sizeof(double));
+    TensorD z = x.clone();
+    BOOST_CHECK_EQUAL(tensor_bytes(), bytes + 2000 * sizeof(double));
+  }
+  BOOST_CHECK_EQUAL(tensor_bytes(), bytes);
+  // the high-water marks are approximate
+  const std::size_t tolerance = detail::memory_tracker().tolerance();
+  BOOST_CHECK_LE(tensor_bytes_high_water(),
+                 bytes + 2000 * sizeof(double) + tolerance);
+  BOOST_CHECK_GE(tensor_bytes_high_water() + tolerance,
+                 bytes + 2000 * sizeof(double));
+  reset_tensor_bytes_high_water();
+  BOOST_CHECK_EQUAL(tensor_bytes_high_water(), bytes);
+
+  // nested peaks are measured separately
+  const std::size_t n = 4 * detail::MemoryTracker::granularity;
+  TensorBytesPeak outer;
+  {
+    TensorD x(Range(n));
+    TensorBytesPeak inner;
+    BOOST_CHECK_EQUAL(inner.bytes(), 0ul);
+    TensorD y(Range(n));
+    BOOST_CHECK_LE(inner.bytes(), n * sizeof(double) + tolerance);
+    BOOST_CHECK_GE(inner.bytes() + tolerance, n * sizeof(double));
+  }
+  BOOST_CHECK_LE(outer.bytes(), 2 * n * sizeof(double) + tolerance);
+  BOOST_CHECK_GE(outer.bytes() + tolerance, 2 * n * sizeof(double));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1234,4 +1234,115 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(serialization, ITensor, itensor_types) {
                                 cend(a_roundtrip));
 }
 
+BOOST_AUTO_TEST_CASE(contiguous_storage) {
+  const auto& a = ToT<Tensor<int>>(0);
+  auto inner_range = [&a](const std::size_t i) { return a.data()[i].range(); };
+  auto t = make_contiguous_tensor_of_tensor<Tensor<Tensor<int>>>(a.range(),
+                                                                 inner_range);
+  BOOST_REQUIRE_EQUAL(t.range(), a.range());
+
+  // inner tensors are packed back-to-back
+  const int* expected_data = t.data()[0].data();
+  for (std::size_t i = 0ul; i < t.size(); ++i) {
+    BOOST_CHECK_EQUAL(t.data()[i].range(), a.data()[i].range());
+    BOOST_CHECK_EQUAL(t.data()[i].data(), expected_data);
+    expected_data += t.data()[i].size();
+  }
+
+  // inner tensors keep the arena alive
+  for (std::size_t i = 0ul; i < t.size(); ++i)
+    std::copy(a.data()[i].begin(), a.data()[i].end(), t.data()[i].begin());
+  auto inner = t.data()[t.size() - 1];
+  t = Tensor<Tensor<int>>{};
+  BOOST_CHECK_EQUAL(inner, a.data()[a.size() - 1]);
+}
+
+BOOST_AUTO_TEST_CASE(contiguous_serialization) {
+  const auto& a = ToT<Tensor<int>>(0);
+  std::size_t buf_size = 10000000;
+  std::vector<unsigned char> buf(buf_size);
+  madness::archive::BufferOutputArchive oar(buf.data(), buf_size);
+  BOOST_REQUIRE_NO_THROW(oar & a);
+  const std::size_t nbyte = oar.size();
+  oar.close();
+
+  // the layout is that of a tensor of (independently serialized) tensors
+  {
+    madness::archive::BufferInputArchive iar(buf.data(), nbyte);
+    Tensor<int>::ordinal_type n = 0ul;
+    iar& n;
+    BOOST_REQUIRE_EQUAL(n, a.size());
+    for (std::size_t i = 0ul; i < n; ++i) {
+      Tensor<int> inner;
+      iar& inner;
+      BOOST_CHECK_EQUAL(inner, a.data()[i]);
+    }
+    Range range;
+    iar& range;
+    BOOST_CHECK_EQUAL(range, a.range());
+  }
+
+  // the inner tensors are unpacked back-to-back
+  Tensor<Tensor<int>> a_roundtrip;
+  madness::archive::BufferInputArchive iar(buf.data(), nbyte);
+  BOOST_REQUIRE_NO_THROW(iar & a_roundtrip);
+  BOOST_REQUIRE_EQUAL(a_roundtrip.range(), a.range());
+  const int* expected_data = a_roundtrip.data()[0].data();
+  for (std::size_t i = 0ul; i < a.size(); ++i) {
+    BOOST_CHECK_EQUAL(a_roundtrip.data()[i], a.data()[i]);
+    BOOST_CHECK_EQUAL(a_roundtrip.data()[i].data(), expected_data);
+    expected_data += a_roundtrip.data()[i].size();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(gemm_batched) {
+  const auto& a = ToT<Tensor<int>>(0);
+  const auto& b = ToT<Tensor<int>>(1);
+  const int factor = 2;
+  // c(m,n)(i,j) = factor * a(m,k)(i,l) * b(n,k)(j,l)
+  const math::GemmHelper gemm_helper(math::blas::NoTranspose,
+                                     math::blas::Transpose, 2u, 2u, 2u);
+  const math::GemmHelper inner_gemm_helper(math::blas::NoTranspose,
+                                           math::blas::Transpose, 2u, 2u, 2u);
+
+  Tensor<Tensor<int>> c_ref;
+  c_ref.gemm(a, b, gemm_helper,
+             [&](Tensor<int>& result, const Tensor<int>& left,
+                 const Tensor<int>& right) {
+               if (result.empty())
+                 result = left.gemm(right, factor, inner_gemm_helper);
+               else
+                 result.gemm(left, right, factor, inner_gemm_helper);
+             });
+
+  Tensor<Tensor<int>> c;
+  BOOST_REQUIRE_NO_THROW(c.gemm(a, b, gemm_helper, factor, inner_gemm_helper));
+  BOOST_REQUIRE_EQUAL(c.range(), c_ref.range());
+  for (std::size_t i = 0ul; i < c.size(); ++i)
+    BOOST_CHECK_EQUAL(c.data()[i], c_ref.data()[i]);
+
+  // contiguous arguments are dispatched as strided batches
+  auto make_contiguous = [](const Tensor<Tensor<int>>& arg) {
+    auto result = make_contiguous_tensor_of_tensor<Tensor<Tensor<int>>>(
+        arg.range(),
+        [&arg](const std::size_t i) { return arg.data()[i].range(); });
+    for (std::size_t i = 0ul; i < arg.size(); ++i)
+      std::copy(arg.data()[i].begin(), arg.data()[i].end(),
+                result.data()[i].begin());
+    return result;
+  };
+  Tensor<Tensor<int>> c_contiguous;
+  BOOST_REQUIRE_NO_THROW(c_contiguous.gemm(make_contiguous(a),
+                                           make_contiguous(b), gemm_helper,
+                                           factor, inner_gemm_helper));
+  BOOST_REQUIRE_EQUAL(c_contiguous.range(), c_ref.range());
+  for (std::size_t i = 0ul; i < c_contiguous.size(); ++i)
+    BOOST_CHECK_EQUAL(c_contiguous.data()[i], c_ref.data()[i]);
+
+  // accumulate into an existing result
+  BOOST_REQUIRE_NO_THROW(c.gemm(a, b, gemm_helper, factor, inner_gemm_helper));
+  for (std::size_t i = 0ul; i < c.size(); ++i)
+    BOOST_CHECK_EQUAL(c.data()[i], c_ref.data()[i] * 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
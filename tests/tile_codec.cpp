@@ -0,0 +1,90 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2021  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/tile_codec.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace TiledArray;
+
+struct TileCodecFixture {
+  TileCodecFixture() : range({5, 6, 7}), t(range) {
+    // a smooth tile with many near-zero elements
+    for (std::size_t i = 0ul; i < t.size(); ++i)
+      t[i] = (i % 3 == 0) ? 0.0 : std::exp(-0.1 * i) * std::sin(0.05 * i);
+  }
+
+  Range range;
+  TensorD t;
+};
+
+BOOST_FIXTURE_TEST_SUITE(tile_codec_suite, TileCodecFixture,
+                         TA_UT_LABEL_SERIAL)
+
+BOOST_AUTO_TEST_CASE(lossless) {
+  const auto encoded = detail::encode_tile(t, TileCodec::lossless());
+  const auto decoded = detail::decode_tile<TensorD>(encoded);
+  BOOST_CHECK_EQUAL(decoded.range(), t.range());
+  BOOST_CHECK(decoded == t);
+  BOOST_CHECK_LT(encoded.size(), t.size() * sizeof(double));
+
+  // other element types
+  TensorF f(range);
+  for (std::size_t i = 0ul; i < f.size(); ++i) f[i] = 0.5f * i;
+  BOOST_CHECK(detail::decode_tile<TensorF>(
+                  detail::encode_tile(f, TileCodec::lossless())) == f);
+  TensorI n(range);
+  for (std::size_t i = 0ul; i < n.size(); ++i) n[i] = int(i) - 100;
+  BOOST_CHECK(detail::decode_tile<TensorI>(
+                  detail::encode_tile(n, TileCodec::lossless())) == n);
+  TensorZ z(range, std::complex<double>(1.0, -2.0));
+  BOOST_CHECK(detail::decode_tile<TensorZ>(
+                  detail::encode_tile(z, TileCodec::bounded(1e-3))) == z);
+
+  // empty tiles
+  BOOST_CHECK(detail::decode_tile<TensorD>(
+                  detail::encode_tile(TensorD(), TileCodec::lossless()))
+                  .empty());
+}
+
+BOOST_AUTO_TEST_CASE(bounded) {
+  for (const double tolerance : {1e-2, 1e-6, 1e-12}) {
+    const auto encoded =
+        detail::encode_tile(t, TileCodec::bounded(tolerance));
+    const auto decoded = detail::decode_tile<TensorD>(encoded);
+    BOOST_CHECK_EQUAL(decoded.range(), t.range());
+    for (std::size_t i = 0ul; i < t.size(); ++i) {
+      BOOST_CHECK_LE(std::abs(decoded[i] - t[i]), tolerance * (1.0 + 1e-12));
+      // zeros are exact
+      if (t[i] == 0.0) BOOST_CHECK_EQUAL(decoded[i], 0.0);
+    }
+    BOOST_CHECK_LT(encoded.size(), t.size() * sizeof(double));
+  }
+
+  // tiles that cannot be quantized are encoded losslessly
+  TensorD x = t.clone();
+  x[1] = std::numeric_limits<double>::infinity();
+  BOOST_CHECK(detail::decode_tile<TensorD>(
+                  detail::encode_tile(x, TileCodec::bounded(1e-6))) == x);
+}
+
+BOOST_AUTO_TEST_SUITE_END()